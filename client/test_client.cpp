@@ -100,14 +100,14 @@ int main()
         header.block_count = 10;
         Body body;
 
-        Datagram<ServiceType> datagram(std::move(header), std::move(body));
+        Datagram<ServiceType> datagram(header, body);
 
         MPing ping;
         ping.setStart();
         std::this_thread::sleep_for(std::chrono::milliseconds(144));
         ping.setEnd();
 
-        auto[ok, wrote, free] = datagram.BodyRef().write(ping, sizeof(ping));
+        schema::write(datagram.BodyRef(), ping);
 
         helper::prepareDatagram(datagram, 0xEA, 0xFF);
         // --------------------------------- -------------
@@ -123,14 +123,17 @@ int main()
         {
             std::stringstream ss;
             ss  << ping
-                << "sizeof - " << sizeof(ping) << "\n"
+                << "packed - " << schema::packedSize<MPing>() << "\n"
                 << datagram
                 << "sizeof - " << sizeof(datagram) << "\n";
             LOG(ss.str().c_str())
         }
 
 
-        auto wrap { boost::asio::buffer(&datagram, sizeof(datagram)) };
+        std::array<std::uint8_t, types::DATAGRAM_SIZE> packet {};
+        datagram.encode(packet.data(), true);
+
+        auto wrap { boost::asio::buffer(packet) };
         auto bytes = socket.send_to(wrap, server_endpoint, 0, ec);
 
         if (ec.failed())
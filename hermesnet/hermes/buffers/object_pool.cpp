@@ -0,0 +1,3 @@
+#include "object_pool.h"
+
+/* just for standard .obj compilation */
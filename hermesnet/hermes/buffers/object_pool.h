@@ -0,0 +1,305 @@
+#pragma once
+
+#include <new>
+#include <array>
+#include <atomic>
+#include <memory>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+#include <algorithm>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/buffers/spsc_queue.h>
+
+namespace network::buffer
+{
+    /**
+     * Ссылка на объект пула: индекс слота и поколение слота на момент
+     * создания. После удаления объекта поколение слота меняется и
+     * старая ссылка перестает разрешаться (get() вернет nullptr).
+     */
+    template <typename ObjectType>
+    struct PoolHandle
+    {
+        static constexpr std::uint32_t NIL { ~std::uint32_t(0) };
+
+        std::uint32_t   index       { NIL };
+        std::uint32_t   generation  { 0 };
+
+        explicit operator bool() const noexcept { return NIL != index; }
+        bool operator== (PoolHandle const& other) const noexcept { return index == other.index and generation == other.generation; }
+        bool operator!= (PoolHandle const& other) const noexcept { return not (*this == other); }
+    };
+
+    /**
+     * Пул объектов с O(1) созданием и удалением. Слоты хранятся
+     * непрерывно блоками по CHUNK_SIZE (адреса объектов стабильны),
+     * свободные слоты связаны в список через память самих слотов.
+     * Пулом владеет один поток: create/destroy/get вызываются им.
+     * Другие потоки освобождают объекты через RemoteCache - пачками
+     * в общий список, который поток-владелец забирает целиком, когда
+     * его собственный список пуст.
+     * В сборке Debug память освобожденных слотов заполняется POISON.
+     * @tparam ObjectType
+     */
+    template <typename ObjectType>
+    class ObjectPool : boost::noncopyable
+    {
+    public:
+        using Handle = PoolHandle<ObjectType>;
+
+        static constexpr std::uint32_t CHUNK_SHIFT { 8 };
+        static constexpr std::uint32_t CHUNK_SIZE  { 1u << CHUNK_SHIFT };
+        static constexpr std::uint32_t MAX_CHUNKS  { 4096 };    // 1M objects
+        static constexpr std::uint8_t  POISON      { 0xDD };
+
+    private:
+        static constexpr std::uint32_t NIL { Handle::NIL };
+
+        /*
+         * Поколение нечетное, пока слот занят. Поколение меняют и
+         * поток-владелец, и освобождающий поток, поэтому оно атомарное.
+         */
+        struct Slot
+        {
+            union
+            {
+                alignas(ObjectType) std::byte storage[sizeof(ObjectType)];
+                std::uint32_t next;     // next free slot
+            };
+            std::atomic<std::uint32_t> generation { 0 };
+
+            Slot() noexcept : next(NIL) {}
+            ObjectType* object() noexcept { return std::launder(reinterpret_cast<ObjectType*>(storage)); }
+        };
+
+        using Chunk = std::array<Slot, CHUNK_SIZE>;
+
+        // chunk table never moves, so other threads may resolve handles while the owner grows
+        std::unique_ptr<std::unique_ptr<Chunk>[]>   chunks_;
+        std::atomic<std::uint32_t>                  chunkCount_ { 0 };
+        std::uint32_t                               maxChunks_;
+        std::uint32_t                               free_       { NIL };    // owner's free list
+        std::uint32_t                               live_       { 0 };
+
+        alignas(CACHE_LINE_SIZE) std::atomic<std::uint32_t> remote_      { NIL };  // freed by other threads
+        std::atomic<std::uint32_t>                          remoteCount_ { 0 };
+
+        Slot& slot(std::uint32_t index) noexcept { return (*chunks_[index >> CHUNK_SHIFT])[index & (CHUNK_SIZE - 1)]; }
+        Slot const& slot(std::uint32_t index) const noexcept { return (*chunks_[index >> CHUNK_SHIFT])[index & (CHUNK_SIZE - 1)]; }
+
+        bool grow();
+        // Уничтожить объект и пометить слот свободным, слот в список не добавляется
+        void retire(Slot& s) noexcept;
+        // Добавить цепочку слотов first..last в общий список
+        void pushRemote(std::uint32_t first, std::uint32_t last, std::uint32_t count) noexcept;
+
+    public:
+        /**
+         * Кэш освобождения для потока, не владеющего пулом. Накопленные
+         * слоты передаются владельцу одной атомарной операцией.
+         */
+        class RemoteCache : boost::noncopyable
+        {
+        private:
+            static constexpr std::uint32_t BATCH { 32 };
+
+            ObjectPool&     pool_;
+            std::uint32_t   first_  { NIL };
+            std::uint32_t   last_   { NIL };
+            std::uint32_t   count_  { 0 };
+
+        public:
+            explicit RemoteCache(ObjectPool& pool) noexcept : pool_(pool) {}
+            ~RemoteCache() { flush(); }
+
+            // Освободить объект, false для устаревшей ссылки
+            bool destroy(Handle handle) noexcept;
+            // Передать накопленные слоты владельцу
+            void flush() noexcept;
+        };
+
+        // initialChunks - preallocated chunks, maxChunks - growth limit [1..MAX_CHUNKS]
+        explicit ObjectPool(std::uint32_t initialChunks = 1, std::uint32_t maxChunks = MAX_CHUNKS);
+        virtual ~ObjectPool();
+
+        // owner thread
+        template <typename... Args>
+        Handle create(Args&&... args);
+        bool destroy(Handle handle) noexcept;
+
+        [[nodiscard]] ObjectType* get(Handle handle) noexcept;
+        [[nodiscard]] ObjectType const* get(Handle handle) const noexcept;
+
+        // handler(Handle, ObjectType&) for every live object
+        template <typename Handler>
+        void forEach(Handler&& handler);
+
+        [[nodiscard]] std::uint32_t size() const noexcept { return live_ - remoteCount_.load(std::memory_order_relaxed); }
+        [[nodiscard]] std::uint32_t capacity() const noexcept { return chunkCount_.load(std::memory_order_acquire) * CHUNK_SIZE; }
+
+    };  // ObjectPool
+
+}   // network::buffer
+
+// ********************************* IMPLEMENTATION **********************************
+
+using namespace network::buffer;
+
+template <typename ObjectType>
+ObjectPool<ObjectType>::ObjectPool(std::uint32_t initialChunks, std::uint32_t maxChunks)
+    : chunks_(new std::unique_ptr<Chunk>[std::clamp(maxChunks, 1u, MAX_CHUNKS)])
+    , maxChunks_(std::clamp(maxChunks, 1u, MAX_CHUNKS))
+{
+    for (std::uint32_t i = 0; i < initialChunks; ++i)
+        grow();
+}
+
+template <typename ObjectType>
+ObjectPool<ObjectType>::~ObjectPool()
+{
+    for (std::uint32_t i = 0; i < capacity(); ++i)
+    {
+        auto& s { slot(i) };
+        if (s.generation.load(std::memory_order_relaxed) & 1)
+            s.object()->~ObjectType();
+    }
+}
+
+template <typename ObjectType>
+bool ObjectPool<ObjectType>::grow()
+{
+    const auto count { chunkCount_.load(std::memory_order_relaxed) };
+    if (count >= maxChunks_) return false;
+
+    chunks_[count] = std::make_unique<Chunk>();
+    chunkCount_.store(count + 1, std::memory_order_release);
+
+    // thread new slots in address order
+    const auto base { count * CHUNK_SIZE };
+    for (std::uint32_t i = CHUNK_SIZE; i-- > 0; )
+    {
+        slot(base + i).next = free_;
+        free_ = base + i;
+    }
+    return true;
+}
+
+template <typename ObjectType>
+template <typename... Args>
+typename ObjectPool<ObjectType>::Handle ObjectPool<ObjectType>::create(Args&&... args)
+{
+    if (NIL == free_)
+    {
+        // take everything freed by other threads at once
+        free_ = remote_.exchange(NIL, std::memory_order_acquire);
+        if (NIL != free_)
+            live_ -= remoteCount_.exchange(0, std::memory_order_relaxed);
+        else if (not grow())
+            return {};
+    }
+
+    const auto index { free_ };
+    auto& s { slot(index) };
+    free_ = s.next;
+
+    new (s.storage) ObjectType(std::forward<Args>(args)...);
+    ++live_;
+
+    const auto generation { s.generation.load(std::memory_order_relaxed) + 1 };
+    s.generation.store(generation, std::memory_order_relaxed);
+    return { index, generation };
+}
+
+template <typename ObjectType>
+void ObjectPool<ObjectType>::retire(Slot& s) noexcept
+{
+    s.object()->~ObjectType();
+#ifdef Debug
+    std::memset(s.storage, POISON, sizeof(s.storage));
+#endif
+    s.generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename ObjectType>
+bool ObjectPool<ObjectType>::destroy(Handle handle) noexcept
+{
+    if (nullptr == get(handle)) return false;
+
+    auto& s { slot(handle.index) };
+    retire(s);
+    s.next = free_;
+    free_ = handle.index;
+    --live_;
+    return true;
+}
+
+template <typename ObjectType>
+void ObjectPool<ObjectType>::pushRemote(std::uint32_t first, std::uint32_t last, std::uint32_t count) noexcept
+{
+    // counter goes first: the owner subtracts it after taking the list
+    remoteCount_.fetch_add(count, std::memory_order_relaxed);
+
+    // producers only push whole chains and the owner only takes the whole list, no ABA
+    auto head { remote_.load(std::memory_order_relaxed) };
+    do {
+        slot(last).next = head;
+    } while (not remote_.compare_exchange_weak(head, first, std::memory_order_release, std::memory_order_relaxed));
+}
+
+template <typename ObjectType>
+ObjectType* ObjectPool<ObjectType>::get(Handle handle) noexcept
+{
+    if (not handle or handle.index >= capacity()) return nullptr;
+
+    auto& s { slot(handle.index) };
+    return handle.generation == s.generation.load(std::memory_order_relaxed) ? s.object() : nullptr;
+}
+
+template <typename ObjectType>
+ObjectType const* ObjectPool<ObjectType>::get(Handle handle) const noexcept
+{
+    return const_cast<ObjectPool*>(this)->get(handle);
+}
+
+template <typename ObjectType>
+template <typename Handler>
+void ObjectPool<ObjectType>::forEach(Handler&& handler)
+{
+    for (std::uint32_t i = 0; i < capacity(); ++i)
+    {
+        auto& s { slot(i) };
+        if (const auto generation { s.generation.load(std::memory_order_relaxed) }; generation & 1)
+            handler(Handle { i, generation }, *s.object());
+    }
+}
+
+template <typename ObjectType>
+bool ObjectPool<ObjectType>::RemoteCache::destroy(Handle handle) noexcept
+{
+    auto object { pool_.get(handle) };
+    if (nullptr == object) return false;
+
+    auto& s { pool_.slot(handle.index) };
+    pool_.retire(s);
+
+    // chain is built through the slots themselves
+    s.next = first_;
+    first_ = handle.index;
+    if (NIL == last_) last_ = handle.index;
+
+    if (++count_ == BATCH) flush();
+    return true;
+}
+
+template <typename ObjectType>
+void ObjectPool<ObjectType>::RemoteCache::flush() noexcept
+{
+    if (0 == count_) return;
+
+    pool_.pushRemote(first_, last_, count_);
+    first_ = last_ = NIL;
+    count_ = 0;
+}
@@ -1,11 +1,16 @@
-
 #pragma once
 
 #include <chrono>
+#include <atomic>
+#include <vector>
 #include <utility>
+#include <algorithm>
+#include <type_traits>
+#include <memory_resource>
 
 #include <boost/noncopyable.hpp>
-#include <boost/circular_buffer.hpp>
+
+#include <hermes/buffers/spsc_queue.h>
 
 namespace network::buffer
 {
@@ -28,21 +33,66 @@ namespace network::buffer
         }
     };
 
+    template <typename ElementType>
+    class MessageBuffer;
+
+    /**
+     * Резерв слота кольцевого буфера для записи на месте.
+     * Слот публикуется читателю только после commit(), без
+     * него (ошибка чтения, невалидная датаграмма) резерв
+     * отменяется в деструкторе и слот остается свободным.
+     */
+    template <typename ElementType>
+    class Reservation : boost::noncopyable
+    {
+    private:
+        MessageBuffer<ElementType>* owner_ { nullptr };
+        ElementType*                slot_  { nullptr };
+
+    public:
+        Reservation() = default;
+        Reservation(MessageBuffer<ElementType>* owner, ElementType* slot) noexcept;
+        Reservation(Reservation&& other) noexcept;
+        Reservation& operator= (Reservation&& other) noexcept;
+        ~Reservation();
+
+        explicit operator bool() const noexcept { return nullptr != slot_; }
+        ElementType& operator* () const noexcept { return *slot_; }
+        ElementType* operator-> () const noexcept { return slot_; }
+
+        // Опубликовать записанный слот
+        void commit() noexcept;
+        // Отказаться от слота
+        void rollback() noexcept;
+    };
+
     /**
      * Кольцевой буфер для накопления входящих и исходящих
      * сообщений для последующей перелачи в буфер обмена или
-     * сокет.
+     * сокет. Все слоты выделяются при создании; писатель
+     * резервирует слот и заполняет его на месте (например,
+     * прямо из сокета), читатель обрабатывает слоты на месте.
+     * Один писатель и один читатель без блокировок.
+     * Память слотов берется из переданного источника (например,
+     * memory::HugePagePool для больших страниц).
      * @tparam ElementType
      */
     template <typename ElementType>
     class MessageBuffer : boost::noncopyable
     {
-    public:
-        boost::circular_buffer<ElementType> circularBuffer_;
+    private:
+        friend class Reservation<ElementType>;
+
+        std::pmr::vector<ElementType>   slots_;
+
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_ { 0 };  // reader index
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_ { 0 };  // writer index
+
+        void publish(std::size_t count = 1) noexcept;
 
     public:
-        // capacity -> new_cap = msgCountCapacity * sizeof(ElemType) bytes
-        explicit MessageBuffer(std::size_t msgCountCapacity) noexcept;
+        // capacity - message count
+        explicit MessageBuffer(std::size_t msgCountCapacity, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
 
         MessageBuffer() = delete;
 
@@ -50,10 +100,28 @@ namespace network::buffer
         MessageBuffer& operator= (MessageBuffer&& other) noexcept;
 
         [[nodiscard]] bool full() const;
+        [[nodiscard]] bool empty() const;
+        [[nodiscard]] std::size_t size() const;
 
+        // writer side
+        Reservation<ElementType> reserve() noexcept;
         void storeElem(ElementType&& elem);
+        // Свободные слоты подряд (до конца кольца), не больше max: первый слот и их число в count
+        ElementType* reserveSpan(std::size_t max, std::size_t& count) noexcept;
+        // Опубликовать первые count слотов последнего reserveSpan
+        void commitSpan(std::size_t count) noexcept { publish(count); }
+
+        // reader side: handler(ElementType&) for every stored slot, then slots are released
+        template <typename Handler>
+        std::size_t consume(Handler&& handler);
         void extractAll(std::vector<ElementType>& result);
 
+        // Bulk operations for trivially copyable elements (at most two memcpy per call)
+        // Извлечь до max элементов в dst
+        std::size_t drain(ElementType* dst, std::size_t max) noexcept;
+        // Скопировать содержимое без извлечения
+        void snapshot(std::vector<ElementType>& result) const;
+
     };  // MessageBuffer
 
 }   // network::buffer
@@ -80,27 +148,77 @@ TimedMessage<ElementType>::TimedMessage(ElementType&& m) noexcept
 }
 
 template <typename ElementType>
-MessageBuffer<ElementType>::MessageBuffer(std::size_t count) noexcept
+Reservation<ElementType>::Reservation(MessageBuffer<ElementType>* owner, ElementType* slot) noexcept
+    : owner_(owner)
+    , slot_(slot)
+{}
+
+template <typename ElementType>
+Reservation<ElementType>::Reservation(Reservation&& other) noexcept
+    : owner_(std::exchange(other.owner_, nullptr))
+    , slot_(std::exchange(other.slot_, nullptr))
+{}
+
+template <typename ElementType>
+Reservation<ElementType>& Reservation<ElementType>::operator= (Reservation&& other) noexcept
+{
+    if (this != &other)
+    {
+        rollback();
+        owner_ = std::exchange(other.owner_, nullptr);
+        slot_ = std::exchange(other.slot_, nullptr);
+    }
+    return *this;
+}
+
+template <typename ElementType>
+Reservation<ElementType>::~Reservation()
+{
+    rollback();
+}
+
+template <typename ElementType>
+void Reservation<ElementType>::commit() noexcept
+{
+    if (nullptr == slot_) return;
+
+    owner_->publish();
+    owner_ = nullptr;
+    slot_ = nullptr;
+}
+
+template <typename ElementType>
+void Reservation<ElementType>::rollback() noexcept
+{
+    // writer index was not moved, the slot will be reserved again
+    owner_ = nullptr;
+    slot_ = nullptr;
+}
+
+template <typename ElementType>
+MessageBuffer<ElementType>::MessageBuffer(std::size_t count, std::pmr::memory_resource* memory)
+    : slots_(count, memory)
 {
     LOG_REGISTER_MODULE(EModule::CIRCBUF)
-    circularBuffer_.set_capacity(count * sizeof(ElementType));
 }
 
 template<typename ElementType>
 MessageBuffer<ElementType>::MessageBuffer(MessageBuffer &&other) noexcept
+    : slots_(std::move(other.slots_))
 {
-    if (this != &other)
-    {
-        circularBuffer_.swap(other.circularBuffer_);
-    }
+    head_.store(other.head_.exchange(0));
+    tail_.store(other.tail_.exchange(0));
 }
 
 template<typename ElementType>
 MessageBuffer<ElementType>& MessageBuffer<ElementType>::operator=(MessageBuffer &&other) noexcept
 {
+    // slots may come from different memory sources, so the buffers are not swapped
     if (this != &other)
     {
-        circularBuffer_.swap(other.circularBuffer_);
+        slots_ = std::move(other.slots_);
+        head_.store(other.head_.exchange(0));
+        tail_.store(other.tail_.exchange(0));
     }
     return *this;
 }
@@ -108,7 +226,45 @@ MessageBuffer<ElementType>& MessageBuffer<ElementType>::operator=(MessageBuffer
 template<typename MessageType>
 bool MessageBuffer<MessageType>::full() const
 {
-    return circularBuffer_.full();
+    return size() == slots_.size();
+}
+
+template<typename MessageType>
+bool MessageBuffer<MessageType>::empty() const
+{
+    return 0 == size();
+}
+
+template<typename MessageType>
+std::size_t MessageBuffer<MessageType>::size() const
+{
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+}
+
+template <typename ElementType>
+Reservation<ElementType> MessageBuffer<ElementType>::reserve() noexcept
+{
+    const auto tail { tail_.load(std::memory_order_relaxed) };
+    if (tail - head_.load(std::memory_order_acquire) == slots_.size())
+        return {};
+
+    return { this, &slots_[tail % slots_.size()] };
+}
+
+template <typename ElementType>
+ElementType* MessageBuffer<ElementType>::reserveSpan(std::size_t max, std::size_t& count) noexcept
+{
+    // a span does not wrap, the rest of the free slots is at the start of the ring
+    const auto tail  { tail_.load(std::memory_order_relaxed) };
+    const auto first { tail % slots_.size() };
+    count = std::min({ max, slots_.size() - (tail - head_.load(std::memory_order_acquire)), slots_.size() - first });
+    return slots_.data() + first;
+}
+
+template <typename ElementType>
+void MessageBuffer<ElementType>::publish(std::size_t count) noexcept
+{
+    tail_.store(tail_.load(std::memory_order_relaxed) + count, std::memory_order_release);
 }
 
 template <typename ElementType>
@@ -117,7 +273,25 @@ void MessageBuffer<ElementType>::storeElem(ElementType&& elem)
 #ifdef Debug
     LOG("storing message")
 #endif
-    circularBuffer_.push_back(std::forward<ElementType>(elem));
+    if (auto slot { reserve() })
+    {
+        *slot = std::forward<ElementType>(elem);
+        slot.commit();
+    }
+}
+
+template <typename ElementType>
+template <typename Handler>
+std::size_t MessageBuffer<ElementType>::consume(Handler&& handler)
+{
+    const auto head { head_.load(std::memory_order_relaxed) };
+    const auto tail { tail_.load(std::memory_order_acquire) };
+
+    for (auto i = head; i != tail; ++i)
+        handler(slots_[i % slots_.size()]);
+
+    head_.store(tail, std::memory_order_release);
+    return tail - head;
 }
 
 template <typename ElementType>
@@ -126,9 +300,49 @@ void MessageBuffer<ElementType>::extractAll(std::vector<ElementType>& result)
 #ifdef Debug
     LOG("extract all message from circular buffer")
 #endif
-    if (not circularBuffer_.empty())
+    if constexpr (std::is_trivially_copyable_v<ElementType>)
     {
-        std::move(circularBuffer_.begin(), circularBuffer_.end(), result.begin());
+        const auto offset { result.size() };
+        result.resize(offset + size());
+        result.resize(offset + drain(result.data() + offset, result.size() - offset));
     }
+    else
+    {
+        consume([&result](ElementType& elem) {
+            result.emplace_back(std::move(elem));
+        });
+    }
+}
+
+template <typename ElementType>
+std::size_t MessageBuffer<ElementType>::drain(ElementType* dst, std::size_t max) noexcept
+{
+    static_assert(std::is_trivially_copyable_v<ElementType>, "bulk drain needs trivially copyable elements");
+
+    const auto head  { head_.load(std::memory_order_relaxed) };
+    const auto count { std::min(max, tail_.load(std::memory_order_acquire) - head) };
+
+    // stored elements are one or two contiguous spans of slots
+    const auto first { head % slots_.size() };
+    const auto part  { std::min(count, slots_.size() - first) };
+    std::copy_n(slots_.data() + first, part, dst);
+    std::copy_n(slots_.data(), count - part, dst + part);
+
+    head_.store(head + count, std::memory_order_release);
+    return count;
 }
 
+template <typename ElementType>
+void MessageBuffer<ElementType>::snapshot(std::vector<ElementType>& result) const
+{
+    static_assert(std::is_trivially_copyable_v<ElementType>, "snapshot needs trivially copyable elements");
+
+    const auto head  { head_.load(std::memory_order_acquire) };
+    const auto count { tail_.load(std::memory_order_acquire) - head };
+
+    const auto first { head % slots_.size() };
+    const auto part  { std::min(count, slots_.size() - first) };
+    result.resize(count);
+    std::copy_n(slots_.data() + first, part, result.data());
+    std::copy_n(slots_.data(), count - part, result.data() + part);
+}
@@ -0,0 +1,4 @@
+
+#include "spsc_queue.h"
+
+/* just for standard .obj compilation */
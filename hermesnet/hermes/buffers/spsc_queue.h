@@ -0,0 +1,106 @@
+#pragma once
+
+#include <atomic>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <memory_resource>
+
+#include <boost/noncopyable.hpp>
+
+namespace network::buffer
+{
+    static constexpr std::size_t CACHE_LINE_SIZE { 64 };
+
+    /**
+     * Неблокирующая очередь с одним писателем и одним читателем
+     * (single producer / single consumer) фиксированного размера.
+     * Используется для передачи сообщений между потоками разных
+     * шардов без примитивов синхронизации: каждый индекс изменяется
+     * только своим потоком, другой поток его лишь читает.
+     * @tparam ElementType - default constructible, movable
+     */
+    template <typename ElementType>
+    class SpscQueue : boost::noncopyable
+    {
+    private:
+        std::pmr::vector<ElementType>   slots_;
+        std::size_t                     mask_ { 0 };
+
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> head_ { 0 };  // consumer index
+        alignas(CACHE_LINE_SIZE) std::atomic<std::size_t> tail_ { 0 };  // producer index
+
+    public:
+        // capacity rounds up to power of two
+        explicit SpscQueue(std::size_t capacity, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+        SpscQueue() = delete;
+
+        // producer side
+        bool tryPush(ElementType&& elem) noexcept;
+        // consumer side
+        bool tryPop(ElementType& elem) noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept;
+        [[nodiscard]] std::size_t capacity() const noexcept;
+        [[nodiscard]] bool empty() const noexcept;
+
+    };  // SpscQueue
+
+}   // network::buffer
+
+// ********************************* IMPLEMENTATION **********************************
+
+using namespace network::buffer;
+
+template <typename ElementType>
+SpscQueue<ElementType>::SpscQueue(std::size_t capacity, std::pmr::memory_resource* memory)
+    : slots_(memory)
+{
+    std::size_t n { 1 };
+    while (n < capacity) n <<= 1;
+
+    slots_.resize(n);
+    mask_ = n - 1;
+}
+
+template <typename ElementType>
+bool SpscQueue<ElementType>::tryPush(ElementType&& elem) noexcept
+{
+    const auto tail { tail_.load(std::memory_order_relaxed) };
+    if (tail - head_.load(std::memory_order_acquire) == slots_.size())
+        return false;
+
+    slots_[tail & mask_] = std::forward<ElementType>(elem);
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename ElementType>
+bool SpscQueue<ElementType>::tryPop(ElementType& elem) noexcept
+{
+    const auto head { head_.load(std::memory_order_relaxed) };
+    if (head == tail_.load(std::memory_order_acquire))
+        return false;
+
+    elem = std::move(slots_[head & mask_]);
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+}
+
+template <typename ElementType>
+std::size_t SpscQueue<ElementType>::size() const noexcept
+{
+    return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+}
+
+template <typename ElementType>
+std::size_t SpscQueue<ElementType>::capacity() const noexcept
+{
+    return slots_.size();
+}
+
+template <typename ElementType>
+bool SpscQueue<ElementType>::empty() const noexcept
+{
+    return 0 == size();
+}
@@ -0,0 +1,118 @@
+#include "arena.h"
+
+#include <algorithm>
+
+using namespace memory;
+
+namespace
+{
+    constexpr std::size_t BLOCK_ALIGN { alignof(std::max_align_t) };
+
+    constexpr std::size_t alignUp(std::size_t value, std::size_t alignment) noexcept
+    {
+        return (value + alignment - 1) & ~(alignment - 1);
+    }
+}
+
+TickArena::TickArena(std::size_t capacity, std::pmr::memory_resource* upstream)
+    : buffer_(new std::byte[capacity])
+    , capacity_(capacity)
+    , upstream_(upstream)
+{}
+
+void TickArena::reset() noexcept
+{
+    offset_ = 0;
+}
+
+void* TickArena::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    const auto base  { reinterpret_cast<std::uintptr_t>(buffer_.get()) };
+    const auto begin { alignUp(base + offset_, alignment) - base };
+
+    if (begin + bytes > capacity_)
+    {
+        ++overflows_;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    offset_ = begin + bytes;
+    highWater_ = std::max(highWater_, offset_);
+    return buffer_.get() + begin;
+}
+
+void TickArena::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    // arena memory is released in bulk by reset()
+    const auto ptr { static_cast<std::byte*>(p) };
+    if (ptr < buffer_.get() or ptr >= buffer_.get() + capacity_)
+        upstream_->deallocate(p, bytes, alignment);
+}
+
+bool TickArena::do_is_equal(std::pmr::memory_resource const& other) const noexcept
+{
+    return this == &other;
+}
+
+SlabPool::SlabPool(std::size_t blockSize, std::size_t blockCount, std::pmr::memory_resource* upstream)
+    : blockSize_(alignUp(std::max(blockSize, sizeof(FreeBlock)), BLOCK_ALIGN))
+    , blockCount_(blockCount)
+    , available_(blockCount)
+    , upstream_(upstream)
+{
+    // operator new[] is aligned to max_align_t, so are the blocks
+    buffer_.reset(new std::byte[blockSize_ * blockCount_]);
+
+    // thread blocks in address order
+    for (std::size_t i = blockCount_; i-- > 0; )
+    {
+        auto block { reinterpret_cast<FreeBlock*>(buffer_.get() + i * blockSize_) };
+        block->next = free_;
+        free_ = block;
+    }
+}
+
+bool SlabPool::owns(const void* p) const noexcept
+{
+    const auto ptr { static_cast<const std::byte*>(p) };
+    return ptr >= buffer_.get() and ptr < buffer_.get() + blockSize_ * blockCount_;
+}
+
+void* SlabPool::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (bytes > blockSize_ or alignment > BLOCK_ALIGN or nullptr == free_)
+    {
+        ++overflows_;
+        return upstream_->allocate(bytes, alignment);
+    }
+
+    auto block { free_ };
+    free_ = block->next;
+    --available_;
+    return block;
+}
+
+void SlabPool::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    if (not owns(p))
+    {
+        upstream_->deallocate(p, bytes, alignment);
+        return;
+    }
+
+    auto block { static_cast<FreeBlock*>(p) };
+    block->next = free_;
+    free_ = block;
+    ++available_;
+}
+
+bool SlabPool::do_is_equal(std::pmr::memory_resource const& other) const noexcept
+{
+    return this == &other;
+}
+
+TickArena& memory::tickArena()
+{
+    thread_local TickArena arena { TICK_ARENA_SIZE };
+    return arena;
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+
+#include <boost/noncopyable.hpp>
+
+namespace memory
+{
+    /*
+     * Линейный (bump) аллокатор временной памяти итерации цикла.
+     * Память выделяется сдвигом указателя и целиком освобождается
+     * reset() в конце итерации; deallocate() ничего не делает.
+     * При нехватке емкости запрос уходит в upstream (учитывается
+     * в overflows(), такие блоки освобождаются владельцем как обычно).
+     * Не потокобезопасен: один экземпляр на поток, см. tickArena().
+     */
+    class TickArena final : public std::pmr::memory_resource, boost::noncopyable
+    {
+    private:
+        std::unique_ptr<std::byte[]>    buffer_;
+        std::size_t                     capacity_   { 0 };
+        std::size_t                     offset_     { 0 };
+        std::size_t                     highWater_  { 0 };  // max offset since creation
+        std::uint64_t                   overflows_  { 0 };  // requests served by upstream
+        std::pmr::memory_resource*      upstream_;
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) final;
+        void  do_deallocate(void* p, std::size_t bytes, std::size_t alignment) final;
+        bool  do_is_equal(std::pmr::memory_resource const& other) const noexcept final;
+
+    public:
+        explicit TickArena(std::size_t capacity, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+        // Освободить всю память итерации
+        void reset() noexcept;
+
+        [[nodiscard]] std::size_t used() const noexcept { return offset_; }
+        [[nodiscard]] std::size_t capacity() const noexcept { return capacity_; }
+        [[nodiscard]] std::size_t highWater() const noexcept { return highWater_; }
+        [[nodiscard]] std::uint64_t overflows() const noexcept { return overflows_; }
+
+    };  // TickArena
+
+    /*
+     * Пул блоков одного размера (датаграммы, объекты сообщений).
+     * Все блоки выделяются при создании, свободные блоки связаны
+     * в список через собственную память; allocate/deallocate - O(1).
+     * Запросы больше блока или при пустом пуле уходят в upstream.
+     * Не потокобезопасен.
+     */
+    class SlabPool final : public std::pmr::memory_resource, boost::noncopyable
+    {
+    private:
+        struct FreeBlock { FreeBlock* next; };
+
+        std::unique_ptr<std::byte[]>    buffer_;
+        std::size_t                     blockSize_  { 0 };
+        std::size_t                     blockCount_ { 0 };
+        std::size_t                     available_  { 0 };
+        std::uint64_t                   overflows_  { 0 };
+        FreeBlock*                      free_       { nullptr };
+        std::pmr::memory_resource*      upstream_;
+
+        [[nodiscard]] bool owns(const void* p) const noexcept;
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) final;
+        void  do_deallocate(void* p, std::size_t bytes, std::size_t alignment) final;
+        bool  do_is_equal(std::pmr::memory_resource const& other) const noexcept final;
+
+    public:
+        SlabPool(std::size_t blockSize, std::size_t blockCount, std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
+
+        [[nodiscard]] std::size_t blockSize() const noexcept { return blockSize_; }
+        [[nodiscard]] std::size_t available() const noexcept { return available_; }
+        [[nodiscard]] std::uint64_t overflows() const noexcept { return overflows_; }
+
+    };  // SlabPool
+
+    // емкость временной памяти итерации сетевого потока
+    constexpr std::size_t TICK_ARENA_SIZE { 64 * 1024 };
+
+    // Временная память итерации вызывающего потока (создается при первом обращении)
+    TickArena& tickArena();
+
+}   // memory
@@ -0,0 +1,120 @@
+#include "crc32c.h"
+
+#include <array>
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define HERMES_X86 1
+#endif
+
+using namespace checksum;
+
+namespace
+{
+    using byte = std::uint8_t;
+
+    constexpr std::uint32_t POLY { 0x82f63b78 };    // reflected Castagnoli polynomial
+
+    // ---------------------------- slicing-by-8 -----------------------------
+
+    // table[k][b] - crc of byte b followed by k zero bytes
+    constexpr std::array<std::array<std::uint32_t, 256>, 8> makeTables() noexcept
+    {
+        std::array<std::array<std::uint32_t, 256>, 8> t {};
+        for (std::uint32_t b = 0; b < 256; ++b)
+        {
+            std::uint32_t crc { b };
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ (POLY & (0 - (crc & 1)));
+            t[0][b] = crc;
+        }
+        for (std::size_t k = 1; k < 8; ++k)
+            for (std::size_t b = 0; b < 256; ++b)
+                t[k][b] = (t[k - 1][b] >> 8) ^ t[0][t[k - 1][b] & 0xff];
+        return t;
+    }
+
+    constexpr auto TABLES { makeTables() };
+
+    std::uint32_t slice8Update(std::uint32_t crc, const byte* p, std::size_t n) noexcept
+    {
+        for (; n >= 8; n -= 8, p += 8)
+        {
+            // little endian: the crc is xored into the first four bytes
+            const std::uint32_t lo { crc ^ (p[0] | (std::uint32_t(p[1]) << 8) | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24)) };
+            crc = TABLES[7][lo & 0xff] ^ TABLES[6][(lo >> 8) & 0xff] ^ TABLES[5][(lo >> 16) & 0xff] ^ TABLES[4][lo >> 24]
+                ^ TABLES[3][p[4]] ^ TABLES[2][p[5]] ^ TABLES[1][p[6]] ^ TABLES[0][p[7]];
+        }
+        for (; n > 0; --n, ++p)
+            crc = (crc >> 8) ^ TABLES[0][(crc ^ *p) & 0xff];
+        return crc;
+    }
+
+    constexpr Kernels SLICE8_KERNELS { slice8Update, "slice8" };
+
+#if defined(HERMES_X86) && defined(__x86_64__)
+
+    // ------------------------------ SSE4.2 ------------------------------
+
+#define HERMES_SSE42 __attribute__((target("sse4.2")))
+
+    HERMES_SSE42 std::uint32_t sse42Update(std::uint32_t crc, const byte* p, std::size_t n) noexcept
+    {
+        std::uint64_t state { crc };
+        for (; n >= 8; n -= 8, p += 8)
+        {
+            std::uint64_t word;
+            std::memcpy(&word, p, 8);
+            state = _mm_crc32_u64(state, word);
+        }
+        crc = static_cast<std::uint32_t>(state);
+        if (n >= 4)
+        {
+            std::uint32_t word;
+            std::memcpy(&word, p, 4);
+            crc = _mm_crc32_u32(crc, word);
+            p += 4;
+            n -= 4;
+        }
+        for (; n > 0; --n, ++p)
+            crc = _mm_crc32_u8(crc, *p);
+        return crc;
+    }
+
+#undef HERMES_SSE42
+
+    constexpr Kernels SSE42_KERNELS { sse42Update, "sse42" };
+
+#endif  // HERMES_X86
+
+    const Kernels* selectKernels() noexcept
+    {
+#if defined(HERMES_X86) && defined(__x86_64__)
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("sse4.2")) return &SSE42_KERNELS;
+#endif
+        return &SLICE8_KERNELS;
+    }
+}
+
+// constant initialized, upgraded by CPU dispatch during static initialization
+const Kernels* checksum::active { &SLICE8_KERNELS };
+
+namespace
+{
+    struct Dispatch
+    {
+        Dispatch() noexcept { checksum::active = selectKernels(); }
+    } dispatch;
+}
+
+const Kernels* checksum::find(const char* name) noexcept
+{
+    if (0 == std::strcmp(name, "slice8")) return &SLICE8_KERNELS;
+#if defined(HERMES_X86) && defined(__x86_64__)
+    __builtin_cpu_init();
+    if (0 == std::strcmp(name, "sse42") and __builtin_cpu_supports("sse4.2")) return &SSE42_KERNELS;
+#endif
+    return nullptr;
+}
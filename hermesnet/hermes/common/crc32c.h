@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace checksum
+{
+    /*
+     * CRC32C (Castagnoli, as in iSCSI/SCTP/ext4) of short buffers.
+     * SSE4.2 crc32 instruction, 8 bytes per step, or slicing-by-8
+     * tables where it is not available; chosen once at startup by
+     * CPUID, see crc32c.cpp.
+     */
+    struct Kernels
+    {
+        // raw register update, no pre/post inversion
+        using UpdateFn = std::uint32_t (*)(std::uint32_t state, const std::uint8_t* data, std::size_t n) noexcept;
+
+        UpdateFn    update;
+        const char* name;
+    };
+
+    // active kernel set, never null (tables until CPU dispatch is done)
+    extern const Kernels* active;
+
+    // kernel sets by name: "sse42", "slice8" (nullptr if not supported by CPU)
+    const Kernels* find(const char* name) noexcept;
+
+    // Continue crc of preceding bytes with n more bytes (crc32cExtend(0, ...) - crc of data)
+    inline std::uint32_t crc32cExtend(std::uint32_t crc, const void* data, std::size_t n) noexcept {
+        return ~active->update(~crc, static_cast<const std::uint8_t*>(data), n);
+    }
+
+    inline std::uint32_t crc32c(const void* data, std::size_t n) noexcept {
+        return crc32cExtend(0, data, n);
+    }
+}
@@ -0,0 +1,171 @@
+#include "huge_pages.h"
+
+#include <algorithm>
+
+#include <sys/mman.h>
+
+using namespace memory;
+
+namespace
+{
+    constexpr std::size_t roundUp(std::size_t value, std::size_t step) noexcept
+    {
+        return (value + step - 1) / step * step;
+    }
+
+    void* mapAnonymous(std::size_t bytes, int flags) noexcept
+    {
+        void* p { mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | flags, -1, 0) };
+        return MAP_FAILED == p ? nullptr : p;
+    }
+
+    // huge page aligned mapping: THP only backs aligned 2 MB ranges
+    void* mapAligned(std::size_t bytes) noexcept
+    {
+        auto raw { static_cast<std::byte*>(mapAnonymous(bytes + HUGE_PAGE_SIZE, MAP_NORESERVE)) };
+        if (nullptr == raw) return nullptr;
+
+        const auto addr { reinterpret_cast<std::uintptr_t>(raw) };
+        const auto head { roundUp(addr, HUGE_PAGE_SIZE) - addr };
+        if (0 != head) munmap(raw, head);
+        munmap(raw + head + bytes, HUGE_PAGE_SIZE - head);
+        return raw + head;
+    }
+
+    // touch every page so faults are taken now and not in the loop
+    void touch(void* data, std::size_t bytes) noexcept
+    {
+        auto p { static_cast<volatile std::byte*>(data) };
+        for (std::size_t i = 0; i < bytes; i += REGULAR_PAGE_SIZE)
+            p[i] = std::byte { 0 };
+    }
+}
+
+PageRegion memory::mapRegion(std::size_t bytes, EPagePolicy policy, bool prefault)
+{
+    PageRegion region { nullptr, roundUp(bytes, HUGE_PAGE_SIZE), policy };
+
+#ifdef MAP_HUGETLB
+    if (EPagePolicy::EXPLICIT == policy)
+    {
+        // fails at once if the reserved pool is too small
+        region.data = mapAnonymous(region.size, MAP_HUGETLB | (prefault ? MAP_POPULATE : 0));
+        if (nullptr != region.data) return region;
+        region.pages = EPagePolicy::TRANSPARENT;
+    }
+#endif
+
+    if (EPagePolicy::REGULAR != region.pages)
+    {
+        region.data = mapAligned(region.size);
+#ifdef MADV_HUGEPAGE
+        if (nullptr != region.data and 0 != madvise(region.data, region.size, MADV_HUGEPAGE))
+            region.pages = EPagePolicy::REGULAR;
+#else
+        region.pages = EPagePolicy::REGULAR;
+#endif
+    }
+    else
+    {
+        region.size = roundUp(bytes, REGULAR_PAGE_SIZE);
+        region.data = mapAnonymous(region.size, 0);
+    }
+
+    if (nullptr == region.data) return {};
+
+    if (prefault) touch(region.data, region.size);
+    return region;
+}
+
+void memory::unmapRegion(PageRegion const& region) noexcept
+{
+    if (nullptr != region.data) munmap(region.data, region.size);
+}
+
+HugePagePool::HugePagePool(EPagePolicy policy, std::size_t regionSize, bool prefault)
+    : policy_(policy)
+    , regionSize_(roundUp(regionSize, HUGE_PAGE_SIZE))
+    , prefault_(prefault)
+{}
+
+HugePagePool::~HugePagePool()
+{
+    for (auto const& region : regions_)
+        unmapRegion(region);
+}
+
+void* HugePagePool::do_allocate(std::size_t bytes, std::size_t alignment)
+{
+    if (EPagePolicy::REGULAR == policy_)
+        return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+
+    std::lock_guard lock { mutex_ };
+
+    std::size_t begin { roundUp(offset_, alignment) };
+    if (regions_.empty() or begin + bytes > regions_.back().size)
+    {
+        // tail of the current region is abandoned, buffers are large and few
+        auto region { mapRegion(std::max(bytes, regionSize_), policy_, prefault_) };
+        if (nullptr == region.data)
+        {
+            heap_ += bytes;
+            return std::pmr::new_delete_resource()->allocate(bytes, alignment);
+        }
+
+        regions_.push_back(region);
+        begin = 0;
+    }
+
+    offset_ = begin + bytes;
+    return static_cast<std::byte*>(regions_.back().data) + begin;
+}
+
+void HugePagePool::do_deallocate(void* p, std::size_t bytes, std::size_t alignment)
+{
+    // pool memory is returned with regions on destruction
+    if (EPagePolicy::REGULAR == policy_)
+        return std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+
+    std::lock_guard lock { mutex_ };
+
+    const auto inside = [p](PageRegion const& region) {
+        const auto begin { static_cast<std::byte*>(region.data) };
+        return static_cast<std::byte*>(p) >= begin and static_cast<std::byte*>(p) < begin + region.size;
+    };
+    if (std::none_of(regions_.begin(), regions_.end(), inside))
+    {
+        heap_ -= bytes;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, alignment);
+    }
+}
+
+bool HugePagePool::do_is_equal(std::pmr::memory_resource const& other) const noexcept
+{
+    return this == &other;
+}
+
+std::size_t HugePagePool::mapped(EPagePolicy pages)
+{
+    std::lock_guard lock { mutex_ };
+
+    std::size_t total { 0 };
+    for (auto const& region : regions_)
+        if (pages == region.pages) total += region.size;
+    return total;
+}
+
+std::size_t HugePagePool::heap()
+{
+    std::lock_guard lock { mutex_ };
+    return heap_;
+}
+
+const char* memory::getPagePolicyName(EPagePolicy policy) noexcept
+{
+    switch (policy) {
+        case EPagePolicy::REGULAR:     return "regular";
+        case EPagePolicy::TRANSPARENT: return "transparent";
+        case EPagePolicy::EXPLICIT:    return "hugetlb";
+        default: return "undefined";
+    }
+}
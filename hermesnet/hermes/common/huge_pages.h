@@ -0,0 +1,79 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+
+#include <boost/noncopyable.hpp>
+
+namespace memory
+{
+    constexpr std::size_t REGULAR_PAGE_SIZE { 4 * 1024 };
+    constexpr std::size_t HUGE_PAGE_SIZE    { 2 * 1024 * 1024 };
+
+    enum class EPagePolicy : std::uint8_t
+    {
+        REGULAR = 0,    // plain heap memory
+        TRANSPARENT,    // anonymous mmap advised with MADV_HUGEPAGE
+        EXPLICIT,       // MAP_HUGETLB (reserved pool, vm.nr_hugepages), THP if none left
+    };
+
+    /*
+     * Отображенная область памяти и тип страниц, которые
+     * удалось получить (может быть ниже запрошенного).
+     */
+    struct PageRegion
+    {
+        void*           data    { nullptr };
+        std::size_t     size    { 0 };
+        EPagePolicy     pages   { EPagePolicy::REGULAR };
+    };
+
+    // Отобразить не меньше bytes байт, при неудаче переходит к следующему типу страниц
+    PageRegion mapRegion(std::size_t bytes, EPagePolicy policy, bool prefault);
+    void unmapRegion(PageRegion const& region) noexcept;
+
+    /*
+     * Источник долгоживущей памяти буферов (кольцевые буферы, очереди
+     * между шардами) на больших страницах: память нарезается из областей
+     * по regionSize, области отображаются и заполняются заранее, чтобы
+     * цикл обработки не ловил page fault и промахи TLB. Освобождение
+     * отдельных блоков ничего не делает, области возвращаются системе
+     * при разрушении пула. При REGULAR запросы уходят в кучу, туда же
+     * при неудаче отображения (пул не бросает bad_alloc сам, серверы
+     * создают буферы в noexcept конструкторах).
+     */
+    class HugePagePool final : public std::pmr::memory_resource, boost::noncopyable
+    {
+    private:
+        EPagePolicy                 policy_;
+        std::size_t                 regionSize_;
+        bool                        prefault_;
+
+        std::mutex                  mutex_;         // buffers are created by different threads at startup
+        std::vector<PageRegion>     regions_;
+        std::size_t                 offset_     { 0 };  // in the last region
+        std::size_t                 heap_       { 0 };  // bytes taken from the heap after failed mappings
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) final;
+        void  do_deallocate(void* p, std::size_t bytes, std::size_t alignment) final;
+        bool  do_is_equal(std::pmr::memory_resource const& other) const noexcept final;
+
+    public:
+        explicit HugePagePool(EPagePolicy policy, std::size_t regionSize = HUGE_PAGE_SIZE, bool prefault = true);
+        virtual ~HugePagePool();
+
+        [[nodiscard]] EPagePolicy policy() const noexcept { return policy_; }
+        // Отображено байт на страницах данного типа
+        [[nodiscard]] std::size_t mapped(EPagePolicy pages);
+        // Взято байт из кучи, когда отобразить область не удалось
+        [[nodiscard]] std::size_t heap();
+
+    };  // HugePagePool
+
+    // Имя типа страниц для журнала
+    const char* getPagePolicyName(EPagePolicy policy) noexcept;
+
+}   // memory
@@ -0,0 +1,68 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <algorithm>
+
+namespace utility::bench
+{
+    /*
+     *  Гистограмма задержек с логарифмическими интервалами
+     *  (8 подинтервалов на каждую степень двойки, погрешность < 12.5%).
+     *  Без выделения памяти и блокировок: один экземпляр на поток.
+     */
+    class LatencyHistogram
+    {
+    private:
+        static constexpr std::uint32_t SUB_BITS    { 3 };
+        static constexpr std::uint32_t SUB_BUCKETS { 1u << SUB_BITS };
+        static constexpr std::uint32_t BUCKETS     { (64 - SUB_BITS + 1) * SUB_BUCKETS };
+
+        std::array<std::uint64_t, BUCKETS>  counts_ {};
+        std::uint64_t                       total_  { 0 };
+        std::uint64_t                       max_    { 0 };
+
+        static std::uint32_t indexOf(std::uint64_t v) noexcept {
+            if (v < SUB_BUCKETS) return static_cast<std::uint32_t>(v);
+            const std::uint32_t msb { 63u - static_cast<std::uint32_t>(__builtin_clzll(v)) };
+            const std::uint32_t sub { static_cast<std::uint32_t>(v >> (msb - SUB_BITS)) & (SUB_BUCKETS - 1) };
+            return (msb - SUB_BITS + 1) * SUB_BUCKETS + sub;
+        }
+
+        static std::uint64_t lowerBound(std::uint32_t index) noexcept {
+            if (index < SUB_BUCKETS) return index;
+            const std::uint32_t msb { index / SUB_BUCKETS + SUB_BITS - 1 };
+            const std::uint64_t sub { index % SUB_BUCKETS };
+            return (std::uint64_t(1) << msb) | (sub << (msb - SUB_BITS));
+        }
+
+    public:
+        void record(std::uint64_t value) noexcept {
+            ++counts_[indexOf(value)];
+            ++total_;
+            max_ = std::max(max_, value);
+        }
+
+        // p in [0.0 .. 1.0], returns bucket lower bound
+        [[nodiscard]] std::uint64_t percentile(double p) const noexcept {
+            if (0 == total_) return 0;
+            const auto rank { static_cast<std::uint64_t>(p * static_cast<double>(total_ - 1)) + 1 };
+            std::uint64_t seen { 0 };
+            for (std::uint32_t i = 0; i < BUCKETS; ++i) {
+                seen += counts_[i];
+                if (seen >= rank) return lowerBound(i);
+            }
+            return max_;
+        }
+
+        [[nodiscard]] std::uint64_t count() const noexcept { return total_; }
+        [[nodiscard]] std::uint64_t max() const noexcept { return max_; }
+
+        void reset() noexcept {
+            counts_.fill(0);
+            total_ = 0;
+            max_ = 0;
+        }
+    };
+
+}   // utility::bench
@@ -0,0 +1,380 @@
+#include "memory.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define HERMES_X86 1
+#endif
+
+using namespace memory;
+
+namespace
+{
+    using byte = std::uint8_t;
+
+    // ------------------------------ libc ------------------------------
+
+    void libcCopy(void* dst, const void* src, std::size_t n) noexcept { std::memcpy(dst, src, n); }
+    void libcMove(void* dst, const void* src, std::size_t n) noexcept { std::memmove(dst, src, n); }
+    void libcZero(void* dst, std::size_t n) noexcept { std::memset(dst, 0x0, n); }
+    int  libcCompare(const void* a, const void* b, std::size_t n) noexcept { return std::memcmp(a, b, n); }
+
+    constexpr Kernels LIBC_KERNELS { libcCopy, libcMove, libcZero, libcCompare, "libc" };
+
+    // ---------------------------- common -----------------------------
+
+    // copies and compares from this size go to libc: rep movsb and its wider
+    // unrolled memcmp win there (sandbox/memory_benchmark), the kernels below it
+    constexpr std::size_t LIBC_FROM { 128 };
+
+    // n < 16; all loads are done before stores, so overlapping blocks are fine
+    inline void copySmall(byte* d, const byte* s, std::size_t n) noexcept
+    {
+        if (n >= 8) {
+            std::uint64_t a, b;
+            std::memcpy(&a, s, 8);
+            std::memcpy(&b, s + n - 8, 8);
+            std::memcpy(d, &a, 8);
+            std::memcpy(d + n - 8, &b, 8);
+        }
+        else if (n >= 4) {
+            std::uint32_t a, b;
+            std::memcpy(&a, s, 4);
+            std::memcpy(&b, s + n - 4, 4);
+            std::memcpy(d, &a, 4);
+            std::memcpy(d + n - 4, &b, 4);
+        }
+        else if (n > 0) {
+            const byte a { s[0] }, b { s[n / 2] }, c { s[n - 1] };
+            d[0] = a;
+            d[n / 2] = b;
+            d[n - 1] = c;
+        }
+    }
+
+    inline void zeroSmall(byte* d, std::size_t n) noexcept
+    {
+        const std::uint64_t z { 0 };
+        if (n >= 8) {
+            std::memcpy(d, &z, 8);
+            std::memcpy(d + n - 8, &z, 8);
+        }
+        else if (n >= 4) {
+            std::memcpy(d, &z, 4);
+            std::memcpy(d + n - 4, &z, 4);
+        }
+        else if (n > 0) {
+            d[0] = d[n / 2] = d[n - 1] = 0;
+        }
+    }
+
+    // order of two different words read as big endian, as memcmp orders their bytes
+    template <typename Word>
+    inline int orderWords(Word a, Word b) noexcept
+    {
+        if constexpr (sizeof(Word) == 8) { a = __builtin_bswap64(a); b = __builtin_bswap64(b); }
+        else { a = __builtin_bswap32(a); b = __builtin_bswap32(b); }
+        return a < b ? -1 : 1;
+    }
+
+    // n < 16; the second word overlaps the first, its leading bytes are already equal
+    inline int compareSmall(const byte* a, const byte* b, std::size_t n) noexcept
+    {
+        if (n >= 8) {
+            std::uint64_t x, y;
+            std::memcpy(&x, a, 8);
+            std::memcpy(&y, b, 8);
+            if (x != y) return orderWords(x, y);
+            std::memcpy(&x, a + n - 8, 8);
+            std::memcpy(&y, b + n - 8, 8);
+            return x != y ? orderWords(x, y) : 0;
+        }
+        if (n >= 4) {
+            std::uint32_t x, y;
+            std::memcpy(&x, a, 4);
+            std::memcpy(&y, b, 4);
+            if (x != y) return orderWords(x, y);
+            std::memcpy(&x, a + n - 4, 4);
+            std::memcpy(&y, b + n - 4, 4);
+            return x != y ? orderWords(x, y) : 0;
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            if (a[i] != b[i]) return static_cast<int>(a[i]) - static_cast<int>(b[i]);
+        }
+        return 0;
+    }
+
+    // difference of the first unequal byte, eq - bit per equal byte (not all set)
+    template <typename Mask>
+    inline int firstDiff(const byte* a, const byte* b, Mask eq) noexcept
+    {
+        const auto k { static_cast<unsigned>(sizeof(Mask) == 8 ? __builtin_ctzll(~eq) : __builtin_ctz(static_cast<unsigned>(~eq))) };
+        return static_cast<int>(a[k]) - static_cast<int>(b[k]);
+    }
+
+#ifdef HERMES_X86
+
+    // ------------------------------ SSE2 ------------------------------
+
+    inline __m128i load16(const byte* p) noexcept { return _mm_loadu_si128(reinterpret_cast<const __m128i*>(p)); }
+    inline void store16(byte* p, __m128i v) noexcept { _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v); }
+
+    // 16 <= n <= 32
+    inline void copy16to32(byte* d, const byte* s, std::size_t n) noexcept
+    {
+        const __m128i head { load16(s) };
+        const __m128i tail { load16(s + n - 16) };
+        store16(d, head);
+        store16(d + n - 16, tail);
+    }
+
+    // 32 <= n <= 64
+    inline void copy32to64Sse2(byte* d, const byte* s, std::size_t n) noexcept
+    {
+        const __m128i a { load16(s) }, b { load16(s + 16) }, c { load16(s + n - 32) }, e { load16(s + n - 16) };
+        store16(d, a); store16(d + 16, b); store16(d + n - 32, c); store16(d + n - 16, e);
+    }
+
+    void sse2Copy(void* dst, const void* src, std::size_t n) noexcept
+    {
+        auto d { static_cast<byte*>(dst) };
+        auto s { static_cast<const byte*>(src) };
+
+        if (n >= LIBC_FROM) return libcCopy(d, s, n);
+        if (n < 16) return copySmall(d, s, n);
+        if (n <= 32) return copy16to32(d, s, n);
+        if (n <= 64) return copy32to64Sse2(d, s, n);
+
+        // whole 64 byte steps, the last 64 bytes overlap the final step
+        const auto t { s + n - 64 };
+        const __m128i t0 { load16(t) }, t1 { load16(t + 16) }, t2 { load16(t + 32) }, t3 { load16(t + 48) };
+        for (std::size_t i = 0; i + 64 < n; i += 64) {
+            const __m128i a { load16(s + i) }, b { load16(s + i + 16) }, c { load16(s + i + 32) }, e { load16(s + i + 48) };
+            store16(d + i, a); store16(d + i + 16, b); store16(d + i + 32, c); store16(d + i + 48, e);
+        }
+        const auto u { d + n - 64 };
+        store16(u, t0); store16(u + 16, t1); store16(u + 32, t2); store16(u + 48, t3);
+    }
+
+    void sse2Move(void* dst, const void* src, std::size_t n) noexcept
+    {
+        auto d { static_cast<byte*>(dst) };
+        auto s { static_cast<const byte*>(src) };
+
+        if (n < 16) return copySmall(d, s, n);
+        if (n <= 32) return copy16to32(d, s, n);
+
+        // forward copy is safe if destination starts before source or blocks don't overlap
+        if (static_cast<std::size_t>(d - s) >= n) {
+            const __m128i tail { load16(s + n - 16) };
+            for (std::size_t i = 0; i < n - 16; i += 16)
+                store16(d + i, load16(s + i));
+            store16(d + n - 16, tail);
+        }
+        else {
+            // backward by whole blocks; source head [0, p) is never overwritten by them
+            std::size_t p { n - 16 };
+            for (; p >= 16; p -= 16)
+                store16(d + p, load16(s + p));
+            copy16to32(d, s, p + 16);
+        }
+    }
+
+    void sse2Zero(void* dst, std::size_t n) noexcept
+    {
+        auto d { static_cast<byte*>(dst) };
+        if (n < 16) return zeroSmall(d, n);
+
+        const __m128i z { _mm_setzero_si128() };
+        for (std::size_t i = 0; i < n - 16; i += 16)
+            store16(d + i, z);
+        store16(d + n - 16, z);
+    }
+
+    // bit per equal byte of 16 bytes blocks
+    inline std::uint32_t equal16(const byte* a, const byte* b) noexcept
+    {
+        return static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(load16(a), load16(b))));
+    }
+
+    int sse2Compare(const void* lhs, const void* rhs, std::size_t n) noexcept
+    {
+        auto a { static_cast<const byte*>(lhs) };
+        auto b { static_cast<const byte*>(rhs) };
+        if (n < 16) return compareSmall(a, b, n);
+        if (n >= LIBC_FROM) return libcCompare(a, b, n);
+
+        // 32 bytes per step, one movemask of both halves decides the early out
+        std::size_t i { 0 };
+        for (; i + 32 <= n; i += 32) {
+            const __m128i lo { _mm_cmpeq_epi8(load16(a + i), load16(b + i)) };
+            const __m128i hi { _mm_cmpeq_epi8(load16(a + i + 16), load16(b + i + 16)) };
+            if (0xFFFF != _mm_movemask_epi8(_mm_and_si128(lo, hi))) {
+                const auto eq { static_cast<std::uint32_t>(_mm_movemask_epi8(lo)) | (static_cast<std::uint32_t>(_mm_movemask_epi8(hi)) << 16) };
+                return firstDiff(a + i, b + i, eq);
+            }
+        }
+
+        // the rest is covered by overlapping blocks, the bytes they repeat are equal
+        if (i + 16 < n)
+            if (const auto eq { equal16(a + i, b + i) }; 0xFFFF != eq) return firstDiff(a + i, b + i, eq);
+        if (i < n)
+            if (const auto eq { equal16(a + n - 16, b + n - 16) }; 0xFFFF != eq) return firstDiff(a + n - 16, b + n - 16, eq);
+        return 0;
+    }
+
+    constexpr Kernels SSE2_KERNELS { sse2Copy, sse2Move, sse2Zero, sse2Compare, "sse2" };
+
+    // ------------------------------ AVX2 ------------------------------
+
+#define HERMES_AVX2 __attribute__((target("avx2")))
+
+    HERMES_AVX2 inline __m256i load32(const byte* p) noexcept { return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)); }
+    HERMES_AVX2 inline void store32(byte* p, __m256i v) noexcept { _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v); }
+
+    // 32 <= n <= 64
+    HERMES_AVX2 inline void copy32to64(byte* d, const byte* s, std::size_t n) noexcept
+    {
+        const __m256i head { load32(s) };
+        const __m256i tail { load32(s + n - 32) };
+        store32(d, head);
+        store32(d + n - 32, tail);
+    }
+
+    // 64 <= n <= 128
+    HERMES_AVX2 inline void copy64to128(byte* d, const byte* s, std::size_t n) noexcept
+    {
+        const __m256i a { load32(s) }, b { load32(s + 32) }, c { load32(s + n - 64) }, e { load32(s + n - 32) };
+        store32(d, a); store32(d + 32, b); store32(d + n - 64, c); store32(d + n - 32, e);
+    }
+
+    HERMES_AVX2 void avx2Copy(void* dst, const void* src, std::size_t n) noexcept
+    {
+        auto d { static_cast<byte*>(dst) };
+        auto s { static_cast<const byte*>(src) };
+
+        if (n >= LIBC_FROM) return libcCopy(d, s, n);
+        if (n < 16) return copySmall(d, s, n);
+        if (n <= 32) return copy16to32(d, s, n);
+        if (n <= 64) return copy32to64(d, s, n);
+        if (n <= 128) return copy64to128(d, s, n);
+
+        // whole 128 byte steps, the last 128 bytes overlap the final step
+        const auto t { s + n - 128 };
+        const __m256i t0 { load32(t) }, t1 { load32(t + 32) }, t2 { load32(t + 64) }, t3 { load32(t + 96) };
+        for (std::size_t i = 0; i + 128 < n; i += 128) {
+            const __m256i a { load32(s + i) }, b { load32(s + i + 32) }, c { load32(s + i + 64) }, e { load32(s + i + 96) };
+            store32(d + i, a); store32(d + i + 32, b); store32(d + i + 64, c); store32(d + i + 96, e);
+        }
+        const auto u { d + n - 128 };
+        store32(u, t0); store32(u + 32, t1); store32(u + 64, t2); store32(u + 96, t3);
+    }
+
+    HERMES_AVX2 void avx2Move(void* dst, const void* src, std::size_t n) noexcept
+    {
+        auto d { static_cast<byte*>(dst) };
+        auto s { static_cast<const byte*>(src) };
+
+        if (n < 16) return copySmall(d, s, n);
+        if (n <= 32) return copy16to32(d, s, n);
+        if (n <= 64) return copy32to64(d, s, n);
+        if (n <= 128) return copy64to128(d, s, n);
+
+        if (static_cast<std::size_t>(d - s) >= n) {
+            const __m256i tail { load32(s + n - 32) };
+            for (std::size_t i = 0; i < n - 32; i += 32)
+                store32(d + i, load32(s + i));
+            store32(d + n - 32, tail);
+        }
+        else {
+            std::size_t p { n - 32 };
+            for (; p >= 32; p -= 32)
+                store32(d + p, load32(s + p));
+            copy32to64(d, s, p + 32);
+        }
+    }
+
+    HERMES_AVX2 void avx2Zero(void* dst, std::size_t n) noexcept
+    {
+        auto d { static_cast<byte*>(dst) };
+        if (n < 32) return sse2Zero(d, n);
+
+        const __m256i z { _mm256_setzero_si256() };
+        for (std::size_t i = 0; i < n - 32; i += 32)
+            store32(d + i, z);
+        store32(d + n - 32, z);
+    }
+
+    // bit per equal byte of 32 bytes blocks
+    HERMES_AVX2 inline std::uint32_t equal32(const byte* a, const byte* b) noexcept
+    {
+        return static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(load32(a), load32(b))));
+    }
+
+    HERMES_AVX2 int avx2Compare(const void* lhs, const void* rhs, std::size_t n) noexcept
+    {
+        auto a { static_cast<const byte*>(lhs) };
+        auto b { static_cast<const byte*>(rhs) };
+        if (n < 32) return sse2Compare(a, b, n);
+        if (n >= LIBC_FROM) return libcCompare(a, b, n);
+
+        // 64 bytes per step, one movemask of both halves decides the early out
+        std::size_t i { 0 };
+        for (; i + 64 <= n; i += 64) {
+            const __m256i lo { _mm256_cmpeq_epi8(load32(a + i), load32(b + i)) };
+            const __m256i hi { _mm256_cmpeq_epi8(load32(a + i + 32), load32(b + i + 32)) };
+            if (-1 != _mm256_movemask_epi8(_mm256_and_si256(lo, hi))) {
+                const auto eq { static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(lo))) |
+                                (static_cast<std::uint64_t>(static_cast<std::uint32_t>(_mm256_movemask_epi8(hi))) << 32) };
+                return firstDiff(a + i, b + i, eq);
+            }
+        }
+
+        // the rest is covered by overlapping blocks, the bytes they repeat are equal
+        if (i + 32 < n)
+            if (const auto eq { equal32(a + i, b + i) }; ~0u != eq) return firstDiff(a + i, b + i, eq);
+        if (i < n)
+            if (const auto eq { equal32(a + n - 32, b + n - 32) }; ~0u != eq) return firstDiff(a + n - 32, b + n - 32, eq);
+        return 0;
+    }
+
+#undef HERMES_AVX2
+
+    constexpr Kernels AVX2_KERNELS { avx2Copy, avx2Move, avx2Zero, avx2Compare, "avx2" };
+
+#endif  // HERMES_X86
+
+    const Kernels* selectKernels() noexcept
+    {
+#ifdef HERMES_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return &AVX2_KERNELS;
+        return &SSE2_KERNELS;
+#else
+        return &LIBC_KERNELS;
+#endif
+    }
+}
+
+// constant initialized, upgraded by CPU dispatch during static initialization
+const Kernels* memory::active { &LIBC_KERNELS };
+
+namespace
+{
+    struct Dispatch
+    {
+        Dispatch() noexcept { memory::active = selectKernels(); }
+    } dispatch;
+}
+
+const Kernels* memory::find(const char* name) noexcept
+{
+    if (0 == std::strcmp(name, "libc")) return &LIBC_KERNELS;
+#ifdef HERMES_X86
+    __builtin_cpu_init();
+    if (0 == std::strcmp(name, "sse2")) return &SSE2_KERNELS;
+    if (0 == std::strcmp(name, "avx2") and __builtin_cpu_supports("avx2")) return &AVX2_KERNELS;
+#endif
+    return nullptr;
+}
@@ -1,32 +1,63 @@
 #pragma once
 
 #include <boost/noncopyable.hpp>
+#include <cassert>
+#include <cstdint>
 #include <cstring>
 #include <memory>
 
 namespace memory
 {
-    inline void memcpy(void *dst, void *src, std::size_t n) noexcept {
-        using ptr = std::uint8_t* ;
-        auto dst_ = reinterpret_cast<ptr>(dst);
-        auto src_ = reinterpret_cast<ptr>(src);
-        assert(nullptr != dst_);
-        assert(nullptr != src_);
-        for (std::size_t i = 0; i < n; ++i) {
-            dst_[i] = src_[i];
-        }
+    /*
+     * Memory kernels tuned for datagram sized blocks (16..1500 bytes).
+     * The best implementation (AVX2 / SSE2 / libc) is chosen once
+     * at startup by CPUID, see memory.cpp. Copies and compares of
+     * large blocks are handed to libc by the kernels themselves.
+     */
+    struct Kernels
+    {
+        using CopyFn    = void (*)(void* dst, const void* src, std::size_t n) noexcept;
+        using MoveFn    = void (*)(void* dst, const void* src, std::size_t n) noexcept;
+        using ZeroFn    = void (*)(void* dst, std::size_t n) noexcept;
+        using CompareFn = int  (*)(const void* a, const void* b, std::size_t n) noexcept;
+
+        CopyFn      copy;
+        MoveFn      move;
+        ZeroFn      zero;
+        CompareFn   compare;
+        const char* name;
+    };
+
+    // active kernel set, never null (portable kernels until CPU dispatch is done)
+    extern const Kernels* active;
+
+    // kernel sets by name: "avx2", "sse2", "libc" (nullptr if not supported by CPU)
+    const Kernels* find(const char* name) noexcept;
+
+    // non overlapping copy
+    inline void memcpy(void *dst, const void *src, std::size_t n) noexcept {
+        assert(nullptr != dst);
+        assert(nullptr != src);
+        active->copy(dst, src, n);
     }
 
-    inline void memmove(void *dst, void *src, std::size_t n) noexcept {
-        using ptr = std::uint8_t *;
-        auto dst_ = reinterpret_cast<ptr>(dst);
-        auto src_ = reinterpret_cast<ptr>(src);
-        assert(nullptr != dst_);
-        assert(nullptr != src_);
-        for (std::size_t i = 0; i < n; ++i) {
-            std::swap(dst_[i], src_[i]);
-            std::memset(src_, 0x0, 1);
-        }
+    // copy of possibly overlapping blocks
+    inline void memmove(void *dst, const void *src, std::size_t n) noexcept {
+        assert(nullptr != dst);
+        assert(nullptr != src);
+        active->move(dst, src, n);
+    }
+
+    inline void memzero(void *dst, std::size_t n) noexcept {
+        assert(nullptr != dst);
+        active->zero(dst, n);
+    }
+
+    // memcmp semantic: <0, 0, >0
+    inline int memcmp(const void *a, const void *b, std::size_t n) noexcept {
+        assert(nullptr != a);
+        assert(nullptr != b);
+        return active->compare(a, b, n);
     }
 
     template<typename T>
@@ -1,7 +1,13 @@
 #pragma once
 
+#include <chrono>
+#include <vector>
+#include <cstdint>
+
 #include <boost/asio.hpp>
 
+#include <hermes/crypto/chacha20_poly1305.h>
+
 namespace network
 {
 #ifndef ASIO_TYPEDEF
@@ -37,12 +43,71 @@ namespace network
         std::vector<std::uint32_t>          vUUIDs;         // unique id for each client
         std::vector<std::uint8_t>           vAccessCodes;   // client's unique access byte (each connection)
 
+        // egress rate control and pacing, see data_sender/rate_control.h
+        using TimePoint = std::chrono::steady_clock::time_point;
+
+        std::vector<double>                 vSendRate;      // bytes per second
+        std::vector<double>                 vPaceTokens;    // bytes the pacer may send now
+        std::vector<TimePoint>              vPaceTime;      // last token refill
+        std::vector<float>                  vSmoothRtt;     // ms
+        std::vector<float>                  vMinRtt;        // ms, path delay without queuing
+        std::vector<TimePoint>              vMinRttTime;
+        std::vector<float>                  vLossRate;      // smoothed share of lost datagrams
+        std::vector<TimePoint>              vFeedbackTime;  // last rate update
+        std::vector<TimePoint>              vDecreaseTime;  // last rate decrease
+
+        // sealed sessions, see message/datagram_cipher.h
+        std::vector<std::uint8_t>           vSealed;            // session keys are set, plaintext is rejected
+        std::vector<crypto::Key>            vSendKeys;
+        std::vector<crypto::Key>            vReceiveKeys;
+        std::vector<std::uint64_t>          vSendSequence;      // number of the next sealed datagram
+        std::vector<std::uint64_t>          vReceiveSequence;   // highest authenticated number
+        std::vector<std::uint64_t>          vReplayWindow;      // accepted numbers behind it, see acceptSequence
+
         void reserve(std::uint32_t count) {
             vIn.reserve(count);
             vOut.reserve(count);
             vEndpoints.reserve(count);
             vUUIDs.reserve(count);
             vAccessCodes.reserve(count);
+
+            vSendRate.reserve(count);
+            vPaceTokens.reserve(count);
+            vPaceTime.reserve(count);
+            vSmoothRtt.reserve(count);
+            vMinRtt.reserve(count);
+            vMinRttTime.reserve(count);
+            vLossRate.reserve(count);
+            vFeedbackTime.reserve(count);
+            vDecreaseTime.reserve(count);
+
+            vSealed.reserve(count);
+            vSendKeys.reserve(count);
+            vReceiveKeys.reserve(count);
+            vSendSequence.reserve(count);
+            vReceiveSequence.reserve(count);
+            vReplayWindow.reserve(count);
+        }
+
+        // Ключи сессии клиента, заданные при рукопожатии (строки добавляются при необходимости)
+        void establishSession(std::size_t client, crypto::Key const& send, crypto::Key const& receive) {
+            if (vSealed.size() <= client)
+            {
+                const auto rows { client + 1 };
+                vSealed.resize(rows, 0);
+                vSendKeys.resize(rows);
+                vReceiveKeys.resize(rows);
+                vSendSequence.resize(rows);
+                vReceiveSequence.resize(rows);
+                vReplayWindow.resize(rows);
+            }
+
+            vSealed[client] = 1;
+            vSendKeys[client] = send;
+            vReceiveKeys[client] = receive;
+            vSendSequence[client] = 0;
+            vReceiveSequence[client] = 0;
+            vReplayWindow[client] = 0;
         }
     };
 
@@ -11,7 +11,7 @@ namespace network::types
 {
     // TODO: move all into config module
 
-    static constexpr std::size_t   DATAGRAM_SIZE        { 64 };
+    static constexpr std::size_t   DATAGRAM_SIZE        { 64 };     // on the wire
 
     static constexpr std::uint16_t SERVER_IN_PORT       { 7000 };
     static constexpr std::uint16_t SERVER_OUT_PORT      { 7001 };
@@ -19,8 +19,8 @@ namespace network::types
     static constexpr std::uint8_t  SERVER_ACCESS_CODE   { 0xEA };
     static constexpr std::uint8_t  END_MESSAGE_BYTE     { 0xFF };
 
-    static constexpr std::uint32_t ACCESS_BYTE_POS      { 7 };
-    static constexpr std::uint32_t END_MESSAGE_BYTE_POS { 51 };
+    static constexpr std::uint32_t ACCESS_BYTE_POS      { 3 };      // in the wire image
+    static constexpr std::uint32_t END_MESSAGE_BYTE_POS { 57 };     // in the body buffer
 
     static constexpr std::uint32_t MAX_CLIENTS          { 100 };
     static constexpr std::uint32_t SOCK_BUF_SIZE        { 8192 }; // 64/128 messages count
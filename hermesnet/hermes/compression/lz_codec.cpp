@@ -0,0 +1,252 @@
+#include "lz_codec.h"
+
+#include <cstring>
+#include <algorithm>
+
+using namespace network::compression;
+
+namespace
+{
+    using byte = std::uint8_t;
+
+    constexpr std::size_t TOKEN_MAX { 15 };
+
+    inline std::uint32_t load32(const byte* p) noexcept
+    {
+        std::uint32_t v;
+        std::memcpy(&v, p, sizeof(v));
+        return v;
+    }
+
+    inline std::size_t hash(const byte* p) noexcept
+    {
+        return (load32(p) * 2654435761u) >> (32 - HASH_BITS);
+    }
+
+    // equal bytes of a and b, up to limit
+    inline std::size_t matchLength(const byte* a, const byte* b, std::size_t limit) noexcept
+    {
+        std::size_t n { 0 };
+        for (; n + 8 <= limit; n += 8)
+        {
+            std::uint64_t x, y;
+            std::memcpy(&x, a + n, 8);
+            std::memcpy(&y, b + n, 8);
+            if (x != y) return n + (__builtin_ctzll(x ^ y) >> 3);   // little endian
+        }
+        while (n < limit and a[n] == b[n]) ++n;
+        return n;
+    }
+
+    // output bounded by the limit, a write past it fails the whole payload
+    class Writer
+    {
+    private:
+        byte*       out_;
+        std::size_t limit_;
+        std::size_t size_   { 0 };
+        bool        failed_ { false };
+
+    public:
+        Writer(byte* out, std::size_t limit) noexcept : out_ { out }, limit_ { limit } {}
+
+        void put(byte b) noexcept {
+            if (size_ >= limit_) { failed_ = true; return; }
+            out_[size_++] = b;
+        }
+
+        void put(const byte* p, std::size_t n) noexcept {
+            if (n > limit_ - std::min(size_, limit_)) { failed_ = true; return; }
+            std::memcpy(out_ + size_, p, n);
+            size_ += n;
+        }
+
+        // the rest of a token field: 255 bytes, then the remainder
+        void length(std::size_t n) noexcept {
+            for (; n >= 255; n -= 255) put(255);
+            put(static_cast<byte>(n));
+        }
+
+        [[nodiscard]] std::size_t size() const noexcept { return failed_ ? 0 : size_; }
+    };
+
+    void sequence(Writer& w, const byte* literals, std::size_t count, std::size_t offset, std::size_t match) noexcept
+    {
+        const std::size_t extra { 0 != match ? match - MIN_MATCH : 0 };
+        w.put(static_cast<byte>((std::min(count, TOKEN_MAX) << 4) | std::min(extra, TOKEN_MAX)));
+        if (count >= TOKEN_MAX) w.length(count - TOKEN_MAX);
+        w.put(literals, count);
+        if (0 == match) return;
+
+        w.put(static_cast<byte>(offset));
+        w.put(static_cast<byte>(offset >> 8));
+        if (extra >= TOKEN_MAX) w.length(extra - TOKEN_MAX);
+    }
+
+    // input bounded reader of the compressed payload
+    class Reader
+    {
+    private:
+        const byte* in_;
+        const byte* end_;
+        bool        failed_ { false };
+
+    public:
+        Reader(const byte* in, std::size_t size) noexcept : in_ { in }, end_ { in + size } {}
+
+        byte get() noexcept {
+            if (in_ == end_) { failed_ = true; return 0; }
+            return *in_++;
+        }
+
+        const byte* take(std::size_t n) noexcept {
+            if (n > static_cast<std::size_t>(end_ - in_)) { failed_ = true; return nullptr; }
+            const byte* p { in_ };
+            in_ += n;
+            return p;
+        }
+
+        std::size_t length(std::size_t field) noexcept {
+            if (TOKEN_MAX != field) return field;
+            for (byte b { 255 }; 255 == b and not failed_; field += b)
+                b = get();
+            return field;
+        }
+
+        [[nodiscard]] bool failed() const noexcept { return failed_; }
+        [[nodiscard]] bool done() const noexcept { return in_ == end_; }
+    };
+}
+
+Dictionary::Dictionary(const std::uint8_t* data, std::size_t size) noexcept
+{
+    // the tail is kept, it is the nearest to the payload
+    size_ = std::min(size, MAX_DICTIONARY);
+    if (0 == size_) return;
+    std::memcpy(bytes_.data(), data + size - size_, size_);
+
+    for (std::size_t p = 0; p + MIN_MATCH <= size_; ++p)
+        table_[hash(bytes_.data() + p)] = static_cast<std::uint16_t>(p + 1);
+}
+
+Compressor::Compressor(CompressConfig config) noexcept
+    : config_(config)
+{}
+
+std::size_t Compressor::compress(const std::uint8_t* payload, std::size_t size, std::uint8_t* out, std::size_t capacity) noexcept
+{
+    if (ECompressMode::NONE == config_.mode or 0 == size or size < config_.minSize or size > MAX_MESSAGE) return 0;
+
+    const byte* dict { nullptr != config_.dictionary ? config_.dictionary->data() : nullptr };
+    const std::size_t dictSize { nullptr != dict ? config_.dictionary->size() : 0 };
+
+    // window positions: dictionary first, then the payload; no gain - sent as is
+    Writer w { out, std::min(capacity, size - 1) };
+    for (std::size_t n { size }; ; n >>= 7)
+    {
+        if (n < 0x80) { w.put(static_cast<byte>(n)); break; }
+        w.put(static_cast<byte>(n | 0x80));
+    }
+
+    std::size_t anchor { 0 };
+    for (std::size_t i = 0; i + MIN_MATCH <= size; )
+    {
+        const std::size_t h { hash(payload + i) };
+        const std::size_t here { dictSize + i };
+        std::size_t length { 0 }, from { 0 };
+
+        // positions of older payloads are checked by their bytes like any other
+        const std::size_t own { table_[h] };
+        table_[h] = static_cast<std::uint16_t>(here + 1);
+        if (own > dictSize and own <= here)
+        {
+            length = matchLength(payload + own - 1 - dictSize, payload + i, size - i);
+            from = own - 1;
+        }
+        if (nullptr != dict)
+        {
+            const std::size_t d { config_.dictionary->table()[h] };
+            if (0 != d)
+            {
+                const auto n { matchLength(dict + d - 1, payload + i, std::min(dictSize - d + 1, size - i)) };
+                if (n > length)
+                {
+                    length = n;
+                    from = d - 1;
+                }
+            }
+        }
+
+        if (length < MIN_MATCH)
+        {
+            ++i;
+            continue;
+        }
+
+        sequence(w, payload + anchor, i - anchor, here - from, length);
+        if (0 == w.size()) return 0;
+
+        // positions inside the match go to the table as well, payloads are short
+        for (std::size_t p = i + 1; p < i + length and p + MIN_MATCH <= size; ++p)
+            table_[hash(payload + p)] = static_cast<std::uint16_t>(dictSize + p + 1);
+        i += length;
+        anchor = i;
+    }
+
+    sequence(w, payload + anchor, size - anchor, 0, 0);
+    return w.size();
+}
+
+std::size_t network::compression::decompress(CompressConfig const& config, const std::uint8_t* in, std::size_t size,
+                                             std::uint8_t* slot, std::size_t capacity) noexcept
+{
+    if (ECompressMode::NONE == config.mode) return 0;
+
+    const byte* dict { nullptr != config.dictionary ? config.dictionary->data() : nullptr };
+    const std::size_t dictSize { nullptr != dict ? config.dictionary->size() : 0 };
+
+    Reader r { in, size };
+    std::size_t raw { 0 };
+    for (std::size_t shift = 0; shift < 21; shift += 7)
+    {
+        const byte b { r.get() };
+        raw |= std::size_t(b & 0x7f) << shift;
+        if (0 == (b & 0x80)) break;
+    }
+    if (r.failed() or 0 == raw or raw > capacity or raw > MAX_MESSAGE) return 0;
+
+    std::size_t pos { 0 };
+    while (true)
+    {
+        const byte token { r.get() };
+        const std::size_t count { r.length(token >> 4) };
+        const byte* literals { r.take(count) };
+        if (r.failed() or count > raw - pos) return 0;
+        std::memcpy(slot + pos, literals, count);
+        pos += count;
+        if (raw == pos) break;
+
+        const std::size_t offset { r.get() | (std::size_t(r.get()) << 8) };
+        const std::size_t length { r.length(token & 0x0f) + MIN_MATCH };
+        if (r.failed() or 0 == offset or offset > pos + dictSize or length > raw - pos) return 0;
+
+        // from the dictionary tail first when the offset goes past the output start
+        std::size_t n { length };
+        if (offset > pos)
+        {
+            const auto part { std::min(n, offset - pos) };
+            std::memcpy(slot + pos, dict + dictSize - (offset - pos), part);
+            pos += part;
+            n -= part;
+        }
+        if (0 == n) continue;
+
+        const byte* from { slot + pos - offset };
+        if (offset >= n)
+            std::memcpy(slot + pos, from, n);
+        else
+            for (std::size_t k = 0; k < n; ++k) slot[pos + k] = from[k];   // overlapping run
+        pos += n;
+    }
+    return r.done() ? raw : 0;
+}
@@ -0,0 +1,109 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include <boost/noncopyable.hpp>
+
+namespace network::compression
+{
+    enum class ECompressMode : std::uint8_t
+    {
+        NONE = 0,       // payloads go as is
+        LZ              // LZ with the channel dictionary
+    };
+
+    constexpr std::size_t MAX_DICTIONARY    { 8 * 1024 };
+    constexpr std::size_t MAX_MESSAGE       { 16 * 1024 };  // the largest multi block message fits
+    constexpr std::size_t MIN_MATCH         { 4 };
+    constexpr std::size_t HASH_BITS         { 12 };
+
+    // offsets are 16 bits over the dictionary and the message
+    static_assert(MAX_DICTIONARY + MAX_MESSAGE <= 0xffff);
+
+    using HashTable = std::array<std::uint16_t, std::size_t(1) << HASH_BITS>;
+
+    /* ---------------- Compressed payload ----------------
+     *
+     * raw size         varint, 7 bits per byte, low first
+     * sequences        [token][literals][offset][match]...
+     *   token          literal count (high 4 bits) and
+     *                  match length - MIN_MATCH (low 4),
+     *                  15 is continued by bytes adding up
+     *                  to 255 each until a smaller one
+     *   offset         2 bytes little endian, distance
+     *                  back from the output position; past
+     *                  the output start it goes on into
+     *                  the end of the dictionary
+     * The last sequence has literals only and ends at the
+     * raw size.
+     *
+     * Small packets have too little history of their own,
+     * so matches come mostly from a static dictionary of
+     * the channel trained on captured traffic (see
+     * sandbox/dictionary_trainer): the dictionary works as
+     * output already produced before the payload. Both
+     * ends of a channel must use the same dictionary.
+     * ---------------------------------------------------- */
+
+    /*
+     * Статический словарь канала: байты словаря и хеш-таблица их позиций
+     * (строится один раз). Длиннее MAX_DICTIONARY - остается хвост, тренер
+     * кладет самые полезные куски в конец.
+     */
+    class Dictionary : boost::noncopyable
+    {
+    private:
+        std::array<std::uint8_t, MAX_DICTIONARY>    bytes_;
+        HashTable                                   table_  {};     // position + 1, 0 - none
+        std::size_t                                 size_   { 0 };
+
+    public:
+        Dictionary() noexcept = default;
+        Dictionary(const std::uint8_t* data, std::size_t size) noexcept;
+
+        [[nodiscard]] const std::uint8_t* data() const noexcept { return bytes_.data(); }
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+        [[nodiscard]] HashTable const& table() const noexcept { return table_; }
+
+    };  // Dictionary
+
+    /*
+     * Настройка сжатия канала. Сжатое сообщение отправляется с флагом
+     * Header::compress (у всех блоков многоблочного сообщения, сжимается
+     * сообщение целиком); несжимаемое и короткое - как есть.
+     */
+    struct CompressConfig
+    {
+        ECompressMode       mode        { ECompressMode::NONE };
+        Dictionary const*   dictionary  { nullptr };    // nullptr - history of the payload only
+        std::size_t         minSize     { 16 };         // shorter payloads go as is
+    };
+
+    /*
+     * Сжатие на отправке, без выделения памяти: хеш-таблица позиций
+     * сообщения не очищается между вызовами, устаревшие позиции
+     * отсекаются проверкой совпадения байт.
+     */
+    class Compressor : boost::noncopyable
+    {
+    private:
+        CompressConfig  config_;
+        HashTable       table_  {};     // position in the window + 1, 0 - none
+
+    public:
+        explicit Compressor(CompressConfig config) noexcept;
+
+        // Сжать payload в out (capacity байт): размер сжатого, 0 - отправить как есть (без флага compress)
+        std::size_t compress(const std::uint8_t* payload, std::size_t size, std::uint8_t* out, std::size_t capacity) noexcept;
+
+        [[nodiscard]] CompressConfig const& config() const noexcept { return config_; }
+
+    };  // Compressor
+
+    // Распаковать сжатое сообщение прямо в slot (capacity байт): размер, 0 - поток поврежден или не помещается
+    std::size_t decompress(CompressConfig const& config, const std::uint8_t* in, std::size_t size,
+                           std::uint8_t* slot, std::size_t capacity) noexcept;
+
+}   // network::compression
@@ -0,0 +1,603 @@
+#include "chacha20_poly1305.h"
+
+#include <cstring>
+#include <algorithm>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define HERMES_X86 1
+#endif
+
+using namespace crypto;
+
+namespace
+{
+    using byte = std::uint8_t;
+
+    inline std::uint32_t load32(const byte* p) noexcept
+    {
+        return p[0] | (std::uint32_t(p[1]) << 8) | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+    }
+
+    inline void store32(byte* p, std::uint32_t v) noexcept
+    {
+        p[0] = static_cast<byte>(v);
+        p[1] = static_cast<byte>(v >> 8);
+        p[2] = static_cast<byte>(v >> 16);
+        p[3] = static_cast<byte>(v >> 24);
+    }
+
+    inline std::uint64_t load64(const byte* p) noexcept
+    {
+        return load32(p) | (std::uint64_t(load32(p + 4)) << 32);
+    }
+
+    inline void store64(byte* p, std::uint64_t v) noexcept
+    {
+        store32(p, static_cast<std::uint32_t>(v));
+        store32(p + 4, static_cast<std::uint32_t>(v >> 32));
+    }
+
+    // ----------------------------- scalar -----------------------------
+
+    constexpr std::uint32_t rotl(std::uint32_t v, int n) noexcept { return (v << n) | (v >> (32 - n)); }
+
+    inline void quarter(BlockInput& x, int a, int b, int c, int d) noexcept
+    {
+        x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 16);
+        x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 12);
+        x[a] += x[b]; x[d] = rotl(x[d] ^ x[a], 8);
+        x[c] += x[d]; x[b] = rotl(x[b] ^ x[c], 7);
+    }
+
+    void scalarBlocks(const BlockInput* in, std::size_t n, byte* out) noexcept
+    {
+        for (std::size_t i = 0; i < n; ++i, out += BLOCK_SIZE)
+        {
+            BlockInput x { in[i] };
+            for (int round = 0; round < 10; ++round)
+            {
+                quarter(x, 0, 4,  8, 12);
+                quarter(x, 1, 5,  9, 13);
+                quarter(x, 2, 6, 10, 14);
+                quarter(x, 3, 7, 11, 15);
+                quarter(x, 0, 5, 10, 15);
+                quarter(x, 1, 6, 11, 12);
+                quarter(x, 2, 7,  8, 13);
+                quarter(x, 3, 4,  9, 14);
+            }
+            for (std::size_t w = 0; w < 16; ++w)
+                store32(out + w * 4, x[w] + in[i][w]);
+        }
+    }
+
+    void scalarMac(const MacInput* in, std::size_t n) noexcept
+    {
+        for (std::size_t i = 0; i < n; ++i)
+            poly1305Aead(in[i].key, in[i].aad, in[i].aadSize, in[i].text, in[i].textSize, in[i].tag);
+    }
+
+    constexpr Kernels SCALAR_KERNELS { scalarBlocks, scalarMac, 1, "scalar" };
+
+#ifdef HERMES_X86
+
+    // ------------------------------ AVX2 ------------------------------
+
+#define HERMES_AVX2 __attribute__((target("avx2")))
+
+    // word w of 8 blocks in the lanes of v[w]
+    struct Sliced
+    {
+        __m256i v[16];
+    };
+
+    template <int N>
+    HERMES_AVX2 inline __m256i rotl8x(__m256i v) noexcept
+    {
+        // rotations by whole bytes are byte shuffles
+        if constexpr (16 == N)
+            return _mm256_shuffle_epi8(v, _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13,
+                                                           2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13));
+        else if constexpr (8 == N)
+            return _mm256_shuffle_epi8(v, _mm256_setr_epi8(3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14,
+                                                           3, 0, 1, 2, 7, 4, 5, 6, 11, 8, 9, 10, 15, 12, 13, 14));
+        else
+            return _mm256_or_si256(_mm256_slli_epi32(v, N), _mm256_srli_epi32(v, 32 - N));
+    }
+
+    HERMES_AVX2 inline void quarter8x(Sliced& x, int a, int b, int c, int d) noexcept
+    {
+        x.v[a] = _mm256_add_epi32(x.v[a], x.v[b]); x.v[d] = rotl8x<16>(_mm256_xor_si256(x.v[d], x.v[a]));
+        x.v[c] = _mm256_add_epi32(x.v[c], x.v[d]); x.v[b] = rotl8x<12>(_mm256_xor_si256(x.v[b], x.v[c]));
+        x.v[a] = _mm256_add_epi32(x.v[a], x.v[b]); x.v[d] = rotl8x<8>(_mm256_xor_si256(x.v[d], x.v[a]));
+        x.v[c] = _mm256_add_epi32(x.v[c], x.v[d]); x.v[b] = rotl8x<7>(_mm256_xor_si256(x.v[b], x.v[c]));
+    }
+
+    // 8x8 transpose of 32-bit words, r[i] lane j <-> r[j] lane i
+    HERMES_AVX2 inline void transpose8x8(__m256i* r) noexcept
+    {
+        const __m256i t0 { _mm256_unpacklo_epi32(r[0], r[1]) }, t1 { _mm256_unpackhi_epi32(r[0], r[1]) };
+        const __m256i t2 { _mm256_unpacklo_epi32(r[2], r[3]) }, t3 { _mm256_unpackhi_epi32(r[2], r[3]) };
+        const __m256i t4 { _mm256_unpacklo_epi32(r[4], r[5]) }, t5 { _mm256_unpackhi_epi32(r[4], r[5]) };
+        const __m256i t6 { _mm256_unpacklo_epi32(r[6], r[7]) }, t7 { _mm256_unpackhi_epi32(r[6], r[7]) };
+
+        const __m256i u0 { _mm256_unpacklo_epi64(t0, t2) }, u1 { _mm256_unpackhi_epi64(t0, t2) };
+        const __m256i u2 { _mm256_unpacklo_epi64(t1, t3) }, u3 { _mm256_unpackhi_epi64(t1, t3) };
+        const __m256i u4 { _mm256_unpacklo_epi64(t4, t6) }, u5 { _mm256_unpackhi_epi64(t4, t6) };
+        const __m256i u6 { _mm256_unpacklo_epi64(t5, t7) }, u7 { _mm256_unpackhi_epi64(t5, t7) };
+
+        r[0] = _mm256_permute2x128_si256(u0, u4, 0x20);
+        r[1] = _mm256_permute2x128_si256(u1, u5, 0x20);
+        r[2] = _mm256_permute2x128_si256(u2, u6, 0x20);
+        r[3] = _mm256_permute2x128_si256(u3, u7, 0x20);
+        r[4] = _mm256_permute2x128_si256(u0, u4, 0x31);
+        r[5] = _mm256_permute2x128_si256(u1, u5, 0x31);
+        r[6] = _mm256_permute2x128_si256(u2, u6, 0x31);
+        r[7] = _mm256_permute2x128_si256(u3, u7, 0x31);
+    }
+
+    // exactly 8 blocks
+    HERMES_AVX2 void avx2Blocks8(const BlockInput* in, byte* out) noexcept
+    {
+        // inputs are rows, transposed to one word of all blocks per register
+        Sliced input;
+        for (int half = 0; half < 2; ++half)
+        {
+            __m256i* r { input.v + half * 8 };
+            for (int j = 0; j < 8; ++j)
+                r[j] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(in[j].data() + half * 8));
+            transpose8x8(r);
+        }
+
+        Sliced x { input };
+        for (int round = 0; round < 10; ++round)
+        {
+            quarter8x(x, 0, 4,  8, 12);
+            quarter8x(x, 1, 5,  9, 13);
+            quarter8x(x, 2, 6, 10, 14);
+            quarter8x(x, 3, 7, 11, 15);
+            quarter8x(x, 0, 5, 10, 15);
+            quarter8x(x, 1, 6, 11, 12);
+            quarter8x(x, 2, 7,  8, 13);
+            quarter8x(x, 3, 4,  9, 14);
+        }
+
+        for (int w = 0; w < 16; ++w)
+            x.v[w] = _mm256_add_epi32(x.v[w], input.v[w]);
+
+        // back to rows: words 0..7 and 8..15 of block j
+        for (int half = 0; half < 2; ++half)
+        {
+            __m256i* r { x.v + half * 8 };
+            transpose8x8(r);
+            for (int j = 0; j < 8; ++j)
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(out + j * BLOCK_SIZE + half * 32), r[j]);
+        }
+    }
+
+    HERMES_AVX2 void avx2Blocks(const BlockInput* in, std::size_t n, byte* out) noexcept
+    {
+        for (; n >= 8; n -= 8, in += 8, out += 8 * BLOCK_SIZE)
+            avx2Blocks8(in, out);
+        if (0 == n) return;
+
+        // short tail padded with its last input
+        BlockInput padded[8];
+        alignas(32) byte stream[8 * BLOCK_SIZE];
+        for (std::size_t j = 0; j < 8; ++j)
+            padded[j] = in[std::min(j, n - 1)];
+        avx2Blocks8(padded, stream);
+        std::memcpy(out, stream, n * BLOCK_SIZE);
+    }
+
+    constexpr std::uint32_t MASK26 { (std::uint32_t(1) << 26) - 1 };
+
+    // 16 byte blocks of the AEAD Poly1305 input: aad and text zero padded, then the lengths
+    class MacBlocks
+    {
+    private:
+        const MacInput* in_;
+
+        static std::size_t blocks(std::size_t size) noexcept { return (size + 15) / 16; }
+
+        static void words(const byte* from, std::size_t size, std::size_t k, std::uint64_t& lo, std::uint64_t& hi) noexcept
+        {
+            from += k * 16;
+            size -= k * 16;
+            if (size >= 16)
+            {
+                lo = load64(from);
+                hi = load64(from + 8);
+                return;
+            }
+
+            byte last[16] {};
+            std::memcpy(last, from, size);
+            lo = load64(last);
+            hi = load64(last + 8);
+        }
+
+    public:
+        explicit MacBlocks(const MacInput* in) noexcept : in_ { in } {}
+
+        [[nodiscard]] std::size_t count() const noexcept { return blocks(in_->aadSize) + blocks(in_->textSize) + 1; }
+
+        // block k as two little endian words
+        void block(std::size_t k, std::uint64_t& lo, std::uint64_t& hi) const noexcept
+        {
+            if (k < blocks(in_->aadSize)) return words(in_->aad, in_->aadSize, k, lo, hi);
+            k -= blocks(in_->aadSize);
+            if (k < blocks(in_->textSize)) return words(in_->text, in_->textSize, k, lo, hi);
+
+            lo = in_->aadSize;
+            hi = in_->textSize;
+        }
+    };
+
+    // h + s mod 2^128 of a lane in 26-bit limbs (poly1305-donna-32)
+    void finish26(std::uint32_t h0, std::uint32_t h1, std::uint32_t h2, std::uint32_t h3, std::uint32_t h4,
+                  const byte* pad, byte* tag) noexcept
+    {
+        std::uint32_t c { h1 >> 26 };
+        h1 &= MASK26;
+        h2 += c; c = h2 >> 26; h2 &= MASK26;
+        h3 += c; c = h3 >> 26; h3 &= MASK26;
+        h4 += c; c = h4 >> 26; h4 &= MASK26;
+        h0 += c * 5; c = h0 >> 26; h0 &= MASK26;
+        h1 += c;
+
+        // h - p, taken when it does not borrow
+        std::uint32_t g0 { h0 + 5 }; c = g0 >> 26; g0 &= MASK26;
+        std::uint32_t g1 { h1 + c }; c = g1 >> 26; g1 &= MASK26;
+        std::uint32_t g2 { h2 + c }; c = g2 >> 26; g2 &= MASK26;
+        std::uint32_t g3 { h3 + c }; c = g3 >> 26; g3 &= MASK26;
+        std::uint32_t g4 { h4 + c - (std::uint32_t(1) << 26) };
+
+        c = (g4 >> 31) - 1;
+        h0 = (h0 & ~c) | (g0 & c);
+        h1 = (h1 & ~c) | (g1 & c);
+        h2 = (h2 & ~c) | (g2 & c);
+        h3 = (h3 & ~c) | (g3 & c);
+        h4 = (h4 & ~c) | (g4 & c);
+
+        const std::uint32_t w[4] { h0 | (h1 << 26), (h1 >> 6) | (h2 << 20), (h2 >> 12) | (h3 << 14), (h3 >> 18) | (h4 << 8) };
+        std::uint64_t f { 0 };
+        for (std::size_t i = 0; i < 4; ++i)
+        {
+            f = std::uint64_t(w[i]) + load32(pad + i * 4) + (f >> 32);
+            store32(tag + i * 4, static_cast<std::uint32_t>(f));
+        }
+    }
+
+    HERMES_AVX2 inline __m256i mul(__m256i a, __m256i b) noexcept { return _mm256_mul_epu32(a, b); }
+
+    // up to 4 tags, message j in the 64-bit lanes j of the limb registers
+    HERMES_AVX2 void avx2Mac4(const MacInput* in, std::size_t n) noexcept
+    {
+        const __m256i mask { _mm256_set1_epi64x(MASK26) };
+
+        // lanes past n repeat the last input, their tags are dropped
+        const MacBlocks lanes[4] { MacBlocks { in }, MacBlocks { in + std::min<std::size_t>(1, n - 1) },
+                                   MacBlocks { in + std::min<std::size_t>(2, n - 1) }, MacBlocks { in + std::min<std::size_t>(3, n - 1) } };
+
+        // clamped r and 5 * r
+        alignas(32) std::uint64_t limbs[5][4];
+        std::size_t steps { 0 };
+        for (std::size_t j = 0; j < 4; ++j)
+        {
+            const byte* key { in[std::min(j, n - 1)].key };
+            limbs[0][j] = load32(key) & 0x3ffffff;
+            limbs[1][j] = (load32(key + 3) >> 2) & 0x3ffff03;
+            limbs[2][j] = (load32(key + 6) >> 4) & 0x3ffc0ff;
+            limbs[3][j] = (load32(key + 9) >> 6) & 0x3f03fff;
+            limbs[4][j] = (load32(key + 12) >> 8) & 0x00fffff;
+            steps = std::max(steps, lanes[j].count());
+        }
+        __m256i r[5], s[5], h[5];
+        for (std::size_t i = 0; i < 5; ++i)
+        {
+            r[i] = _mm256_load_si256(reinterpret_cast<const __m256i*>(limbs[i]));
+            s[i] = _mm256_add_epi64(r[i], _mm256_slli_epi64(r[i], 2));
+            h[i] = _mm256_setzero_si256();
+        }
+
+        for (std::size_t step = 0; step < steps; ++step)
+        {
+            // shorter messages start late, zero blocks without the high bit keep h zero
+            alignas(32) std::uint64_t lo[4], hi[4], top[4];
+            for (std::size_t j = 0; j < 4; ++j)
+            {
+                const auto late { steps - lanes[j].count() };
+                lo[j] = hi[j] = top[j] = 0;
+                if (step < late) continue;
+                lanes[j].block(step - late, lo[j], hi[j]);
+                top[j] = std::uint64_t(1) << 24;
+            }
+            const __m256i l { _mm256_load_si256(reinterpret_cast<const __m256i*>(lo)) };
+            const __m256i u { _mm256_load_si256(reinterpret_cast<const __m256i*>(hi)) };
+
+            h[0] = _mm256_add_epi64(h[0], _mm256_and_si256(l, mask));
+            h[1] = _mm256_add_epi64(h[1], _mm256_and_si256(_mm256_srli_epi64(l, 26), mask));
+            h[2] = _mm256_add_epi64(h[2], _mm256_and_si256(_mm256_or_si256(_mm256_srli_epi64(l, 52), _mm256_slli_epi64(u, 12)), mask));
+            h[3] = _mm256_add_epi64(h[3], _mm256_and_si256(_mm256_srli_epi64(u, 14), mask));
+            h[4] = _mm256_add_epi64(h[4], _mm256_or_si256(_mm256_srli_epi64(u, 40),
+                                                          _mm256_load_si256(reinterpret_cast<const __m256i*>(top))));
+
+            __m256i d[5];
+            d[0] = _mm256_add_epi64(_mm256_add_epi64(mul(h[0], r[0]), mul(h[1], s[4])),
+                                    _mm256_add_epi64(_mm256_add_epi64(mul(h[2], s[3]), mul(h[3], s[2])), mul(h[4], s[1])));
+            d[1] = _mm256_add_epi64(_mm256_add_epi64(mul(h[0], r[1]), mul(h[1], r[0])),
+                                    _mm256_add_epi64(_mm256_add_epi64(mul(h[2], s[4]), mul(h[3], s[3])), mul(h[4], s[2])));
+            d[2] = _mm256_add_epi64(_mm256_add_epi64(mul(h[0], r[2]), mul(h[1], r[1])),
+                                    _mm256_add_epi64(_mm256_add_epi64(mul(h[2], r[0]), mul(h[3], s[4])), mul(h[4], s[3])));
+            d[3] = _mm256_add_epi64(_mm256_add_epi64(mul(h[0], r[3]), mul(h[1], r[2])),
+                                    _mm256_add_epi64(_mm256_add_epi64(mul(h[2], r[1]), mul(h[3], r[0])), mul(h[4], s[4])));
+            d[4] = _mm256_add_epi64(_mm256_add_epi64(mul(h[0], r[4]), mul(h[1], r[3])),
+                                    _mm256_add_epi64(_mm256_add_epi64(mul(h[2], r[2]), mul(h[3], r[1])), mul(h[4], r[0])));
+
+            __m256i c { _mm256_srli_epi64(d[0], 26) };
+            h[0] = _mm256_and_si256(d[0], mask);
+            for (std::size_t i = 1; i < 5; ++i)
+            {
+                d[i] = _mm256_add_epi64(d[i], c);
+                c = _mm256_srli_epi64(d[i], 26);
+                h[i] = _mm256_and_si256(d[i], mask);
+            }
+            h[0] = _mm256_add_epi64(h[0], _mm256_add_epi64(c, _mm256_slli_epi64(c, 2)));
+            c = _mm256_srli_epi64(h[0], 26);
+            h[0] = _mm256_and_si256(h[0], mask);
+            h[1] = _mm256_add_epi64(h[1], c);
+        }
+
+        for (std::size_t i = 0; i < 5; ++i)
+            _mm256_store_si256(reinterpret_cast<__m256i*>(limbs[i]), h[i]);
+        for (std::size_t j = 0; j < n; ++j)
+            finish26(static_cast<std::uint32_t>(limbs[0][j]), static_cast<std::uint32_t>(limbs[1][j]), static_cast<std::uint32_t>(limbs[2][j]),
+                     static_cast<std::uint32_t>(limbs[3][j]), static_cast<std::uint32_t>(limbs[4][j]), in[j].key + 16, in[j].tag);
+    }
+
+    HERMES_AVX2 void avx2Mac(const MacInput* in, std::size_t n) noexcept
+    {
+        for (; n > 0; in += std::min<std::size_t>(4, n), n -= std::min<std::size_t>(4, n))
+            avx2Mac4(in, std::min<std::size_t>(4, n));
+    }
+
+#undef HERMES_AVX2
+
+    constexpr Kernels AVX2_KERNELS { avx2Blocks, avx2Mac, 8, "avx2" };
+
+#endif  // HERMES_X86
+
+    const Kernels* selectKernels() noexcept
+    {
+#ifdef HERMES_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return &AVX2_KERNELS;
+#endif
+        return &SCALAR_KERNELS;
+    }
+
+    // ---------------------------- Poly1305 -----------------------------
+
+    // 130-bit accumulator in 44 + 44 + 42 bit limbs (poly1305-donna-64)
+    class Poly1305
+    {
+    private:
+        static constexpr std::uint64_t MASK44 { (std::uint64_t(1) << 44) - 1 };
+        static constexpr std::uint64_t MASK42 { (std::uint64_t(1) << 42) - 1 };
+
+        __extension__ typedef unsigned __int128 wide;
+
+        std::uint64_t r0_, r1_, r2_;
+        std::uint64_t s1_, s2_;
+        std::uint64_t h0_ { 0 }, h1_ { 0 }, h2_ { 0 };
+        std::uint64_t pad0_, pad1_;
+
+    public:
+        explicit Poly1305(const byte* key) noexcept
+        {
+            const auto t0 { load64(key) };
+            const auto t1 { load64(key + 8) };
+
+            // clamped r
+            r0_ = t0 & 0xffc0fffffff;
+            r1_ = ((t0 >> 44) | (t1 << 20)) & 0xfffffc0ffff;
+            r2_ = (t1 >> 24) & 0x00ffffffc0f;
+            s1_ = r1_ * (5 << 2);
+            s2_ = r2_ * (5 << 2);
+
+            pad0_ = load64(key + 16);
+            pad1_ = load64(key + 24);
+        }
+
+        // full 16 byte blocks
+        void blocks(const byte* m, std::size_t n) noexcept
+        {
+            constexpr std::uint64_t HIBIT { std::uint64_t(1) << 40 };
+
+            auto h0 { h0_ }, h1 { h1_ }, h2 { h2_ };
+            for (; n >= 16; n -= 16, m += 16)
+            {
+                const auto t0 { load64(m) };
+                const auto t1 { load64(m + 8) };
+
+                h0 += t0 & MASK44;
+                h1 += ((t0 >> 44) | (t1 << 20)) & MASK44;
+                h2 += ((t1 >> 24) & MASK42) | HIBIT;
+
+                wide d0 { wide(h0) * r0_ + wide(h1) * s2_ + wide(h2) * s1_ };
+                wide d1 { wide(h0) * r1_ + wide(h1) * r0_ + wide(h2) * s2_ };
+                wide d2 { wide(h0) * r2_ + wide(h1) * r1_ + wide(h2) * r0_ };
+
+                std::uint64_t c { static_cast<std::uint64_t>(d0 >> 44) };
+                h0 = static_cast<std::uint64_t>(d0) & MASK44;
+                d1 += c;
+                c = static_cast<std::uint64_t>(d1 >> 44);
+                h1 = static_cast<std::uint64_t>(d1) & MASK44;
+                d2 += c;
+                c = static_cast<std::uint64_t>(d2 >> 42);
+                h2 = static_cast<std::uint64_t>(d2) & MASK42;
+                h0 += c * 5;
+                c = h0 >> 44;
+                h0 &= MASK44;
+                h1 += c;
+            }
+            h0_ = h0;
+            h1_ = h1;
+            h2_ = h2;
+        }
+
+        // zero padded to a block
+        void padded(const byte* m, std::size_t n) noexcept
+        {
+            const auto full { n & ~std::size_t(15) };
+            blocks(m, full);
+            if (full == n) return;
+
+            byte last[16] {};
+            std::memcpy(last, m + full, n - full);
+            blocks(last, 16);
+        }
+
+        void finish(byte* tag) noexcept
+        {
+            auto h0 { h0_ }, h1 { h1_ }, h2 { h2_ };
+
+            // full carry
+            std::uint64_t c { h1 >> 44 };
+            h1 &= MASK44;
+            h2 += c; c = h2 >> 42; h2 &= MASK42;
+            h0 += c * 5; c = h0 >> 44; h0 &= MASK44;
+            h1 += c; c = h1 >> 44; h1 &= MASK44;
+            h2 += c; c = h2 >> 42; h2 &= MASK42;
+            h0 += c * 5; c = h0 >> 44; h0 &= MASK44;
+            h1 += c;
+
+            // h - p, taken when it does not borrow
+            std::uint64_t g0 { h0 + 5 }; c = g0 >> 44; g0 &= MASK44;
+            std::uint64_t g1 { h1 + c }; c = g1 >> 44; g1 &= MASK44;
+            std::uint64_t g2 { h2 + c - (std::uint64_t(1) << 42) };
+
+            c = (g2 >> 63) - 1;
+            h0 = (h0 & ~c) | (g0 & c);
+            h1 = (h1 & ~c) | (g1 & c);
+            h2 = (h2 & ~c) | (g2 & c);
+
+            // + s mod 2^128
+            h0 += pad0_ & MASK44; c = h0 >> 44; h0 &= MASK44;
+            h1 += (((pad0_ >> 44) | (pad1_ << 20)) & MASK44) + c; c = h1 >> 44; h1 &= MASK44;
+            h2 += ((pad1_ >> 24) & MASK42) + c; h2 &= MASK42;
+
+            store64(tag, h0 | (h1 << 44));
+            store64(tag + 8, (h1 >> 20) | (h2 << 24));
+        }
+    };
+
+    // keystream blocks of counters first.. xored over data
+    void xorStream(BlockInput input, std::uint32_t first, byte* data, std::size_t size) noexcept
+    {
+        constexpr std::size_t GROUP { 8 };
+
+        BlockInput inputs[GROUP];
+        byte stream[GROUP * BLOCK_SIZE];
+        for (std::uint32_t counter { first }; 0 != size; )
+        {
+            const auto count { std::min(GROUP, (size + BLOCK_SIZE - 1) / BLOCK_SIZE) };
+            for (std::size_t j = 0; j < count; ++j, ++counter)
+            {
+                inputs[j] = input;
+                inputs[j][12] = counter;
+            }
+            active->blocks(inputs, count, stream);
+
+            const auto bytes { std::min(size, count * BLOCK_SIZE) };
+            for (std::size_t i = 0; i < bytes; ++i)
+                data[i] ^= stream[i];
+            data += bytes;
+            size -= bytes;
+        }
+    }
+}
+
+// constant initialized, upgraded by CPU dispatch during static initialization
+const Kernels* crypto::active { &SCALAR_KERNELS };
+
+namespace
+{
+    struct Dispatch
+    {
+        Dispatch() noexcept { crypto::active = selectKernels(); }
+    } dispatch;
+}
+
+const Kernels* crypto::find(const char* name) noexcept
+{
+    if (0 == std::strcmp(name, "scalar")) return &SCALAR_KERNELS;
+#ifdef HERMES_X86
+    __builtin_cpu_init();
+    if (0 == std::strcmp(name, "avx2") and __builtin_cpu_supports("avx2")) return &AVX2_KERNELS;
+#endif
+    return nullptr;
+}
+
+BlockInput crypto::blockInput(std::uint8_t const* key, std::uint32_t counter, std::uint8_t const* nonce) noexcept
+{
+    // "expand 32-byte k"
+    BlockInput in { 0x61707865, 0x3320646e, 0x79622d32, 0x6b206574 };
+    for (std::size_t w = 0; w < 8; ++w)
+        in[4 + w] = load32(key + w * 4);
+    in[12] = counter;
+    for (std::size_t w = 0; w < 3; ++w)
+        in[13 + w] = load32(nonce + w * 4);
+    return in;
+}
+
+void crypto::poly1305Aead(std::uint8_t const* oneTimeKey, std::uint8_t const* aad, std::size_t aadSize,
+                          std::uint8_t const* text, std::size_t textSize, std::uint8_t* tag) noexcept
+{
+    byte lengths[16];
+    store64(lengths, aadSize);
+    store64(lengths + 8, textSize);
+
+    Poly1305 mac { oneTimeKey };
+    mac.padded(aad, aadSize);
+    mac.padded(text, textSize);
+    mac.blocks(lengths, sizeof(lengths));
+    mac.finish(tag);
+}
+
+void crypto::seal(Key const& key, Nonce const& nonce, std::uint8_t const* aad, std::size_t aadSize,
+                  std::uint8_t* data, std::size_t size, std::uint8_t* tag) noexcept
+{
+    const auto input { blockInput(key.data(), 0, nonce.data()) };
+
+    byte oneTimeKey[BLOCK_SIZE];
+    active->blocks(&input, 1, oneTimeKey);
+
+    xorStream(input, 1, data, size);
+    poly1305Aead(oneTimeKey, aad, aadSize, data, size, tag);
+}
+
+bool crypto::open(Key const& key, Nonce const& nonce, std::uint8_t const* aad, std::size_t aadSize,
+                  std::uint8_t* data, std::size_t size, std::uint8_t const* tag) noexcept
+{
+    const auto input { blockInput(key.data(), 0, nonce.data()) };
+
+    byte oneTimeKey[BLOCK_SIZE];
+    active->blocks(&input, 1, oneTimeKey);
+
+    Tag expected;
+    poly1305Aead(oneTimeKey, aad, aadSize, data, size, expected.data());
+    if (not equal(expected.data(), tag, TAG_SIZE)) return false;
+
+    xorStream(input, 1, data, size);
+    return true;
+}
+
+bool crypto::equal(std::uint8_t const* a, std::uint8_t const* b, std::size_t n) noexcept
+{
+    byte diff { 0 };
+    for (std::size_t i = 0; i < n; ++i)
+        diff |= a[i] ^ b[i];
+    return 0 == diff;
+}
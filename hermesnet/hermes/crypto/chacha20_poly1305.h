@@ -0,0 +1,80 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace crypto
+{
+    /*
+     * ChaCha20-Poly1305 AEAD (RFC 8439). The ChaCha20 block function
+     * has a scalar kernel and an AVX2 one computing 8 blocks at once,
+     * word sliced across the lanes; blocks of a call may use different
+     * keys and nonces, so one call serves a batch of datagrams of many
+     * sessions. Poly1305 of a batch likewise: scalar with 64-bit limbs
+     * or 4 messages in the AVX2 lanes with 26-bit limbs, shorter ones
+     * are aligned to the end by leading blocks that keep the
+     * accumulator zero. The kernels are chosen once at startup by
+     * CPUID, see chacha20_poly1305.cpp.
+     */
+
+    static constexpr std::size_t KEY_SIZE   { 32 };
+    static constexpr std::size_t NONCE_SIZE { 12 };
+    static constexpr std::size_t TAG_SIZE   { 16 };
+    static constexpr std::size_t BLOCK_SIZE { 64 };     // chacha20 keystream block
+
+    using Key   = std::array<std::uint8_t, KEY_SIZE>;
+    using Nonce = std::array<std::uint8_t, NONCE_SIZE>;
+    using Tag   = std::array<std::uint8_t, TAG_SIZE>;
+
+    // ChaCha20 input: constants, key, block counter, nonce (host order words)
+    using BlockInput = std::array<std::uint32_t, 16>;
+
+    // Poly1305 input of the AEAD construction, see poly1305Aead
+    struct MacInput
+    {
+        std::uint8_t const* key;        // one time key, 32 bytes
+        std::uint8_t const* aad;
+        std::size_t         aadSize;
+        std::uint8_t const* text;
+        std::size_t         textSize;
+        std::uint8_t*       tag;        // TAG_SIZE bytes
+    };
+
+    struct Kernels
+    {
+        // n keystream blocks (BLOCK_SIZE bytes each) of n inputs
+        using BlocksFn = void (*)(const BlockInput* in, std::size_t n, std::uint8_t* out) noexcept;
+        // tags of n inputs
+        using MacFn    = void (*)(const MacInput* in, std::size_t n) noexcept;
+
+        BlocksFn    blocks;
+        MacFn       mac;
+        std::size_t width;      // blocks computed at once
+        const char* name;
+    };
+
+    // active kernel set, never null (scalar until CPU dispatch is done)
+    extern const Kernels* active;
+
+    // kernel sets by name: "avx2", "scalar" (nullptr if not supported by CPU)
+    const Kernels* find(const char* name) noexcept;
+
+    // Вход блока ChaCha20 для ключа, номера блока и nonce
+    BlockInput blockInput(std::uint8_t const* key, std::uint32_t counter, std::uint8_t const* nonce) noexcept;
+
+    // Poly1305 of the AEAD construction: aad and text padded to 16 bytes, then their lengths
+    void poly1305Aead(std::uint8_t const* oneTimeKey, std::uint8_t const* aad, std::size_t aadSize,
+                      std::uint8_t const* text, std::size_t textSize, std::uint8_t* tag) noexcept;
+
+    // Зашифровать data на месте, tag - TAG_SIZE байт (RFC 8439, 2.8)
+    void seal(Key const& key, Nonce const& nonce, std::uint8_t const* aad, std::size_t aadSize,
+              std::uint8_t* data, std::size_t size, std::uint8_t* tag) noexcept;
+
+    // Проверить tag и расшифровать data на месте; false - подделка, data не изменены
+    bool open(Key const& key, Nonce const& nonce, std::uint8_t const* aad, std::size_t aadSize,
+              std::uint8_t* data, std::size_t size, std::uint8_t const* tag) noexcept;
+
+    // Constant time comparison of n bytes
+    bool equal(std::uint8_t const* a, std::uint8_t const* b, std::size_t n) noexcept;
+}
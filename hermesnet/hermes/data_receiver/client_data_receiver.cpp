@@ -1,4 +1,120 @@
 
 #include "client_data_receiver.h"
 
-/* just for standard .obj compilation */
+#include <chrono>
+#include <iomanip>
+#include <sstream>
+
+#include <hermes/log/log.h>
+#include <hermes/message/batch_validator.h>
+
+using namespace network;
+using namespace network::service;
+using namespace network::types;
+using namespace network::message;
+using namespace network::message::id;
+using namespace utility::logger;
+
+namespace
+{
+#undef  LOG
+#define LOG(text) Logger::getInstance().log(EModule::RECEIVER, (text));
+}
+
+ClientDataReceiver::ClientDataReceiver(net::ip::udp::socket& socket, replication::ClientReplica& replica) noexcept
+    : socket_(socket)
+    , replica_(replica)
+{
+    LOG_REGISTER_MODULE(EModule::RECEIVER)
+}
+
+std::size_t ClientDataReceiver::process()
+{
+    const auto flags {0};
+    std::size_t datagrams {0};
+    boost::system::error_code ec;
+
+    while (isDataReady(socket_))
+    {
+        // the wire image lands in the datagram itself, payload stays in the body
+        auto buf   { boost::asio::buffer(datagram_.wireBuffer(), DATAGRAM_SIZE) };
+        auto bytes { socket_.receive(buf, flags, ec) };
+
+        if (ec.failed()) {
+            std::stringstream ss;
+            ss << "error while reading data from server socket: " << std::quoted(ec.message());
+            LOG(ss.str().c_str())
+            break;
+        }
+
+        // the same checks as on the server, crc32c included when the field is sent
+        ++datagrams;
+        const auto length { static_cast<std::uint32_t>(bytes) };
+        auto valid { validateBatch(datagram_.wireBuffer(), &length, nullptr, 1, rulesFor<ServiceType>(SERVER_ACCESS_CODE, false, sealed_)) };
+        if (sealed_) valid = open(valid);
+
+        if (0 == valid or not datagram_.decodeInPlace()) {
+            ++invalid_;
+            continue;
+        }
+        dispatch();
+    }
+    return datagrams;
+}
+
+void ClientDataReceiver::establishSession(crypto::Key const& receive) noexcept
+{
+    receiveKey_ = receive;
+    received_ = 0;
+    window_ = 0;
+    sealed_ = true;
+}
+
+std::uint64_t ClientDataReceiver::open(std::uint64_t valid) noexcept
+{
+    // plaintext is not opened, so it is dropped as well
+    std::uint64_t sequence { 0 };
+    const auto sealed { valid & sealedImages(datagram_.wireBuffer(), 1) };
+    const auto authentic { openBatch(datagram_.wireBuffer(), 1, sealed, &receiveKey_, nullptr, &received_, &sequence) };
+    valid = acceptBatch(authentic, nullptr, &sequence, &received_, &window_);
+    replayed_ += static_cast<std::uint64_t>(__builtin_popcountll(authentic & ~valid));
+    return valid;
+}
+
+void ClientDataReceiver::dispatch() noexcept
+{
+    auto const& header { datagram_.HeaderRef() };
+    auto const& body { datagram_.BodyRef() };
+
+    switch (header.type.action)
+    {
+        case ServiceType::EServiceAction::SERVICE_ACT_SNAPSHOT:
+        {
+            const auto arrival { replication::ClientReplica::clock::now() };
+            const std::uint8_t* data { body.buf.data() };
+            std::size_t size { body.size };
+            if (not header.isSingleBlock())
+            {
+                if (not assembler_.add(header.uuid, header.block_num, header.block_count, data, size)) break;
+                data = assembler_.data();
+                size = assembler_.size();
+            }
+
+            // the whole message is compressed, blocks carry the flag each
+            if (header.compress)
+            {
+                const auto slot { assembler_.slot() };
+                size = compression::decompress(compression_, data, size, slot, BlockAssembler::MESSAGE_BYTES);
+                if (0 == size) {
+                    ++invalid_;
+                    break;
+                }
+                data = slot;
+            }
+            replica_.receive(data, size, arrival);
+            break;
+        }
+        default:
+            break;
+    }
+}
@@ -5,6 +5,12 @@
 #include "interface/ireceiver.h"
 #include <hermes/common/types.h>
 #include <hermes/common/structures.h>
+#include <hermes/message/datagram.h>
+#include <hermes/message/block_assembler.h>
+#include <hermes/message/datagram_cipher.h>
+#include <hermes/message/service_type_id.h>
+#include <hermes/compression/lz_codec.h>
+#include <hermes/replication/client_replica.h>
 
 #include <boost/noncopyable.hpp>
 #include <boost/asio/ip/udp.hpp>
@@ -16,19 +22,61 @@ namespace network::service
     namespace net = boost::asio;
 #endif
 
+    /*
+     * Прием данных сервера на клиенте. Датаграммы принимаются прямо
+     * в один рабочий слот, снимки мира (обычно из нескольких блоков)
+     * собираются BlockAssembler и применяются к реплике с временем
+     * прихода последнего блока. Сжатые снимки (флаг compress)
+     * распаковываются прямо в слот приема сборщика по настройке
+     * сжатия канала.
+     * После установки ключа сессии принимаются только запечатанные
+     * датаграммы.
+     */
     class ClientDataReceiver final : public IReceiver, boost::noncopyable
     {
+    private:
+        static_assert(message::Datagram<message::id::ServiceType>::checkLayout());
+
+        net::ip::udp::socket&                       socket_;
+        replication::ClientReplica&                 replica_;
+
+        message::Datagram<message::id::ServiceType> datagram_   {};
+        message::BlockAssembler                     assembler_  {};
+        std::uint64_t                               invalid_    { 0 };  // malformed, forged or undecodable
+
+        // snapshot channel compression, decompressed snapshots land in the assembler slot
+        compression::CompressConfig                 compression_ {};
+
+        // sealed session with the server
+        crypto::Key                                 receiveKey_ {};
+        std::uint64_t                               received_   { 0 };  // highest authenticated number
+        std::uint64_t                               window_     { 0 };  // accepted numbers behind it
+        std::uint64_t                               replayed_   { 0 };
+        bool                                        sealed_     { false };
+
     public:
-        ClientDataReceiver() = default;
+        ClientDataReceiver(net::ip::udp::socket& socket, replication::ClientReplica& replica) noexcept;
         virtual ~ClientDataReceiver() = default;
 
         // Обработать входящие сообщения
-        void process() final {};
+        std::size_t process() final;
+
+        // Ключ приема сессии, заданный при рукопожатии (SessionKeys::receive)
+        void establishSession(crypto::Key const& receive) noexcept;
+
+        // Сжатие канала снимков, то же, что у сервера (словарь живет дольше приемника)
+        void setCompression(compression::CompressConfig const& config) noexcept { compression_ = config; }
+
+        [[nodiscard]] std::uint64_t invalid() const noexcept { return invalid_; }
+        [[nodiscard]] std::uint64_t replayed() const noexcept { return replayed_; }
+        [[nodiscard]] std::uint64_t incomplete() const noexcept { return assembler_.dropped(); }
 
     private:
-        inline std::size_t isDataReady(const boost::asio::ip::udp::socket& socket) final {
-            return 0;
-        };
+        inline std::size_t isDataReady(const boost::asio::ip::udp::socket& socket) final;
+        // Проверить и расшифровать запечатанную датаграмму на месте, повтор отбрасывается
+        std::uint64_t open(std::uint64_t valid) noexcept;
+        // Разобрать принятую датаграмму
+        void dispatch() noexcept;
     };
 
 }   // network
@@ -39,3 +87,13 @@ namespace network::service
 // ██   ██ ██      ██      ██ ██  ██ ██ ██    ██    ██ ██    ██ ██  ██ ██
 // ██████  ███████ ██      ██ ██   ████ ██    ██    ██  ██████  ██   ████
 
+
+inline std::size_t network::service::ClientDataReceiver::isDataReady(const boost::asio::ip::udp::socket& socket)
+{
+    boost::system::error_code ec;
+    std::size_t bytes = socket.available(ec);
+    if (!static_cast<bool>(bytes) or ec.failed()) {
+        return 0;
+    }
+    return bytes;
+}
@@ -0,0 +1,81 @@
+#include "datagram_batch.h"
+
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
+
+#include <netinet/in.h>
+
+using namespace network;
+using namespace network::service;
+
+DatagramBatch::DatagramBatch() noexcept
+{
+    for (std::size_t i = 0; i < CAPACITY; ++i)
+    {
+        vectors_[i].iov_len = types::DATAGRAM_SIZE;
+        headers_[i].msg_hdr.msg_iov = &vectors_[i];
+        headers_[i].msg_hdr.msg_iovlen = 1;
+        headers_[i].msg_hdr.msg_name = &sources_[i];
+    }
+}
+
+std::size_t DatagramBatch::receive(int fd, std::uint8_t* images, std::size_t stride, std::size_t max, boost::system::error_code& ec) noexcept
+{
+    size_ = 0;
+    valid_ = 0;
+    images_ = images;
+    stride_ = stride;
+    max = std::min(max, CAPACITY);
+    if (0 == max) return 0;
+
+    // the kernel writes straight into the caller's images and shrinks the name length to the address it wrote
+    for (std::size_t i = 0; i < max; ++i)
+    {
+        vectors_[i].iov_base = images + i * stride;
+        headers_[i].msg_hdr.msg_namelen = sizeof(sockaddr_storage);
+        headers_[i].msg_hdr.msg_flags = 0;
+    }
+
+    const int n { ::recvmmsg(fd, headers_.data(), static_cast<unsigned>(max), MSG_DONTWAIT, nullptr) };
+    if (n < 0)
+    {
+        if (EAGAIN != errno and EWOULDBLOCK != errno)
+            ec.assign(errno, boost::system::system_category());
+        return 0;
+    }
+
+    size_ = static_cast<std::size_t>(n);
+    for (std::size_t i = 0; i < size_; ++i)
+    {
+        // longer datagrams are cut to the image and must not pass by their length
+        const bool truncated { 0 != (headers_[i].msg_hdr.msg_flags & MSG_TRUNC) };
+        lengths_[i] = truncated ? 0 : headers_[i].msg_len;
+    }
+    valid_ = size_ < 64 ? (std::uint64_t(1) << size_) - 1 : ~std::uint64_t(0);
+    return size_;
+}
+
+std::uint64_t DatagramBatch::validate(message::ValidationRules const& rules, const std::uint8_t* codes) noexcept
+{
+    valid_ &= message::validateBatch(images_, lengths_.data(), codes, size_, rules, stride_);
+    return valid_;
+}
+
+boost::asio::ip::address DatagramBatch::source(std::size_t i) const noexcept
+{
+    if (AF_INET6 == sources_[i].ss_family)
+    {
+        boost::asio::ip::address_v6::bytes_type bytes;
+        std::memcpy(bytes.data(), reinterpret_cast<const sockaddr_in6&>(sources_[i]).sin6_addr.s6_addr, bytes.size());
+        return boost::asio::ip::address_v6 { bytes };
+    }
+    return boost::asio::ip::address_v4 { ntohl(reinterpret_cast<const sockaddr_in&>(sources_[i]).sin_addr.s_addr) };
+}
+
+std::uint16_t DatagramBatch::port(std::size_t i) const noexcept
+{
+    if (AF_INET6 == sources_[i].ss_family)
+        return ntohs(reinterpret_cast<const sockaddr_in6&>(sources_[i]).sin6_port);
+    return ntohs(reinterpret_cast<const sockaddr_in&>(sources_[i]).sin_port);
+}
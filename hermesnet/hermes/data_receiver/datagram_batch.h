@@ -0,0 +1,61 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include <sys/socket.h>
+
+#include <hermes/common/types.h>
+#include <hermes/message/batch_validator.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/system/error_code.hpp>
+#include <boost/asio/ip/address.hpp>
+
+namespace network::service
+{
+    /*
+     * Пачка датаграмм с одного сокета. recvmmsg за один системный
+     * вызов принимает до CAPACITY датаграмм прямо в образы вызывающего,
+     * лежащие с шагом stride (например, wireBuffer() подряд идущих слотов
+     * кольцевого буфера), так что вся пачка проверяется одним вызовом
+     * validateBatch на месте, без промежуточной копии. Отклоненные
+     * (лимитом входа, валидатором) снимаются из маски.
+     */
+    class DatagramBatch : boost::noncopyable
+    {
+    public:
+        static constexpr std::size_t CAPACITY { message::validator::BATCH_MAX };
+
+    private:
+        std::uint8_t*                           images_  { nullptr };
+        std::size_t                             stride_  { types::DATAGRAM_SIZE };
+        std::array<std::uint32_t, CAPACITY>     lengths_ {};
+        std::array<sockaddr_storage, CAPACITY>  sources_ {};
+        std::array<iovec, CAPACITY>             vectors_ {};
+        std::array<mmsghdr, CAPACITY>           headers_ {};
+        std::size_t                             size_    { 0 };
+        std::uint64_t                           valid_   { 0 };
+
+    public:
+        DatagramBatch() noexcept;
+
+        // Принять до max доступных датаграмм без блокировки в образы images с шагом stride, все помечаются корректными
+        std::size_t receive(int fd, std::uint8_t* images, std::size_t stride, std::size_t max, boost::system::error_code& ec) noexcept;
+
+        // Снять датаграмму i
+        void reject(std::size_t i) noexcept { valid_ &= ~(std::uint64_t(1) << i); }
+        // Проверить оставшиеся, codes - код доступа каждой датаграммы (nullptr - rules.accessCode)
+        std::uint64_t validate(message::ValidationRules const& rules, const std::uint8_t* codes = nullptr) noexcept;
+
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+        [[nodiscard]] std::uint64_t valid() const noexcept { return valid_; }
+        [[nodiscard]] const std::uint8_t* image(std::size_t i) const noexcept { return images_ + i * stride_; }
+        [[nodiscard]] std::uint32_t length(std::size_t i) const noexcept { return lengths_[i]; }
+        [[nodiscard]] boost::asio::ip::address source(std::size_t i) const noexcept;
+        [[nodiscard]] std::uint16_t port(std::size_t i) const noexcept;
+
+    };  // DatagramBatch
+
+}   // network::service
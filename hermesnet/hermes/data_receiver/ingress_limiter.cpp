@@ -0,0 +1,134 @@
+#include "ingress_limiter.h"
+
+#include <cassert>
+#include <algorithm>
+
+using namespace network::service;
+
+namespace
+{
+    constexpr std::size_t   PROBES      { 8 };
+    constexpr std::int64_t  NS          { 1000000000 };
+
+    // 64-bit mix (splitmix64 finalizer)
+    inline std::uint64_t mix(std::uint64_t x) noexcept
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ull;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebull;
+        return x ^ (x >> 31);
+    }
+
+    // GCRA: admits with a burst of tolerance / interval + 1 packets
+    inline bool conform(std::int64_t& tat, std::int64_t now, std::int64_t interval, std::int64_t tolerance) noexcept
+    {
+        const auto start { tat > now ? tat : now };
+        if (start - now > tolerance) return false;
+        tat = start + interval;
+        return true;
+    }
+}
+
+IngressLimiter::IngressLimiter(IngressConfig config)
+    : config_(config)
+    , clientInterval_(NS / std::max<std::uint32_t>(1, config.clientRate))
+    , clientTolerance_(clientInterval_ * (std::max<std::uint32_t>(1, config.clientBurst) - 1))
+    , sourceInterval_(NS / std::max<std::uint32_t>(1, config.sourceRate))
+    , sourceTolerance_(sourceInterval_ * (std::max<std::uint32_t>(1, config.sourceBurst) - 1))
+    , clientTat_(config.maxClients, 0)
+    , sources_(config.sources)
+    , mask_(config.sources - 1)
+{}
+
+std::int64_t IngressLimiter::nanos(clock::time_point t) noexcept
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count();
+}
+
+std::uint64_t IngressLimiter::key(boost::asio::ip::address const& address) noexcept
+{
+    // v4 keys carry a marker bit, so no key is 0
+    if (address.is_v4())
+        return (std::uint64_t(1) << 32) | address.to_v4().to_uint();
+
+    const auto bytes { address.to_v6().to_bytes() };
+    std::uint64_t hi { 0 }, lo { 0 };
+    for (std::size_t i = 0; i < 8; ++i)
+    {
+        hi = (hi << 8) | bytes[i];
+        lo = (lo << 8) | bytes[i + 8];
+    }
+    return mix(hi ^ mix(lo)) | (std::uint64_t(1) << 63);
+}
+
+IngressLimiter::Source* IngressLimiter::find(std::uint64_t k, std::int64_t now, bool insert) noexcept
+{
+    Source* victim { nullptr };
+    const auto home { mix(k) };
+    for (std::size_t i = 0; i < PROBES; ++i)
+    {
+        auto& s { sources_[(home + i) & mask_] };
+        if (k == s.key) return &s;
+        if (0 == s.key)
+        {
+            if (not insert) return nullptr;
+            victim = &s;
+            break;
+        }
+        // the longest silent source that is not a client
+        if (0 == s.established and (nullptr == victim or s.tat < victim->tat)) victim = &s;
+    }
+
+    if (not insert or nullptr == victim) return nullptr;
+    victim->key = k;
+    victim->tat = now;
+    victim->established = 0;
+    return victim;
+}
+
+bool IngressLimiter::admitClient(std::size_t client, clock::time_point now) noexcept
+{
+    assert(client < clientTat_.size());
+    if (not conform(clientTat_[client], nanos(now), clientInterval_, clientTolerance_))
+    {
+        ++stats_.clientLimited;
+        return false;
+    }
+    ++stats_.admitted;
+    return true;
+}
+
+bool IngressLimiter::admitSource(boost::asio::ip::address const& address, clock::time_point now, float load) noexcept
+{
+    const auto t { nanos(now) };
+    const bool overloaded { load >= config_.shedLoad };
+
+    // under load unknown sources do not even take a table slot
+    auto s { find(key(address), t, not overloaded) };
+    if (nullptr == s or (overloaded and 0 == s->established))
+    {
+        ++stats_.shed;
+        return false;
+    }
+
+    // connected clients send input to the entry socket, at the client rate
+    const bool client { 0 != s->established };
+    if (not conform(s->tat, t, client ? clientInterval_ : sourceInterval_, client ? clientTolerance_ : sourceTolerance_))
+    {
+        ++stats_.sourceLimited;
+        return false;
+    }
+    ++stats_.admitted;
+    return true;
+}
+
+void IngressLimiter::establish(boost::asio::ip::address const& address, clock::time_point now) noexcept
+{
+    if (auto s { find(key(address), nanos(now), true) }; nullptr != s) s->established = 1;
+}
+
+void IngressLimiter::forget(boost::asio::ip::address const& address) noexcept
+{
+    if (auto s { find(key(address), 0, false) }; nullptr != s) s->established = 0;
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <hermes/common/types.h>
+
+#include <boost/noncopyable.hpp>
+#include <boost/asio/ip/address.hpp>
+
+namespace network::service
+{
+    struct IngressConfig
+    {
+        std::size_t     maxClients  { types::MAX_CLIENTS };
+        std::size_t     sources     { 4096 };   // source table slots, power of two
+        std::uint32_t   clientRate  { 2000 };   // datagrams per second on a client socket
+        std::uint32_t   clientBurst { 64 };
+        std::uint32_t   sourceRate  { 100 };    // datagrams per second from one ip on the entry socket (client rate once established)
+        std::uint32_t   sourceBurst { 16 };
+        float           shedLoad    { 0.5f };   // service ring fill from which new sources are shed
+    };
+
+    struct IngressStats
+    {
+        std::uint64_t   admitted        { 0 };
+        std::uint64_t   clientLimited   { 0 };  // client over its rate
+        std::uint64_t   sourceLimited   { 0 };  // source ip over its rate
+        std::uint64_t   shed            { 0 };  // new sources refused under load
+    };
+
+    /*
+     * Защита входа сервера от потока датаграмм. Проверка идет до
+     * распаковки и валидации: у каждого клиентского сокета и у каждого
+     * ip-адреса источника на входном сокете своя корзина токенов (GCRA:
+     * одно время на корзину, только целочисленные операции). Адреса
+     * лежат в открытой хеш-таблице фиксированного размера; при
+     * переполнении вытесняется самый давно молчавший неустановленный
+     * источник. Под нагрузкой (заполнение входного кольца выше
+     * shedLoad) датаграммы неизвестных источников - новые подключения -
+     * отбрасываются первыми, подключенные клиенты продолжают работать.
+     * Время берется один раз на пачку датаграмм.
+     */
+    class IngressLimiter : boost::noncopyable
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+    private:
+        // slot of the source table, probed together, so kept as one record
+        struct Source
+        {
+            std::uint64_t   key         { 0 };  // 0 - free
+            std::int64_t    tat         { 0 };  // theoretical arrival time, ns
+            std::uint8_t    established { 0 };
+        };
+
+        IngressConfig               config_;
+        std::int64_t                clientInterval_;
+        std::int64_t                clientTolerance_;
+        std::int64_t                sourceInterval_;
+        std::int64_t                sourceTolerance_;
+        std::vector<std::int64_t>   clientTat_;     // per client socket
+        std::vector<Source>         sources_;
+        std::size_t                 mask_;
+        IngressStats                stats_;
+
+        // Слот адреса; nullptr - таблица занята установленными
+        Source* find(std::uint64_t key, std::int64_t now, bool insert) noexcept;
+
+        static std::uint64_t key(boost::asio::ip::address const& address) noexcept;
+        static std::int64_t nanos(clock::time_point t) noexcept;
+
+    public:
+        explicit IngressLimiter(IngressConfig config);
+
+        // Датаграмма с сокета клиента, client < maxClients()
+        bool admitClient(std::size_t client, clock::time_point now) noexcept;
+        // Датаграмма на входной сокет, load - заполнение входного кольца [0..1]
+        bool admitSource(boost::asio::ip::address const& address, clock::time_point now, float load) noexcept;
+
+        // Источник стал подключенным клиентом (не вытесняется и не отсекается под нагрузкой)
+        void establish(boost::asio::ip::address const& address, clock::time_point now) noexcept;
+        void forget(boost::asio::ip::address const& address) noexcept;
+
+        [[nodiscard]] IngressStats const& stats() const noexcept { return stats_; }
+        // Число клиентских сокетов, для которых есть корзины
+        [[nodiscard]] std::size_t maxClients() const noexcept { return clientTat_.size(); }
+
+    };  // IngressLimiter
+
+}   // network::service
@@ -7,7 +7,8 @@ namespace network::service
     class IReceiver
     {
     public:
-        virtual void process() = 0;
+        // Обработать входящие сообщения, возвращает количество принятых датаграмм
+        virtual std::size_t process() = 0;
 
         // http://www.gotw.ca/publications/mill18.htm
         virtual ~IReceiver() {};
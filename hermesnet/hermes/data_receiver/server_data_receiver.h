@@ -1,15 +1,25 @@
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <optional>
+#include <memory_resource>
 
 #include "interface/ireceiver.h"
+#include "ingress_limiter.h"
+#include "datagram_batch.h"
 
 #include <hermes/common/types.h>
+#include <hermes/common/arena.h>
 #include <hermes/common/structures.h>
 #include <hermes/buffers/ring_buffer.h>
+#include <hermes/netloop/shard_mesh.h>
 #include <hermes/message/datagram.h>
+#include <hermes/message/batch_validator.h>
+#include <hermes/message/datagram_cipher.h>
 #include <hermes/message/service_type_id.h>
 #include <hermes/message/objects/ping.h>
+#include <hermes/replication/input_channel.h>
 
 #include <boost/noncopyable.hpp>
 #include <boost/asio/ip/udp.hpp>
@@ -33,6 +43,18 @@ namespace network::service
         using ServiceMessageType  = TimedMessage<Datagram<ServiceType>>;
         using ConcreteMessageType = TimedMessage<Datagram<MessageType>>;
 
+        // datagrams are received and copied as raw bytes
+        static_assert(Datagram<ServiceType>::checkLayout());
+        static_assert(Datagram<MessageType>::checkLayout());
+
+        static constexpr std::size_t BUFFER_CAPACITY { 1024 };  // messages per ring
+
+    public:
+        // Маршрутизация сообщения клиента между шардами: битовая маска шардов-получателей
+        using ShardRouter = std::uint64_t (*)(Header<MessageType> const&);
+        // Новый кадр ввода клиента (повторы отсеяны), от старых к новым
+        using InputHandler = void (*)(replication::ClientIndex, replication::InputFrame, const std::uint8_t* input);
+
     private:
         class Entry&    refEntry_;
         class Clients&  refClients_;
@@ -41,20 +63,64 @@ namespace network::service
         class MessageBuffer<ServiceMessageType>   serviceInBuf_;
         class MessageBuffer<ConcreteMessageType>  messageInBuf_;
 
+        std::uint64_t       serviceStalled_  { 0 }; // entry reads put off on full ring
+        std::uint64_t       invalid_         { 0 }; // datagrams failed validation or authentication, or repeated
+        std::uint64_t       replayed_        { 0 }; // of them repeated sealed datagrams
+
+        // rate limits checked before unpacking and validation
+        IngressLimiter      ingress_;
+
+        // entry socket datagrams of one recvmmsg call, received into ring slots and validated there
+        DatagramBatch       entryBatch_;
+
+        // client input frames, repeats of the redundant packets are dropped before the handler
+        replication::InputReceiver  input_;
+        InputHandler                inputHandler_ { nullptr };
+
+        // связь с остальными шардами (только в многоядерном режиме)
+        ShardLink<ConcreteMessageType>  shard_  {};
+        ShardRouter                     router_ { nullptr };
+
     public:
-        explicit ServerDataReceiver(net::io_service& service, Entry& e, Clients& c);
+        explicit ServerDataReceiver(net::io_service& service, Entry& e, Clients& c, std::pmr::memory_resource* memory = std::pmr::get_default_resource(),
+                                    IngressConfig ingress = {}, replication::InputConfig input = {});
         virtual ~ServerDataReceiver() = default;
 
         // Обработать входящие сообщения
-        void process() final;
+        std::size_t process() final;
+
+        // Подключить приемник к сетке очередей между шардами
+        void attachShard(ShardLink<ConcreteMessageType> link, ShardRouter router) noexcept;
+        // Получатель кадров ввода клиентов (действие MessageType::INPUT_ACTION с их сокетов), nullptr - ввод отбрасывается
+        void setInputHandler(InputHandler handler) noexcept { inputHandler_ = handler; }
+
+        // Добавить принятого клиента (из потока приема или до его запуска): индекс клиента, nullopt - мест нет
+        std::optional<std::size_t> acceptClient(net::ip::udp::socket in, net::ip::udp::socket out, net::ip::udp::endpoint const& endpoint,
+                                                std::uint32_t uuid, std::uint8_t accessCode);
+
+        // Ограничения входа: подключенные источники (establish) и счетчики отброшенного
+        [[nodiscard]] IngressLimiter& ingress() noexcept { return ingress_; }
+        [[nodiscard]] std::uint64_t serviceStalled() const noexcept { return serviceStalled_; }
+        [[nodiscard]] std::uint64_t invalid() const noexcept { return invalid_; }
+        [[nodiscard]] std::uint64_t replayed() const noexcept { return replayed_; }
+        // Последние принятые кадры ввода клиентов (подтверждаются клиентам)
+        [[nodiscard]] replication::InputReceiver const& input() const noexcept { return input_; }
 
     private:
         // Получить количество доступных байт для чтения без блокировки
         inline std::size_t isDataReady(const boost::asio::ip::udp::socket& socket) final;
         // Прочитать ассоциированные с удаленной точкой данные с входного сокета сервера
-        void readFromEntry(net::ip::udp::socket& socket, std::uint8_t code);
+        std::size_t readFromEntry(net::ip::udp::socket& socket, std::uint8_t code);
         // Прочитать данные от всех клиентов
-        void readFromClients(std::vector<net::ip::udp::socket>& sockets, std::vector<std::size_t>& sizes, std::vector<std::uint8_t>& codes);
+        std::size_t readFromClients(std::vector<net::ip::udp::socket>& sockets, std::pmr::vector<std::size_t> const& sizes, std::vector<std::uint8_t>& codes);
+        // Расшифровать запечатанные образы клиентов на месте и отсеять повторы, возвращает маску принятых
+        std::uint64_t openFromClients(std::uint8_t* images, const std::uint32_t* owners, std::size_t n, std::uint64_t valid) noexcept;
+        // Разобрать ввод из принятых образов клиентов, возвращает маску остальных (для шардов)
+        std::uint64_t receiveInputs(const std::uint8_t* images, const std::uint32_t* owners, std::size_t n, std::uint64_t valid) noexcept;
+        // Переслать датаграмму клиента в шарды, выбранные маршрутизатором
+        void forwardToShards(const std::uint8_t* data, std::size_t len);
+        // Принять сообщения, пересланные другими шардами
+        std::size_t drainShards();
 
     };  // ServerDataReceiver
 
@@ -62,6 +128,10 @@ namespace network::service
 
 // ********************************* IMPLEMENTATION **********************************
 
+#include <cstdio>
+#include <cassert>
+#include <cstring>
+#include <algorithm>
 #include <iomanip>
 #include <hermes/log/log.h>
 #include <hermes/message/message_generator.h>
@@ -84,33 +154,68 @@ namespace
 }
 
 template<typename MessageType>
-ServerDataReceiver<MessageType>::ServerDataReceiver(boost::asio::io_service &service, Entry &e, Clients &c)
+ServerDataReceiver<MessageType>::ServerDataReceiver(boost::asio::io_service &service, Entry &e, Clients &c, std::pmr::memory_resource* memory,
+                                                    IngressConfig ingress, replication::InputConfig input)
         : refEntry_(e)
         , refClients_(c)
-        , serviceInBuf_(1024)
-        , messageInBuf_(1024)
+        , serviceInBuf_(BUFFER_CAPACITY, memory)
+        , messageInBuf_(BUFFER_CAPACITY, memory)
+        , ingress_(ingress)
+        , input_({ input.frameBytes, input.redundancy, std::max(input.maxClients, ingress.maxClients) })
 {
     LOG_REGISTER_MODULE(EModule::RECEIVER)
 }
 
 template<typename MessageType>
-void ServerDataReceiver<MessageType>::process()
+std::size_t ServerDataReceiver<MessageType>::process()
 {
-    LOG_DURATION("receiver::process")
-
     // process messages for server (new clients, management services and etc)
-    readFromEntry(refEntry_.in, refEntry_.accessCode);
+    std::size_t received { readFromEntry(refEntry_.in, refEntry_.accessCode) };
     // ...logic
 
-    // process message from clients (validated and connected clients)
-    std::vector<std::size_t> sizes;
+    // process message from clients (validated and connected clients),
+    // per tick buffers live in the thread's tick arena reset by the net loop
+    std::pmr::vector<std::size_t> sizes { &memory::tickArena() };
     sizes.reserve(refClients_.vIn.size());
 
     for (auto& s : refClients_.vIn)
         sizes.push_back(isDataReady(s));
 
-    readFromClients(refClients_.vIn, sizes, refClients_.vAccessCodes);
+    received += readFromClients(refClients_.vIn, sizes, refClients_.vAccessCodes);
     // ...logic
+
+    // process messages forwarded by other shards (sharded mode only)
+    received += drainShards();
+
+    return received;
+}
+
+template<typename MessageType>
+void ServerDataReceiver<MessageType>::attachShard(ShardLink<ConcreteMessageType> link, ShardRouter router) noexcept
+{
+    shard_ = link;
+    router_ = router;
+}
+
+template<typename MessageType>
+std::optional<std::size_t> ServerDataReceiver<MessageType>::acceptClient(net::ip::udp::socket in, net::ip::udp::socket out, net::ip::udp::endpoint const& endpoint,
+                                                                         std::uint32_t uuid, std::uint8_t accessCode)
+{
+    // client sockets are indexes of the ingress buckets
+    auto& c { refClients_ };
+    if (c.vIn.size() >= ingress_.maxClients()) return std::nullopt;
+
+    const auto client { c.vIn.size() };
+    c.vIn.push_back(std::move(in));
+    c.vOut.push_back(std::move(out));
+    c.vEndpoints.push_back(endpoint);
+    c.vUUIDs.push_back(uuid);
+    c.vAccessCodes.push_back(accessCode);
+
+    // its datagrams to the entry socket are no longer shed under load
+    ingress_.establish(endpoint.address(), IngressLimiter::clock::now());
+    input_.reset(static_cast<replication::ClientIndex>(client));
+    return client;
 }
 
 template<typename MessageType>
@@ -125,82 +230,117 @@ inline std::size_t ServerDataReceiver<MessageType>::isDataReady(const boost::asi
 }
 
 template<typename MessageType>
-void ServerDataReceiver<MessageType>::readFromEntry(net::ip::udp::socket& socket, std::uint8_t code)
+std::size_t ServerDataReceiver<MessageType>::readFromEntry(net::ip::udp::socket& socket, std::uint8_t code)
 {
     // check available data on socket
-    if (not isDataReady(socket)) return;
+    if (not isDataReady(socket)) return 0;
 
-    // prepare datagram
-    const auto flags {0};
-    boost::system::error_code ec;
-    net::ip::udp::endpoint remote_endpoint;
-
-    Header<ServiceType> header;
-    Body body;
-
-    Datagram<ServiceType> datagram(std::move(header), std::move(body));
-    ServiceMessageType tmDatagram(std::move(datagram));
-
-    // try to get data
-    auto buf   { boost::asio::buffer(&tmDatagram.message, DATAGRAM_SIZE) };
-    auto bytes { socket.receive_from(buf, remote_endpoint, flags, ec) };
-
-    if (ec.failed()) {
-        std::stringstream ss;
-        ss << "error while reading data from entry socket: " << std::quoted(ec.message());
-        LOG(ss.str().c_str())
-    }
-
-    // validation
-    const bool valid { message::helper::validateDataram(tmDatagram.message) };
-    if (not valid) return;
+    // free slots at the end of the ring first, then the ones wrapped to its start
+    std::size_t total { 0 };
+    for (int pass = 0; pass < 2; ++pass)
+    {
+        std::size_t count { 0 };
+        auto span { serviceInBuf_.reserveSpan(DatagramBatch::CAPACITY, count) };
+        if (0 == count) {
+            // datagrams wait in the socket buffer until the consumer frees slots
+            ++serviceStalled_;
+            break;
+        }
 
-    tmDatagram.fixTime();
+        // drain up to a batch of datagrams with one call, straight into the slots
+        boost::system::error_code ec;
+        const auto received { entryBatch_.receive(socket.native_handle(), span[0].message.wireBuffer(), sizeof(ServiceMessageType), count, ec) };
 
-    // [TEST SECTION - BEGIN]
-    if (bytes > 0)
-    {
-        {
+        if (ec.failed()) {
             std::stringstream ss;
-            auto tm { std::chrono::system_clock::to_time_t(tmDatagram.arrivedTime) };
-            ss  << "recevied message [" << std::put_time(std::localtime(&tm), "%F %T") <<  "]:\n"
-                << std::flush
-                << tmDatagram.message << "\n";
-
+            ss << "error while reading data from entry socket: " << std::quoted(ec.message());
             LOG(ss.str().c_str())
+            break;
         }
 
-        if (ServiceType::EServiceAction::SERVICE_ACT_PING == tmDatagram.message.HeaderRef().type.action)
+        // floods are cut before any parsing, new sources first when the ring fills up
+        const auto now  { IngressLimiter::clock::now() };
+        const auto load { static_cast<float>(serviceInBuf_.size()) / BUFFER_CAPACITY };
+        for (std::size_t i = 0; i < received; ++i)
+            if (not ingress_.admitSource(entryBatch_.source(i), now, load)) entryBatch_.reject(i);
+
+        // the whole batch is validated in the slots, survivors are unpacked there and
+        // moved down only over the rejected ones
+        const auto admitted { static_cast<std::size_t>(__builtin_popcountll(entryBatch_.valid())) };
+        std::size_t kept { 0 };
+        for (auto valid { entryBatch_.validate(rulesFor<ServiceType>(code)) }; 0 != valid; valid &= valid - 1)
         {
-            using namespace object;
-            MPing ping;
-            tmDatagram.message.BodyRef().read(ping, sizeof(ping));
+            const auto i { static_cast<std::size_t>(__builtin_ctzll(valid)) };
+            auto& tmDatagram { span[i] };
+            if (not tmDatagram.message.decodeInPlace()) continue;
+
+            // input is taken from the client sockets only, where it is sealed and checked for repeats
+            if (ServiceType::EServiceAction::SERVICE_ACT_INPUT == tmDatagram.message.HeaderRef().type.action) continue;
+
+            tmDatagram.fixTime();
+
+            // [TEST SECTION - BEGIN]
+#ifdef Debug
+            {
+                std::stringstream ss;
+                auto tm { std::chrono::system_clock::to_time_t(tmDatagram.arrivedTime) };
+                ss  << "recevied message [" << std::put_time(std::localtime(&tm), "%F %T") <<  "]:\n"
+                    << std::flush
+                    << tmDatagram.message << "\n";
+
+                LOG(ss.str().c_str())
+            }
+
+            if (ServiceType::EServiceAction::SERVICE_ACT_PING == tmDatagram.message.HeaderRef().type.action)
+            {
+                using namespace object;
+                MPing ping;
+                schema::read(tmDatagram.message.BodyRef(), ping);
+
+                std::stringstream ss;
+                ss << "received ping object:\n" << ping;
+                LOG(ss.str().c_str())
+            }
+#endif
+            // [TEST SECTION - END]
 
-            std::stringstream ss;
-            ss << "received ping object:\n" << ping;
-            LOG(ss.str().c_str())
+            if (kept != i) span[kept] = tmDatagram;
+            ++kept;
         }
-    }
-    // [TEST SECTION - END]
+        invalid_ += admitted - kept;
 
-    // store
-    if (not serviceInBuf_.full())
-    {
-        serviceInBuf_.storeElem(std::forward<ServiceMessageType>(tmDatagram));
+        // publish for consumer
+        serviceInBuf_.commitSpan(kept);
+        total += received;
+
+        // the socket is drained, or the batch did not reach the ring end
+        if (received < count) break;
     }
+
+    return total;
 }
 
 template<typename MessageType>
-void ServerDataReceiver<MessageType>::readFromClients(std::vector<net::ip::udp::socket> &sockets, std::vector<std::size_t> &sizes, std::vector<std::uint8_t> &codes)
+std::size_t ServerDataReceiver<MessageType>::readFromClients(std::vector<net::ip::udp::socket> &sockets, std::pmr::vector<std::size_t> const& sizes, std::vector<std::uint8_t> &codes)
 {
-    std::vector<std::uint8_t> result;
+    using Chunk = std::array<std::uint8_t, DATAGRAM_SIZE>;  // type -> message_block_t<message_id_t>
+
+    std::pmr::vector<std::uint8_t> result { &memory::tickArena() };
     result.reserve(8192);   // todo: MAGIC WORD
 
-    auto reset = [](std::vector<std::uint8_t>& v, std::size_t len) -> void {
+    // received length, expected access code and client of each chunk in result
+    std::pmr::vector<std::uint32_t> lengths { &memory::tickArena() };
+    std::pmr::vector<std::uint8_t> expected { &memory::tickArena() };
+    std::pmr::vector<std::uint32_t> owners { &memory::tickArena() };
+    lengths.reserve(sockets.size());
+    expected.reserve(sockets.size());
+    owners.reserve(sockets.size());
+
+    auto reset = [](Chunk& v, std::size_t len) -> void {
         std::memset(static_cast<std::uint8_t*>(v.data()), 0x0, len * sizeof(std::uint8_t));
     };
 
-    auto extract = [&reset, &result](std::vector<std::uint8_t>& chunk) -> void {
+    auto extract = [&reset, &result](Chunk& chunk) -> void {
         result.insert(std::end(result), std::begin(chunk), std::end(chunk));
         reset(chunk, chunk.size());
     };
@@ -208,8 +348,12 @@ void ServerDataReceiver<MessageType>::readFromClients(std::vector<net::ip::udp::
     const auto flags {0};
     std::size_t received {0};
     boost::system::error_code ec;
-    std::vector<std::uint8_t> chunk (64, 0x0); // type -> message_block_t<message_id_t>
+    Chunk chunk {};
 
+    // rows are added by acceptClient only, within the ingress buckets
+    assert(sockets.size() <= ingress_.maxClients());
+
+    const auto now { IngressLimiter::clock::now() };
     const auto count = sockets.size();
     for (std::size_t i = 0; i < count; ++i)
     {
@@ -217,7 +361,8 @@ void ServerDataReceiver<MessageType>::readFromClients(std::vector<net::ip::udp::
         received = sizes[i];
         if (0 == received) continue;
 
-        auto wrapper { boost::asio::buffer(chunk.data(), received) };
+        // longer datagrams are truncated to the chunk
+        auto wrapper { boost::asio::buffer(chunk.data(), std::min(received, chunk.size())) };
         received = sockets[i].receive(wrapper, flags, ec);
 
         if (ec.failed()) {
@@ -228,7 +373,133 @@ void ServerDataReceiver<MessageType>::readFromClients(std::vector<net::ip::udp::
             continue;
         }
 
+        if (not ingress_.admitClient(i, now)) {
+            reset(chunk, received);
+            continue;
+        }
+
+        lengths.push_back(static_cast<std::uint32_t>(received));
+        expected.push_back(codes[i]);
+        owners.push_back(static_cast<std::uint32_t>(i));
         extract(chunk);
     } // loop
+
+    // chunks are validated and opened in batches, survivors packed to the front of result
+    const auto rules { rulesFor<MessageType>(SERVER_ACCESS_CODE, false, true) };
+    std::size_t valid {0}, inputs {0};
+    for (std::size_t at = 0; at < lengths.size(); at += validator::BATCH_MAX)
+    {
+        const auto n    { std::min(validator::BATCH_MAX, lengths.size() - at) };
+        const auto data { result.data() + at * DATAGRAM_SIZE };
+        const auto mask { openFromClients(data, owners.data() + at, n, validateBatch(data, lengths.data() + at, expected.data() + at, n, rules)) };
+        const auto rest { receiveInputs(data, owners.data() + at, n, mask) };
+        const auto kept { compactBatch(data, lengths.data() + at, n, rest) };
+        inputs += static_cast<std::size_t>(__builtin_popcountll(mask & ~rest));
+
+        if (valid != at) std::memmove(result.data() + valid * DATAGRAM_SIZE, data, kept * DATAGRAM_SIZE);
+        valid += kept;
+    }
+    invalid_ += lengths.size() - valid - inputs;
+    result.resize(valid * DATAGRAM_SIZE);
+
+    if (shard_.attached())
+        for (std::size_t i = 0; i < valid; ++i)
+            forwardToShards(result.data() + i * DATAGRAM_SIZE, DATAGRAM_SIZE);
+
+    return lengths.size();
+}
+
+template<typename MessageType>
+std::uint64_t ServerDataReceiver<MessageType>::openFromClients(std::uint8_t* images, const std::uint32_t* owners, std::size_t n, std::uint64_t valid) noexcept
+{
+    auto& c { refClients_ };
+
+    // clients with session keys send sealed datagrams only, the others plaintext only
+    std::uint64_t required { 0 };
+    for (std::size_t i = 0; i < n; ++i)
+        required |= std::uint64_t(owners[i] < c.vSealed.size() and 0 != c.vSealed[owners[i]]) << i;
+
+    valid &= ~(sealedImages(images, n) ^ required);
+    if (0 == (valid & required)) return valid;
+
+    std::array<std::uint64_t, validator::BATCH_MAX> sequences;
+    const auto authentic { openBatch(images, n, valid & required, c.vReceiveKeys.data(), owners, c.vReceiveSequence.data(), sequences.data()) };
+
+    // repeats stop here, before the rings and dispatch
+    const auto fresh { acceptBatch(authentic, owners, sequences.data(), c.vReceiveSequence.data(), c.vReplayWindow.data()) };
+    replayed_ += static_cast<std::uint64_t>(__builtin_popcountll(authentic & ~fresh));
+    return (valid & ~required) | fresh;
+}
+
+template<typename MessageType>
+std::uint64_t ServerDataReceiver<MessageType>::receiveInputs(const std::uint8_t* images, const std::uint32_t* owners, std::size_t n, std::uint64_t valid) noexcept
+{
+    using Input = replication::InputAction<MessageType>;
+    if constexpr (not Input::declared) return valid;
+    else
+    {
+        // images are opened and fresh here, the sender is the owner of the socket
+        std::uint64_t inputs { 0 };
+        for (auto mask { valid }; 0 != mask; mask &= mask - 1)
+        {
+            const auto i { static_cast<std::size_t>(__builtin_ctzll(mask)) };
+            const auto p { images + i * DATAGRAM_SIZE };
+            if (Input::value != (p[0] | (std::uint32_t(p[1]) << 8))) continue;
+            inputs |= std::uint64_t(1) << i;
+
+            Datagram<MessageType> datagram;
+            if (not datagram.decode(p, DATAGRAM_SIZE)) {
+                ++invalid_;
+                continue;
+            }
+
+            const auto client { static_cast<replication::ClientIndex>(owners[i]) };
+            BitReader r { datagram.BodyRef().buf.data(), datagram.BodyRef().size };
+            const bool parsed { input_.receive(client, r, [this, client](replication::InputFrame frame, const std::uint8_t* data) {
+                if (nullptr != inputHandler_) inputHandler_(client, frame, data);
+            }) };
+            if (not parsed) ++invalid_;
+        }
+        return valid & ~inputs;
+    }
+}
+
+template<typename MessageType>
+void ServerDataReceiver<MessageType>::forwardToShards(const std::uint8_t* data, std::size_t len)
+{
+    if (nullptr == router_) return;
+
+    ConcreteMessageType tmDatagram;
+    if (not tmDatagram.message.decode(data, len)) return;
+    tmDatagram.fixTime();
+
+    std::uint64_t targets { router_(tmDatagram.message.HeaderRef()) };
+    targets &= ~(std::uint64_t(1) << shard_.index);
+
+    for (std::uint32_t to = 0; 0 != targets; ++to, targets >>= 1)
+    {
+        if (0 == (targets & 1)) continue;
+
+        ConcreteMessageType copy { tmDatagram };
+        if (not shard_.mesh->push(shard_.index, to, std::move(copy)))
+        {
+            char text[96];
+            std::snprintf(text, sizeof(text), "shard queue overflow [%u -> %u], message dropped", shard_.index, to);
+            LOG(text)
+        }
+    }
+}
+
+template<typename MessageType>
+std::size_t ServerDataReceiver<MessageType>::drainShards()
+{
+    if (not shard_.attached()) return 0;
+
+    return shard_.mesh->drain(shard_.index, [this](ConcreteMessageType&& tmDatagram) {
+        if (not messageInBuf_.full())
+        {
+            messageInBuf_.storeElem(std::forward<ConcreteMessageType>(tmDatagram));
+        }
+    });
 }
 
@@ -0,0 +1,150 @@
+#include "rate_control.h"
+
+#include <algorithm>
+
+using namespace network;
+using namespace network::service;
+
+namespace
+{
+    constexpr float RTT_GAIN    { 1.0f / 8 };   // RFC 6298
+    constexpr float LOSS_GAIN   { 1.0f / 4 };
+    constexpr float LOSS_HIGH   { 0.10f };      // delay mode: loss rate that cuts the rate
+    constexpr float LOSS_LOW    { 0.02f };      // delay mode: loss rate that still allows growth
+
+    inline float millis(std::chrono::nanoseconds d) noexcept {
+        return std::chrono::duration<float, std::milli>(d).count();
+    }
+
+    inline double seconds(std::chrono::nanoseconds d) noexcept {
+        return std::chrono::duration<double>(d).count();
+    }
+}
+
+RateControl::RateControl(RateConfig config) noexcept
+    : config_(config)
+{}
+
+void RateControl::connect(Clients& c, std::size_t client, clock::time_point now) const
+{
+    if (c.vSendRate.size() <= client)
+    {
+        const auto rows { client + 1 };
+        c.vSendRate.resize(rows);
+        c.vPaceTokens.resize(rows);
+        c.vPaceTime.resize(rows);
+        c.vSmoothRtt.resize(rows);
+        c.vMinRtt.resize(rows);
+        c.vMinRttTime.resize(rows);
+        c.vLossRate.resize(rows);
+        c.vFeedbackTime.resize(rows);
+        c.vDecreaseTime.resize(rows);
+    }
+
+    c.vSendRate[client] = config_.startRate;
+    c.vPaceTokens[client] = types::DATAGRAM_SIZE;
+    c.vPaceTime[client] = now;
+    c.vSmoothRtt[client] = 0.0f;   // no sample yet
+    c.vMinRtt[client] = 0.0f;
+    c.vMinRttTime[client] = now;
+    c.vLossRate[client] = 0.0f;
+    c.vFeedbackTime[client] = now;
+    c.vDecreaseTime[client] = now;
+}
+
+void RateControl::feedback(Clients& c, std::size_t client, std::chrono::nanoseconds rtt,
+                           std::uint32_t sent, std::uint32_t lost, clock::time_point now) const noexcept
+{
+    const float sample { millis(rtt) };
+    auto& srtt { c.vSmoothRtt[client] };
+    auto& minRtt { c.vMinRtt[client] };
+
+    srtt = 0.0f == srtt ? sample : srtt + (sample - srtt) * RTT_GAIN;
+    // the base delay may grow after a route change, so the minimum expires
+    if (0.0f == minRtt or sample < minRtt or now - c.vMinRttTime[client] > config_.minRttWindow)
+    {
+        minRtt = sample;
+        c.vMinRttTime[client] = now;
+    }
+
+    auto& loss { c.vLossRate[client] };
+    if (0 != sent)
+        loss += (static_cast<float>(std::min(lost, sent)) / static_cast<float>(sent) - loss) * LOSS_GAIN;
+
+    // growth is per rtt whatever the feedback period
+    const std::chrono::duration<float, std::milli> period { srtt };
+    const double elapsed { seconds(now - c.vFeedbackTime[client]) };
+    const double rtts { std::min(1.0, elapsed / std::max(1e-3, static_cast<double>(srtt) / 1000.0)) };
+    c.vFeedbackTime[client] = now;
+
+    // at most one decrease per rtt, its effect shows in the next one
+    const bool mayDecrease { now - c.vDecreaseTime[client] >= std::chrono::duration_cast<std::chrono::nanoseconds>(period) };
+    auto& rate { c.vSendRate[client] };
+    bool decrease { false };
+    double factor { 1.0 };
+
+    if (ERateMode::AIMD == config_.mode)
+    {
+        if (0 != lost)
+        {
+            decrease = true;
+            factor = config_.lossDecrease;
+        }
+    }
+    else
+    {
+        const float queuing { sample - minRtt };  // srtt lags a few feedbacks behind the queue
+        const float target { std::chrono::duration<float, std::milli>(config_.queueTarget).count() };
+        if (loss > LOSS_HIGH)
+        {
+            decrease = true;
+            factor = 1.0 - 0.5 * static_cast<double>(loss);
+        }
+        else if (queuing > target)
+        {
+            decrease = true;
+            factor = config_.delayDecrease;
+        }
+        else if (queuing > target / 2 or loss > LOSS_LOW)
+            return;     // hold the rate near the target
+    }
+
+    if (decrease)
+    {
+        if (not mayDecrease) return;
+        rate *= factor;
+        c.vDecreaseTime[client] = now;
+    }
+    else rate += config_.increase * rtts;
+
+    rate = std::clamp(rate, config_.minRate, config_.maxRate);
+}
+
+void RateControl::refill(Clients& c, std::size_t client, clock::time_point now) const noexcept
+{
+    const auto rate { c.vSendRate[client] };
+    const double depth { std::max(rate * seconds(config_.burst), 2.0 * types::DATAGRAM_SIZE) };
+    const double elapsed { seconds(now - c.vPaceTime[client]) };
+
+    c.vPaceTokens[client] = std::min(depth, c.vPaceTokens[client] + rate * std::max(0.0, elapsed));
+    c.vPaceTime[client] = now;
+}
+
+bool RateControl::trySend(Clients& c, std::size_t client, std::size_t bytes, clock::time_point now) const noexcept
+{
+    refill(c, client, now);
+
+    auto& tokens { c.vPaceTokens[client] };
+    if (tokens < static_cast<double>(bytes)) return false;
+    tokens -= static_cast<double>(bytes);
+    return true;
+}
+
+RateControl::clock::time_point RateControl::nextSend(Clients const& c, std::size_t client, std::size_t bytes) const noexcept
+{
+    const double missing { static_cast<double>(bytes) - c.vPaceTokens[client] };
+    if (missing <= 0.0) return c.vPaceTime[client];
+
+    const std::chrono::duration<double> wait { missing / c.vSendRate[client] };
+    return c.vPaceTime[client] + std::chrono::duration_cast<clock::duration>(wait);
+}
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+#include <hermes/common/types.h>
+#include <hermes/common/structures.h>
+
+namespace network::service
+{
+    enum class ERateMode : std::uint8_t
+    {
+        DELAY = 0,  // backs off on growing queuing delay, before the loss
+        AIMD        // additive increase, halving on loss
+    };
+
+    struct RateConfig
+    {
+        ERateMode                   mode            { ERateMode::DELAY };
+        double                      minRate         { 16.0 * 1024 };        // bytes per second
+        double                      maxRate         { 8.0 * 1024 * 1024 };
+        double                      startRate       { 128.0 * 1024 };
+        double                      increase        { 16.0 * 1024 };        // per rtt
+        double                      delayDecrease   { 0.9 };               // rate factor on queuing
+        double                      lossDecrease    { 0.5 };                // rate factor on loss (AIMD)
+        std::chrono::milliseconds   queueTarget     { 15 };                 // tolerated queuing delay
+        std::chrono::milliseconds   burst           { 4 };                  // pacer bucket depth at current rate
+        std::chrono::seconds        minRttWindow    { 10 };                 // path delay is re-measured after it
+    };
+
+    /*
+     * Управление скоростью отправки клиенту. Клиент присылает обратную
+     * связь: RTT и сколько датаграмм из отправленных потеряно. Режим
+     * DELAY (для трафика реального времени) оценивает задержку в
+     * очередях как последний RTT минус минимальный и снижает скорость,
+     * как только очередь растет выше queueTarget, не доводя до потерь;
+     * при большой доле потерь скорость снижается пропорционально ей.
+     * Режим AIMD - запасной: рост на increase за RTT, уменьшение вдвое
+     * при потере. Снижение - не чаще раза за RTT.
+     *
+     * Темп отправки задает корзина токенов: токены копятся со скоростью
+     * клиента, глубина корзины - burst по времени, так что датаграммы
+     * тика уходят равномерно, а не пачкой. Состояние хранится в строке
+     * клиента в Clients, сам класс держит только настройки.
+     */
+    class RateControl
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+    private:
+        RateConfig  config_;
+
+        // Пополнить корзину к моменту now
+        void refill(Clients& c, std::size_t client, clock::time_point now) const noexcept;
+
+    public:
+        explicit RateControl(RateConfig config) noexcept;
+
+        // Начальное состояние строки клиента (строки добавляются при необходимости)
+        void connect(Clients& c, std::size_t client, clock::time_point now) const;
+
+        // Обратная связь: RTT и потери среди sent датаграмм с прошлого отчета
+        void feedback(Clients& c, std::size_t client, std::chrono::nanoseconds rtt,
+                      std::uint32_t sent, std::uint32_t lost, clock::time_point now) const noexcept;
+
+        // Можно ли отправить bytes сейчас; при true токены списываются
+        bool trySend(Clients& c, std::size_t client, std::size_t bytes, clock::time_point now) const noexcept;
+
+        // Когда накопится bytes токенов
+        [[nodiscard]] clock::time_point nextSend(Clients const& c, std::size_t client, std::size_t bytes) const noexcept;
+
+        [[nodiscard]] RateConfig const& config() const noexcept { return config_; }
+
+    };  // RateControl
+
+}   // network::service
@@ -0,0 +1,154 @@
+#include "fec_codec.h"
+
+#include <algorithm>
+
+using namespace network::fec;
+
+std::uint8_t network::fec::coefficient(EFecMode mode, std::size_t i, std::size_t j) noexcept
+{
+    // Cauchy matrix 1 / (x_i + y_j), x_i = MAX_SOURCES + i and y_j = j never meet
+    if (EFecMode::XOR == mode) return 1;
+    return gf256::inv(static_cast<std::uint8_t>((MAX_SOURCES + i) ^ j));
+}
+
+FecEncoder::FecEncoder(FecConfig config) noexcept
+    : config_(config)
+{}
+
+std::size_t FecEncoder::protect(const std::uint8_t* payload, std::size_t size, std::uint8_t* out) noexcept
+{
+    if (EFecMode::NONE == config_.mode)
+    {
+        if (size > message::CAPACITY) return 0;
+        std::copy_n(payload, size, out);
+        return size;
+    }
+    if (size > MAX_PAYLOAD) return 0;
+
+    const auto parity { config_.parityCount() };
+    if (count_ == config_.sources)
+    {
+        for (std::size_t i = 0; i < parity; ++i)
+            std::fill_n(parity_[i].begin(), shardBytes_, 0);
+        shardBytes_ = 0;
+        count_ = 0;
+        ++group_;
+    }
+
+    out[0] = group_;
+    out[1] = count_;
+    out[2] = static_cast<std::uint8_t>(((config_.sources - 1) << 4) | (parity - 1));
+    std::copy_n(payload, size, out + HEADER_SIZE);
+
+    // parity accumulates the shard [length][payload]
+    std::array<std::uint8_t, SHARD_BYTES> shard;
+    shard[0] = static_cast<std::uint8_t>(size);
+    std::copy_n(payload, size, shard.data() + 1);
+    for (std::size_t i = 0; i < parity; ++i)
+        gf256::mulAdd(parity_[i].data(), shard.data(), coefficient(config_.mode, i, count_), size + 1);
+
+    shardBytes_ = std::max(shardBytes_, size + 1);
+    ++count_;
+    return size + HEADER_SIZE;
+}
+
+std::size_t FecEncoder::parityReady() const noexcept
+{
+    return count_ == config_.sources ? config_.parityCount() : 0;
+}
+
+std::size_t FecEncoder::parity(std::size_t i, std::uint8_t* out) const noexcept
+{
+    out[0] = group_;
+    out[1] = static_cast<std::uint8_t>(config_.sources + i);
+    out[2] = static_cast<std::uint8_t>(((config_.sources - 1) << 4) | (config_.parityCount() - 1));
+    std::copy_n(parity_[i].data(), shardBytes_, out + HEADER_SIZE);
+    return shardBytes_ + HEADER_SIZE;
+}
+
+FecDecoder::FecDecoder(FecConfig config) noexcept
+    : config_(config)
+{}
+
+FecDecoder::Group* FecDecoder::slot(std::uint8_t number, std::uint8_t sources, std::uint8_t parity) noexcept
+{
+    auto& g { groups_[number % GROUPS] };
+    if (g.used and g.number == number) return &g;
+    // an older group than the one in the slot has passed already
+    if (g.used and static_cast<std::int8_t>(number - g.number) < 0) return nullptr;
+
+    if (g.used and not g.done)
+    {
+        const std::uint32_t dataBits { (std::uint32_t(1) << g.sources) - 1 };
+        lost_ += static_cast<std::uint64_t>(g.sources - __builtin_popcount(g.present & dataBits));
+    }
+
+    g.present = 0;
+    g.parityBytes = 0;
+    g.number = number;
+    g.sources = sources;
+    g.parity = parity;
+    g.used = true;
+    g.done = false;
+    return &g;
+}
+
+bool FecDecoder::recover(Group& g) noexcept
+{
+    const std::size_t k { g.sources };
+    if (static_cast<std::size_t>(__builtin_popcount(g.present)) < k or 0 == g.parityBytes) return false;
+
+    // k received shards: all data ones and enough parity ones
+    std::array<std::uint8_t, MAX_SOURCES> rows;
+    std::size_t n { 0 };
+    for (std::size_t index = 0; n < k and index < std::size_t(g.sources) + g.parity; ++index)
+        if (g.present & (std::uint32_t(1) << index)) rows[n++] = static_cast<std::uint8_t>(index);
+
+    // matrix of the received shards over the data ones, inverted in place (Gauss-Jordan)
+    std::array<std::array<std::uint8_t, MAX_SOURCES>, MAX_SOURCES> a {};
+    std::array<std::array<std::uint8_t, MAX_SOURCES>, MAX_SOURCES> inv {};
+    for (std::size_t r = 0; r < k; ++r)
+    {
+        inv[r][r] = 1;
+        for (std::size_t c = 0; c < k; ++c)
+            a[r][c] = rows[r] < k ? (rows[r] == c ? 1 : 0) : coefficient(config_.mode, rows[r] - k, c);
+    }
+
+    for (std::size_t c = 0; c < k; ++c)
+    {
+        std::size_t pivot { c };
+        while (pivot < k and 0 == a[pivot][c]) ++pivot;
+        if (pivot == k) return false;
+        std::swap(a[pivot], a[c]);
+        std::swap(inv[pivot], inv[c]);
+
+        const auto scale { gf256::inv(a[c][c]) };
+        for (std::size_t i = 0; i < k; ++i)
+        {
+            a[c][i] = gf256::mul(a[c][i], scale);
+            inv[c][i] = gf256::mul(inv[c][i], scale);
+        }
+        for (std::size_t r = 0; r < k; ++r)
+        {
+            const auto f { a[r][c] };
+            if (r == c or 0 == f) continue;
+            for (std::size_t i = 0; i < k; ++i)
+            {
+                a[r][i] ^= gf256::mul(f, a[c][i]);
+                inv[r][i] ^= gf256::mul(f, inv[c][i]);
+            }
+        }
+    }
+
+    // data shard j = row j of the inverse applied to the received shards
+    for (std::size_t j = 0; j < k; ++j)
+    {
+        if (g.present & (std::uint32_t(1) << j)) continue;
+
+        auto& out { g.shards[j] };
+        std::fill(out.begin(), out.end(), 0);
+        for (std::size_t r = 0; r < k; ++r)
+            gf256::mulAdd(out.data(), g.shards[rows[r]].data(), inv[j][r], g.parityBytes);
+    }
+    return true;
+}
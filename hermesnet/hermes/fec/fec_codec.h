@@ -0,0 +1,234 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/message/body.h>
+#include <hermes/fec/gf256.h>
+
+namespace network::fec
+{
+    enum class EFecMode : std::uint8_t
+    {
+        NONE = 0,       // packets go as is
+        XOR,            // one parity packet per group, recovers one loss
+        REED_SOLOMON    // m parity packets per group, recover any m losses
+    };
+
+    constexpr std::size_t MAX_SOURCES   { 16 };
+    constexpr std::size_t MAX_PARITY    { 16 };
+    constexpr std::size_t HEADER_SIZE   { 3 };
+    // shard - source payload with its length byte, parity is as long as the longest one
+    constexpr std::size_t SHARD_BYTES   { message::CAPACITY - HEADER_SIZE };
+    constexpr std::size_t MAX_PAYLOAD   { SHARD_BYTES - 1 };
+
+    /*
+     * Настройка FEC канала: sources пакетов данных в группе и parity
+     * пакетов четности к ним (для XOR всегда 1). Доля трафика на
+     * четность - parity / sources, восстанавливается до parity потерь
+     * в группе без ожидания повторной отправки.
+     */
+    struct FecConfig
+    {
+        EFecMode        mode    { EFecMode::NONE };
+        std::uint8_t    sources { 4 };
+        std::uint8_t    parity  { 1 };
+
+        [[nodiscard]] std::size_t parityCount() const noexcept {
+            return EFecMode::NONE == mode ? 0 : EFecMode::XOR == mode ? 1 : parity;
+        }
+        [[nodiscard]] bool valid() const noexcept {
+            return EFecMode::NONE == mode or (sources >= 1 and sources <= MAX_SOURCES and parityCount() >= 1 and parityCount() <= MAX_PARITY);
+        }
+    };
+
+    /* ------------------ FEC packet ------------------
+     *
+     * [0]  group number
+     * [1]  index: 0..k-1 data, k..k+m-1 parity
+     * [2]  k - 1 (high nibble), m - 1 (low nibble)
+     * [3..] data payload as is, or parity shard
+     *
+     * Parity is computed over shards [length][payload]
+     * padded with zeros to the longest one of the group,
+     * so a recovered packet gets its length back.
+     * Reed-Solomon is systematic with a Cauchy matrix:
+     * parity i = sum of C[i][j] * shard j, any k of
+     * k + m packets restore the group. XOR is the same
+     * with all coefficients 1.
+     * ------------------------------------------------ */
+
+    // Коэффициент пакета данных j в пакете четности i
+    std::uint8_t coefficient(EFecMode mode, std::size_t i, std::size_t j) noexcept;
+
+    /*
+     * Отправка: пакеты данных оборачиваются в заголовок группы, четность
+     * копится по мере добавления (данные группы не хранятся). Когда
+     * группа набрана, parityReady() пакетов четности надо отправить
+     * до следующего protect().
+     */
+    class FecEncoder : boost::noncopyable
+    {
+    private:
+        FecConfig                                                   config_;
+        std::array<std::array<std::uint8_t, SHARD_BYTES>, MAX_PARITY> parity_ {};
+        std::size_t     shardBytes_ { 0 };      // longest shard of the group
+        std::uint8_t    group_      { 0 };
+        std::uint8_t    count_      { 0 };      // data packets in the group so far
+
+    public:
+        explicit FecEncoder(FecConfig config) noexcept;
+
+        // Пакет данных в out (payload + HEADER_SIZE байт), возвращает его размер, 0 - payload велик
+        std::size_t protect(const std::uint8_t* payload, std::size_t size, std::uint8_t* out) noexcept;
+
+        // Пакетов четности готово после последнего protect()
+        [[nodiscard]] std::size_t parityReady() const noexcept;
+        // Пакет четности i в out, возвращает его размер
+        std::size_t parity(std::size_t i, std::uint8_t* out) const noexcept;
+
+        [[nodiscard]] FecConfig const& config() const noexcept { return config_; }
+
+    };  // FecEncoder
+
+    /*
+     * Прием: пакеты данных отдаются сразу, пакеты групп копятся в
+     * нескольких слотах (группы могут перемешаться при доставке).
+     * Как только в группе принято k любых пакетов, недостающие пакеты
+     * данных восстанавливаются и отдаются следом, до приложения.
+     * Каждая позиция группы отдается один раз: повтор и опоздавший
+     * оригинал восстановленного пакета отбрасываются, как и пакеты
+     * давно прошедших групп.
+     */
+    class FecDecoder : boost::noncopyable
+    {
+    private:
+        static constexpr std::size_t GROUPS { 4 };
+        static constexpr std::size_t SHARDS { MAX_SOURCES + MAX_PARITY };
+
+        struct Group
+        {
+            std::array<std::array<std::uint8_t, SHARD_BYTES>, SHARDS>   shards;
+            std::uint32_t   present     { 0 };      // shard bits
+            std::size_t     parityBytes { 0 };
+            std::uint8_t    number      { 0 };
+            std::uint8_t    sources     { 0 };
+            std::uint8_t    parity      { 0 };
+            bool            used        { false };
+            bool            done        { false };  // every data packet is delivered
+        };
+
+        FecConfig                   config_;
+        std::array<Group, GROUPS>   groups_ {};
+        std::uint64_t               recovered_  { 0 };
+        std::uint64_t               lost_       { 0 };  // data packets of groups left incomplete
+
+        // Слот группы пакета, nullptr - группа давно прошла
+        Group* slot(std::uint8_t number, std::uint8_t sources, std::uint8_t parity) noexcept;
+        // Восстановить недостающие пакеты данных, false - принято меньше k
+        bool recover(Group& g) noexcept;
+
+    public:
+        explicit FecDecoder(FecConfig config) noexcept;
+
+        /*
+         * Принять пакет: handler(const std::uint8_t* payload, std::size_t size)
+         * вызывается для пакета данных и для каждого восстановленного.
+         * Возвращает количество отданных пакетов.
+         */
+        template <typename Handler>
+        std::size_t receive(const std::uint8_t* packet, std::size_t size, Handler&& handler) noexcept;
+
+        [[nodiscard]] std::uint64_t recovered() const noexcept { return recovered_; }
+        [[nodiscard]] std::uint64_t lost() const noexcept { return lost_; }
+
+    };  // FecDecoder
+
+}   // network::fec
+
+// ********************************* IMPLEMENTATION **********************************
+
+template <typename Handler>
+std::size_t network::fec::FecDecoder::receive(const std::uint8_t* packet, std::size_t size, Handler&& handler) noexcept
+{
+    if (EFecMode::NONE == config_.mode)
+    {
+        handler(packet, size);
+        return 1;
+    }
+    if (size < HEADER_SIZE or size > HEADER_SIZE + SHARD_BYTES) return 0;
+
+    const std::uint8_t number { packet[0] };
+    const std::uint8_t index { packet[1] };
+    const auto sources { static_cast<std::uint8_t>((packet[2] >> 4) + 1) };
+    const auto parity { static_cast<std::uint8_t>((packet[2] & 0x0f) + 1) };
+    if (sources != config_.sources or parity != config_.parityCount() or index >= sources + parity) return 0;
+
+    const auto payload { packet + HEADER_SIZE };
+    const auto bytes { size - HEADER_SIZE };
+    const bool data { index < sources };
+    if (data and bytes > MAX_PAYLOAD) return 0;
+
+    // delivered positions are marked, recovered ones as well: repeats and late originals are dropped
+    auto g { slot(number, sources, parity) };
+    const auto bit { std::uint32_t(1) << index };
+    if (nullptr == g or (g->present & bit)) return 0;
+
+    if (g->done)
+    {
+        // data packet the recovery could not restore, the group is not kept any more
+        if (not data) return 0;
+        g->present |= bit;
+        handler(payload, bytes);
+        return 1;
+    }
+
+    // shards are kept zero padded, parity of the group tells the padded length
+    auto& shard { g->shards[index] };
+    if (data)
+    {
+        shard[0] = static_cast<std::uint8_t>(bytes);
+        std::copy_n(payload, bytes, shard.data() + 1);
+        std::fill(shard.begin() + 1 + static_cast<std::ptrdiff_t>(bytes), shard.end(), 0);
+    }
+    else
+    {
+        std::copy_n(payload, bytes, shard.data());
+        std::fill(shard.begin() + static_cast<std::ptrdiff_t>(bytes), shard.end(), 0);
+        g->parityBytes = bytes;
+    }
+    g->present |= bit;
+
+    std::size_t delivered { 0 };
+    if (data)
+    {
+        handler(payload, bytes);
+        ++delivered;
+    }
+
+    const std::uint32_t dataBits { (std::uint32_t(1) << sources) - 1 };
+    if (dataBits == (g->present & dataBits))
+    {
+        g->done = true;
+        return delivered;
+    }
+
+    if (not recover(*g)) return delivered;
+
+    for (std::size_t j = 0; j < sources; ++j)
+    {
+        if (g->present & (std::uint32_t(1) << j)) continue;
+
+        auto const& restored { g->shards[j] };
+        if (restored[0] > MAX_PAYLOAD) continue;    // damaged group
+        g->present |= std::uint32_t(1) << j;
+        handler(restored.data() + 1, static_cast<std::size_t>(restored[0]));
+        ++delivered;
+        ++recovered_;
+    }
+    g->done = true;
+    return delivered;
+}
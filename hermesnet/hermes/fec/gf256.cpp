@@ -0,0 +1,177 @@
+#include "gf256.h"
+
+#include <cstring>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define HERMES_X86 1
+#endif
+
+using namespace network::fec;
+using namespace network::fec::gf256;
+
+namespace
+{
+    using byte = std::uint8_t;
+
+    // ----------------------------- table -----------------------------
+
+    // product rows, row c is multiplication by c
+    struct MulTable
+    {
+        std::array<std::array<byte, 256>, 256> rows {};
+
+        constexpr MulTable() noexcept {
+            for (unsigned c = 0; c < 256; ++c)
+                for (unsigned x = 0; x < 256; ++x)
+                    rows[c][x] = gf256::mul(static_cast<byte>(c), static_cast<byte>(x));
+        }
+    };
+
+    constexpr MulTable MUL_TABLE {};
+
+    void tableMulAdd(byte* dst, const byte* src, byte c, std::size_t n) noexcept
+    {
+        if (0 == c) return;
+        if (1 == c)
+        {
+            for (std::size_t i = 0; i < n; ++i) dst[i] ^= src[i];
+            return;
+        }
+
+        auto const& row { MUL_TABLE.rows[c] };
+        for (std::size_t i = 0; i < n; ++i)
+            dst[i] ^= row[src[i]];
+    }
+
+    constexpr Kernels TABLE_KERNELS { tableMulAdd, "table" };
+
+#ifdef HERMES_X86
+
+    // products of c with low and high nibbles, c * x = lo[x & 15] ^ hi[x >> 4]
+    struct NibbleTable
+    {
+        struct alignas(16) Row
+        {
+            byte lo[16] {};
+            byte hi[16] {};
+        };
+        std::array<Row, 256> rows {};
+
+        constexpr NibbleTable() noexcept {
+            for (unsigned c = 0; c < 256; ++c)
+                for (unsigned i = 0; i < 16; ++i)
+                {
+                    rows[c].lo[i] = gf256::mul(static_cast<byte>(c), static_cast<byte>(i));
+                    rows[c].hi[i] = gf256::mul(static_cast<byte>(c), static_cast<byte>(i << 4));
+                }
+        }
+    };
+
+    constexpr NibbleTable NIBBLE_TABLE {};
+
+    // ----------------------------- SSSE3 -----------------------------
+
+#define HERMES_SSSE3 __attribute__((target("ssse3")))
+
+    HERMES_SSSE3 void ssse3MulAdd(byte* dst, const byte* src, byte c, std::size_t n) noexcept
+    {
+        if (0 == c) return;
+
+        auto const& row { NIBBLE_TABLE.rows[c] };
+        const __m128i tlo { _mm_load_si128(reinterpret_cast<const __m128i*>(row.lo)) };
+        const __m128i thi { _mm_load_si128(reinterpret_cast<const __m128i*>(row.hi)) };
+        const __m128i mask { _mm_set1_epi8(0x0f) };
+
+        std::size_t i { 0 };
+        for (; i + 16 <= n; i += 16)
+        {
+            const __m128i s { _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)) };
+            const __m128i d { _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)) };
+            const __m128i l { _mm_shuffle_epi8(tlo, _mm_and_si128(s, mask)) };
+            const __m128i h { _mm_shuffle_epi8(thi, _mm_and_si128(_mm_srli_epi64(s, 4), mask)) };
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, _mm_xor_si128(l, h)));
+        }
+        tableMulAdd(dst + i, src + i, c, n - i);
+    }
+
+#undef HERMES_SSSE3
+
+    constexpr Kernels SSSE3_KERNELS { ssse3MulAdd, "ssse3" };
+
+    // ------------------------------ AVX2 ------------------------------
+
+#define HERMES_AVX2 __attribute__((target("avx2")))
+
+    HERMES_AVX2 void avx2MulAdd(byte* dst, const byte* src, byte c, std::size_t n) noexcept
+    {
+        if (0 == c) return;
+
+        auto const& row { NIBBLE_TABLE.rows[c] };
+        const __m128i lo { _mm_load_si128(reinterpret_cast<const __m128i*>(row.lo)) };
+        const __m128i hi { _mm_load_si128(reinterpret_cast<const __m128i*>(row.hi)) };
+        const __m256i tlo { _mm256_broadcastsi128_si256(lo) };
+        const __m256i thi { _mm256_broadcastsi128_si256(hi) };
+        const __m256i mask { _mm256_set1_epi8(0x0f) };
+
+        std::size_t i { 0 };
+        for (; i + 32 <= n; i += 32)
+        {
+            const __m256i s { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)) };
+            const __m256i d { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(dst + i)) };
+            const __m256i l { _mm256_shuffle_epi8(tlo, _mm256_and_si256(s, mask)) };
+            const __m256i h { _mm256_shuffle_epi8(thi, _mm256_and_si256(_mm256_srli_epi64(s, 4), mask)) };
+            _mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i), _mm256_xor_si256(d, _mm256_xor_si256(l, h)));
+        }
+        // 128 bit tail in VEX encoding, no SSE/AVX transition
+        if (i + 16 <= n)
+        {
+            const __m128i s { _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)) };
+            const __m128i d { _mm_loadu_si128(reinterpret_cast<const __m128i*>(dst + i)) };
+            const __m128i m { _mm256_castsi256_si128(mask) };
+            const __m128i l { _mm_shuffle_epi8(lo, _mm_and_si128(s, m)) };
+            const __m128i h { _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(s, 4), m)) };
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i), _mm_xor_si128(d, _mm_xor_si128(l, h)));
+            i += 16;
+        }
+        tableMulAdd(dst + i, src + i, c, n - i);
+    }
+
+#undef HERMES_AVX2
+
+    constexpr Kernels AVX2_KERNELS { avx2MulAdd, "avx2" };
+
+#endif  // HERMES_X86
+
+    const Kernels* selectKernels() noexcept
+    {
+#ifdef HERMES_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2")) return &AVX2_KERNELS;
+        if (__builtin_cpu_supports("ssse3")) return &SSSE3_KERNELS;
+#endif
+        return &TABLE_KERNELS;
+    }
+}
+
+// constant initialized, upgraded by CPU dispatch during static initialization
+const Kernels* gf256::active { &TABLE_KERNELS };
+
+namespace
+{
+    struct Dispatch
+    {
+        Dispatch() noexcept { gf256::active = selectKernels(); }
+    } dispatch;
+}
+
+const Kernels* gf256::find(const char* name) noexcept
+{
+    if (0 == std::strcmp(name, "table")) return &TABLE_KERNELS;
+#ifdef HERMES_X86
+    __builtin_cpu_init();
+    if (0 == std::strcmp(name, "ssse3") and __builtin_cpu_supports("ssse3")) return &SSSE3_KERNELS;
+    if (0 == std::strcmp(name, "avx2") and __builtin_cpu_supports("avx2")) return &AVX2_KERNELS;
+#endif
+    return nullptr;
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace network::fec::gf256
+{
+    /*
+     * Арифметика поля GF(2^8) (полином x^8 + x^4 + x^3 + x^2 + 1,
+     * 0x11d) для кодов Рида-Соломона. Сложение - XOR, умножение по
+     * таблицам логарифмов. Операции над блоками (dst ^= c * src)
+     * выбираются один раз при запуске по CPUID: AVX2 / SSSE3
+     * (умножение на константу через PSHUFB по двум таблицам
+     * полубайтов) / таблица 256 x 256.
+     */
+
+    struct Tables
+    {
+        std::array<std::uint8_t, 512>   exp {};     // doubled, exp[log a + log b] needs no modulo
+        std::array<std::uint8_t, 256>   log {};
+
+        constexpr Tables() noexcept {
+            unsigned x { 1 };
+            for (unsigned i = 0; i < 255; ++i)
+            {
+                exp[i] = exp[i + 255] = static_cast<std::uint8_t>(x);
+                log[x] = static_cast<std::uint8_t>(i);
+                x <<= 1;
+                if (x & 0x100) x ^= 0x11d;
+            }
+        }
+    };
+
+    inline constexpr Tables TABLES {};
+
+    constexpr std::uint8_t mul(std::uint8_t a, std::uint8_t b) noexcept {
+        return 0 == a or 0 == b ? 0 : TABLES.exp[TABLES.log[a] + TABLES.log[b]];
+    }
+
+    // a != 0
+    constexpr std::uint8_t inv(std::uint8_t a) noexcept { return TABLES.exp[255 - TABLES.log[a]]; }
+
+    struct Kernels
+    {
+        // dst ^= c * src, n bytes
+        using MulAddFn = void (*)(std::uint8_t* dst, const std::uint8_t* src, std::uint8_t c, std::size_t n) noexcept;
+
+        MulAddFn    mulAdd;
+        const char* name;
+    };
+
+    // active kernel set, never null
+    extern const Kernels* active;
+
+    // kernel sets by name: "avx2", "ssse3", "table" (nullptr if not supported by CPU)
+    const Kernels* find(const char* name) noexcept;
+
+    inline void mulAdd(std::uint8_t* dst, const std::uint8_t* src, std::uint8_t c, std::size_t n) noexcept {
+        active->mulAdd(dst, src, c, n);
+    }
+
+}   // network::fec::gf256
@@ -0,0 +1,273 @@
+#include "batch_validator.h"
+
+#include <array>
+#include <cstring>
+
+#include <hermes/message/body.h>
+#include <hermes/message/header.h>
+#include <hermes/message/datagram.h>
+#include <hermes/common/crc32c.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define HERMES_X86 1
+#endif
+
+using namespace network;
+using namespace network::message;
+using namespace network::message::validator;
+
+namespace
+{
+    using byte = std::uint8_t;
+
+    constexpr std::uint32_t KNOWN_FLAGS { wire::FLAG_ENCODE | wire::FLAG_COMPRESS | wire::FLAG_BLOCKS | wire::FLAG_CHECKSUM };
+    constexpr std::uint32_t SEAL_SIZE   { wire::SEQUENCE_SIZE + wire::TAG_SIZE };
+    constexpr std::size_t   SIZE_POS    { wire::HEADER_SIZE };
+    constexpr std::size_t   FLAGS_POS   { wire::HEADER_SIZE - 1 };
+    constexpr std::size_t   NUM_POS     { wire::PAYLOAD_OFFSET + CAPACITY - 2 };
+    constexpr std::size_t   COUNT_POS   { wire::PAYLOAD_OFFSET + CAPACITY - 1 };
+    constexpr std::size_t   END_POS     { types::DATAGRAM_SIZE - 1 };
+
+    static_assert(types::DATAGRAM_SIZE == 64 and END_POS == NUM_POS + 2 and COUNT_POS == NUM_POS + 1);
+
+    // flags allowed by the rules
+    inline std::uint32_t knownFlags(ValidationRules const& rules) noexcept
+    {
+        return rules.sealed ? KNOWN_FLAGS : KNOWN_FLAGS & ~std::uint32_t(wire::FLAG_ENCODE);
+    }
+
+    inline std::uint32_t storedChecksum(const byte* p) noexcept
+    {
+        const auto at { p + wire::checksumPos(p[FLAGS_POS]) };
+        return at[0] | (std::uint32_t(at[1]) << 8) | (std::uint32_t(at[2]) << 16) | (std::uint32_t(at[3]) << 24);
+    }
+
+    // ----------------------------- scalar -----------------------------
+
+    inline std::uint64_t checkOne(const byte* p, std::uint32_t length, std::uint8_t code, ValidationRules const& rules) noexcept
+    {
+        const std::uint32_t action { p[0] | (std::uint32_t(p[1]) << 8) };
+        const std::uint32_t flags { p[FLAGS_POS] };
+        const std::uint32_t blocks { (flags / wire::FLAG_BLOCKS) & 1 };
+        const std::uint32_t sum { (flags / wire::FLAG_CHECKSUM) & 1 };
+        const std::uint32_t sealed { (flags / wire::FLAG_ENCODE) & 1 };
+        const std::uint32_t capacity { static_cast<std::uint32_t>(CAPACITY - wire::BLOCKS_SIZE * blocks - wire::CHECKSUM_SIZE * sum - SEAL_SIZE * sealed) };
+
+        std::uint32_t ok { types::DATAGRAM_SIZE == length };
+        ok &= code == p[types::ACCESS_BYTE_POS];
+        ok &= types::END_MESSAGE_BYTE == p[END_POS];
+        ok &= action < rules.actionCount;
+        ok &= 0 == (flags & ~knownFlags(rules));
+        ok &= p[SIZE_POS] <= capacity;
+        ok &= (blocks ^ 1) | ((p[NUM_POS] >= 1) & (p[NUM_POS] <= p[COUNT_POS]));
+        ok &= sum | static_cast<std::uint32_t>(not rules.checksum);
+        return ok;
+    }
+
+    // clears images of candidates with a wrong crc32c, sizes are already checked
+    std::uint64_t scalarChecksums(const byte* images, std::size_t stride, std::uint64_t mask, std::uint64_t candidates) noexcept
+    {
+        for (; 0 != candidates; candidates &= candidates - 1)
+        {
+            const auto i { static_cast<std::size_t>(__builtin_ctzll(candidates)) };
+            const byte* p { images + i * stride };
+            mask &= ~(std::uint64_t(wire::imageChecksum(p) != storedChecksum(p)) << i);
+        }
+        return mask;
+    }
+
+    inline std::uint64_t checksumFlags(const byte* images, std::size_t stride, std::size_t n) noexcept
+    {
+        std::uint64_t flagged { 0 };
+        for (std::size_t i = 0; i < n; ++i)
+            flagged |= std::uint64_t((images[i * stride + FLAGS_POS] / wire::FLAG_CHECKSUM) & 1) << i;
+        return flagged;
+    }
+
+    std::uint64_t scalarValidate(const byte* images, const std::uint32_t* lengths, const byte* codes, std::size_t n, ValidationRules const& rules,
+                                 std::size_t stride) noexcept
+    {
+        // one shared code is read with a zero step
+        const std::size_t step { nullptr != codes ? std::size_t(1) : 0 };
+        if (nullptr == codes) codes = &rules.accessCode;
+
+        std::uint64_t mask { 0 };
+        for (std::size_t i = 0; i < n; ++i)
+            mask |= checkOne(images + i * stride, lengths[i], codes[i * step], rules) << i;
+        return scalarChecksums(images, stride, mask, mask & checksumFlags(images, stride, n));
+    }
+
+    constexpr Kernels SCALAR_KERNELS { scalarValidate, "scalar" };
+
+#ifdef HERMES_X86
+
+    // ------------------------------ AVX2 ------------------------------
+
+#define HERMES_AVX2 __attribute__((target("avx2,sse4.2")))
+
+    // bytes of the image word kept under crc32c (little endian words), [blocks][word]
+    constexpr std::array<std::array<std::uint64_t, 8>, 2> makeFieldMasks() noexcept
+    {
+        std::array<std::array<std::uint64_t, 8>, 2> masks {};
+        for (std::size_t blocks = 0; blocks < 2; ++blocks)
+        {
+            const auto field { wire::checksumPos(blocks ? wire::FLAG_BLOCKS : 0) };
+            for (std::size_t at = 0; at < types::DATAGRAM_SIZE; ++at)
+                if (at < field or at >= field + wire::CHECKSUM_SIZE)
+                    masks[blocks][at / 8] |= std::uint64_t(0xff) << (8 * (at % 8));
+        }
+        return masks;
+    }
+
+    constexpr auto FIELD_MASKS { makeFieldMasks() };
+
+    // same as wire::imageChecksum, word by word with the crc32 instruction
+    HERMES_AVX2 std::uint64_t sse42Checksums(const byte* images, std::size_t stride, std::uint64_t mask, std::uint64_t candidates) noexcept
+    {
+        constexpr std::size_t TAIL_WORD { types::DATAGRAM_SIZE / 8 - 1 };
+
+        for (; 0 != candidates; candidates &= candidates - 1)
+        {
+            const auto i { static_cast<std::size_t>(__builtin_ctzll(candidates)) };
+            const byte* p { images + i * stride };
+            const auto& keep { FIELD_MASKS[(p[FLAGS_POS] / wire::FLAG_BLOCKS) & 1] };
+            const auto words { wire::checksumWords(p[SIZE_POS]) };
+
+            std::uint64_t state { ~std::uint32_t(0) };
+            std::uint64_t word;
+            for (std::size_t w = 0; w < words; ++w)
+            {
+                std::memcpy(&word, p + w * 8, 8);
+                state = _mm_crc32_u64(state, word & keep[w]);
+            }
+            std::memcpy(&word, p + TAIL_WORD * 8, 8);
+            state = _mm_crc32_u64(state, word & keep[TAIL_WORD]);
+
+            const auto crc { ~static_cast<std::uint32_t>(state) };
+            mask &= ~(std::uint64_t(crc != storedChecksum(p)) << i);
+        }
+        return mask;
+    }
+
+    HERMES_AVX2 std::uint64_t avx2Validate(const byte* images, const std::uint32_t* lengths, const byte* codes, std::size_t n, ValidationRules const& rules,
+                                           std::size_t stride) noexcept
+    {
+        // byte offsets of 8 consecutive images
+        const __m256i offsets { _mm256_mullo_epi32(_mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7), _mm256_set1_epi32(static_cast<int>(stride))) };
+        const __m256i byteMask { _mm256_set1_epi32(0xff) };
+        const __m256i size { _mm256_set1_epi32(types::DATAGRAM_SIZE) };
+        const __m256i access { _mm256_set1_epi32(rules.accessCode) };
+        const __m256i end { _mm256_set1_epi32(types::END_MESSAGE_BYTE) };
+        const __m256i actions { _mm256_set1_epi32(rules.actionCount) };
+        const __m256i unknown { _mm256_set1_epi32(static_cast<int>(~knownFlags(rules) & 0xff)) };
+        const __m256i zero { _mm256_setzero_si256() };
+        const __m256i fullCapacity { _mm256_set1_epi32(CAPACITY + 1) };
+        const __m256i blockFields { _mm256_set1_epi32(wire::BLOCKS_SIZE) };
+        const __m256i sumField { _mm256_set1_epi32(wire::CHECKSUM_SIZE) };
+        const __m256i sealFields { _mm256_set1_epi32(SEAL_SIZE) };
+        const __m256i sumRequired { _mm256_set1_epi32(rules.checksum ? 0 : -1) };
+
+        std::uint64_t flagged { 0 };
+
+        std::uint64_t mask { 0 };
+        std::size_t i { 0 };
+        for (; i + 8 <= n; i += 8)
+        {
+            auto base { reinterpret_cast<const int*>(images + i * stride) };
+            const __m256i head { _mm256_i32gather_epi32(base, offsets, 1) };                                  // action, uuid, access
+            const __m256i info { _mm256_i32gather_epi32(base + 1, offsets, 1) };                              // flags, size
+            const __m256i tail { _mm256_i32gather_epi32(base + (types::DATAGRAM_SIZE / 4 - 1), offsets, 1) }; // num, count, end
+            const __m256i length { _mm256_loadu_si256(reinterpret_cast<const __m256i*>(lengths + i)) };
+            const __m256i expected { nullptr != codes ? _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(codes + i))) : access };
+
+            const __m256i action { _mm256_and_si256(head, _mm256_set1_epi32(0xffff)) };
+            const __m256i code { _mm256_srli_epi32(head, 24) };
+            const __m256i flags { _mm256_and_si256(info, byteMask) };
+            const __m256i payload { _mm256_and_si256(_mm256_srli_epi32(info, 8), byteMask) };
+            const __m256i num { _mm256_and_si256(_mm256_srli_epi32(tail, 8), byteMask) };
+            const __m256i count { _mm256_and_si256(_mm256_srli_epi32(tail, 16), byteMask) };
+            const __m256i marker { _mm256_srli_epi32(tail, 24) };
+
+            // all -1 where a block message
+            const __m256i blocks { _mm256_cmpgt_epi32(_mm256_and_si256(flags, _mm256_set1_epi32(wire::FLAG_BLOCKS)), zero) };
+            const __m256i sums { _mm256_cmpgt_epi32(_mm256_and_si256(flags, _mm256_set1_epi32(wire::FLAG_CHECKSUM)), zero) };
+            const __m256i sealed { _mm256_cmpgt_epi32(_mm256_and_si256(flags, _mm256_set1_epi32(wire::FLAG_ENCODE)), zero) };
+            const __m256i trailer { _mm256_add_epi32(_mm256_add_epi32(_mm256_and_si256(blocks, blockFields), _mm256_and_si256(sums, sumField)),
+                                                     _mm256_and_si256(sealed, sealFields)) };
+            const __m256i capacity { _mm256_sub_epi32(fullCapacity, trailer) };
+
+            __m256i ok { _mm256_cmpeq_epi32(length, size) };
+            ok = _mm256_and_si256(ok, _mm256_cmpeq_epi32(code, expected));
+            ok = _mm256_and_si256(ok, _mm256_cmpeq_epi32(marker, end));
+            ok = _mm256_and_si256(ok, _mm256_cmpgt_epi32(actions, action));
+            ok = _mm256_and_si256(ok, _mm256_cmpeq_epi32(_mm256_and_si256(flags, unknown), zero));
+            ok = _mm256_and_si256(ok, _mm256_cmpgt_epi32(capacity, payload));
+
+            const __m256i numbered { _mm256_andnot_si256(_mm256_cmpgt_epi32(num, count), _mm256_cmpgt_epi32(num, zero)) };
+            ok = _mm256_and_si256(ok, _mm256_or_si256(_mm256_andnot_si256(blocks, _mm256_set1_epi32(-1)), numbered));
+            ok = _mm256_and_si256(ok, _mm256_or_si256(sums, sumRequired));
+
+            mask |= static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(ok))) << i;
+            flagged |= static_cast<std::uint64_t>(_mm256_movemask_ps(_mm256_castsi256_ps(sums))) << i;
+        }
+
+        mask = sse42Checksums(images, stride, mask, mask & flagged);
+        if (i < n) mask |= scalarValidate(images + i * stride, lengths + i, nullptr != codes ? codes + i : nullptr, n - i, rules, stride) << i;
+        return mask;
+    }
+
+#undef HERMES_AVX2
+
+    constexpr Kernels AVX2_KERNELS { avx2Validate, "avx2" };
+
+#endif  // HERMES_X86
+
+    const Kernels* selectKernels() noexcept
+    {
+#ifdef HERMES_X86
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx2") and __builtin_cpu_supports("sse4.2")) return &AVX2_KERNELS;
+#endif
+        return &SCALAR_KERNELS;
+    }
+}
+
+// constant initialized, upgraded by CPU dispatch during static initialization
+const Kernels* validator::active { &SCALAR_KERNELS };
+
+namespace
+{
+    struct Dispatch
+    {
+        Dispatch() noexcept { validator::active = selectKernels(); }
+    } dispatch;
+}
+
+const Kernels* validator::find(const char* name) noexcept
+{
+    if (0 == std::strcmp(name, "scalar")) return &SCALAR_KERNELS;
+#ifdef HERMES_X86
+    __builtin_cpu_init();
+    if (0 == std::strcmp(name, "avx2") and __builtin_cpu_supports("avx2") and __builtin_cpu_supports("sse4.2")) return &AVX2_KERNELS;
+#endif
+    return nullptr;
+}
+
+std::size_t message::compactBatch(std::uint8_t* images, std::uint32_t* lengths, std::size_t n, std::uint64_t valid) noexcept
+{
+    if (n < 64) valid &= (std::uint64_t(1) << n) - 1;
+
+    // leading survivors stay where they are
+    if (~std::uint64_t(0) == valid) return 64;
+    std::size_t kept { static_cast<std::size_t>(__builtin_ctzll(~valid)) };
+    valid &= ~((std::uint64_t(1) << kept) - 1);
+
+    for (; 0 != valid; valid &= valid - 1, ++kept)
+    {
+        const auto from { static_cast<std::size_t>(__builtin_ctzll(valid)) };
+        std::memcpy(images + kept * types::DATAGRAM_SIZE, images + from * types::DATAGRAM_SIZE, types::DATAGRAM_SIZE);
+        lengths[kept] = lengths[from];
+    }
+    return kept;
+}
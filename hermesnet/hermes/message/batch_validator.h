@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include <hermes/common/types.h>
+
+namespace network::message
+{
+
+    /* --------------- Batch validation ---------------
+     *
+     * Checks wire images of received datagrams, laid
+     * out stride bytes apart (DATAGRAM_SIZE packed, or
+     * the ring slots they were received into), before
+     * any of them is unpacked or copied:
+     *   - received length is DATAGRAM_SIZE
+     *   - access code (one for all images or one per
+     *     image, client sockets have their own codes)
+     *     and end marker byte
+     *   - action below the type's action count
+     *   - no unknown flags, encode (sealed) only
+     *     where sessions have keys
+     *   - payload size within capacity
+     *   - 1 <= block number <= block count (blocks)
+     *   - CRC32C of images carrying the field, the
+     *     field may be required by the rules
+     * The result is a bitmask, bit i for image i; no
+     * branches depend on the data in the structural
+     * checks, so junk costs the same as valid traffic.
+     * AVX2 checks 8 images per step with gathers of
+     * the header, size and tail words, checksums are
+     * computed only for images passed them (SSE4.2
+     * crc32 there). The kernel is chosen by CPUID.
+     * ------------------------------------------------ */
+
+    struct ValidationRules
+    {
+        std::uint8_t    accessCode  { types::SERVER_ACCESS_CODE };
+        std::uint16_t   actionCount { 0xffff };     // actions of the message type id
+        bool            checksum    { false };      // images without crc32c are rejected
+        bool            sealed      { false };      // sealed images are accepted (opened later by openBatch)
+    };
+
+    // Action count of the type id: IdType::ACTION_COUNT if declared, else any action passes
+    template <typename IdType, typename = void>
+    struct ActionCount { static constexpr std::uint16_t value { 0xffff }; };
+
+    template <typename IdType>
+    struct ActionCount<IdType, std::void_t<decltype(IdType::ACTION_COUNT)>> { static constexpr std::uint16_t value { IdType::ACTION_COUNT }; };
+
+    template <typename IdType>
+    constexpr ValidationRules rulesFor(std::uint8_t accessCode = types::SERVER_ACCESS_CODE, bool checksum = false, bool sealed = false) noexcept
+    {
+        return { accessCode, ActionCount<IdType>::value, checksum, sealed };
+    }
+
+    namespace validator
+    {
+        static constexpr std::size_t BATCH_MAX { 64 };  // images per call, one mask word
+
+        struct Kernels
+        {
+            using ValidateFn = std::uint64_t (*)(const std::uint8_t* images, const std::uint32_t* lengths, const std::uint8_t* codes,
+                                                 std::size_t n, ValidationRules const& rules, std::size_t stride) noexcept;
+            ValidateFn  validate;
+            const char* name;
+        };
+
+        // active kernel set, never null
+        extern const Kernels* active;
+
+        // kernel sets by name: "avx2" (with SSE4.2), "scalar" (nullptr if not supported by CPU)
+        const Kernels* find(const char* name) noexcept;
+    }
+
+    // Маска корректных образов из n <= BATCH_MAX; codes - код доступа каждого образа (nullptr - rules.accessCode), stride - шаг образов
+    inline std::uint64_t validateBatch(const std::uint8_t* images, const std::uint32_t* lengths, const std::uint8_t* codes,
+                                       std::size_t n, ValidationRules const& rules, std::size_t stride = types::DATAGRAM_SIZE) noexcept
+    {
+        return validator::active->validate(images, lengths, codes, n, rules, stride);
+    }
+
+    // Сдвинуть образы из маски valid к началу с сохранением порядка, возвращает их число
+    std::size_t compactBatch(std::uint8_t* images, std::uint32_t* lengths, std::size_t n, std::uint64_t valid) noexcept;
+
+}   // network::message
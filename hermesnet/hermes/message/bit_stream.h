@@ -0,0 +1,306 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <algorithm>
+
+#include <hermes/message/body.h>
+
+namespace network::message
+{
+
+    /* ---------------- Bit stream ----------------
+     *
+     * Writes and reads values of any bit width
+     * (1..64) packed without gaps. Bits go through
+     * a 64-bit scratch word, which is stored in
+     * little endian byte order once full, so the
+     * stream does the same amount of work per value
+     * regardless of its width.
+     *
+     * Overflow is sticky: writes/reads past the
+     * buffer are dropped (reads return zeros) and
+     * overflow() reports it.
+     *
+     * Bound to a Body the writer appends after its
+     * payload and flush() grows body.size, the
+     * reader reads the payload from the start.
+     *
+     * Compact forms for replicated state:
+     *  - range quantized floats (positions, speeds)
+     *  - varints, 7 bits per byte group (ids, counts)
+     *  - smallest three quaternions: index of the
+     *    largest component in 2 bits and the other
+     *    three quantized, the largest is restored
+     *    from the unit length
+     *  - quantized values against a baseline known
+     *    to both sides: 1 bit if unchanged, 2 bits
+     *    and a short zigzag delta if it fits, else
+     *    2 bits and the whole value
+     * -------------------------------------------- */
+
+    struct Quaternion
+    {
+        float x { 0.0f };
+        float y { 0.0f };
+        float z { 0.0f };
+        float w { 1.0f };
+    };
+
+    namespace bits
+    {
+        // low n bits set, n in [1..64]
+        constexpr std::uint64_t mask(unsigned n) noexcept { return ~std::uint64_t(0) >> (64 - n); }
+
+        // shifts defined for n == 64
+        constexpr std::uint64_t shl(std::uint64_t v, unsigned n) noexcept { return n < 64 ? v << n : 0; }
+        constexpr std::uint64_t shr(std::uint64_t v, unsigned n) noexcept { return n < 64 ? v >> n : 0; }
+
+        inline void storeLE(std::uint8_t* dst, std::uint64_t v, std::size_t n) noexcept
+        {
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            v = __builtin_bswap64(v);
+#endif
+            std::memcpy(dst, &v, n);
+        }
+
+        inline std::uint64_t loadLE(const std::uint8_t* src, std::size_t n) noexcept
+        {
+            std::uint64_t v { 0 };
+            std::memcpy(&v, src, n);
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+            v = __builtin_bswap64(v);
+#endif
+            return v;
+        }
+
+        // float in [min, max] to unsigned of n bits, rounded to nearest
+        inline std::uint64_t quantize(float v, float min, float max, unsigned n) noexcept
+        {
+            const float norm { std::clamp((v - min) / (max - min), 0.0f, 1.0f) };
+            return static_cast<std::uint64_t>(norm * static_cast<float>(mask(n)) + 0.5f);
+        }
+
+        inline float dequantize(std::uint64_t q, float min, float max, unsigned n) noexcept
+        {
+            return min + static_cast<float>(q) / static_cast<float>(mask(n)) * (max - min);
+        }
+
+        // signed to unsigned with small magnitudes kept small
+        constexpr std::uint64_t zigzag(std::int64_t v) noexcept {
+            return (static_cast<std::uint64_t>(v) << 1) ^ static_cast<std::uint64_t>(v >> 63);
+        }
+
+        constexpr std::int64_t unzigzag(std::uint64_t v) noexcept {
+            return static_cast<std::int64_t>(v >> 1) ^ -static_cast<std::int64_t>(v & 1);
+        }
+
+        // bound of the three smallest components of a unit quaternion
+        constexpr float QUATERNION_BOUND { 0.70710678f };  // 1 / sqrt(2)
+    }
+
+    class BitWriter
+    {
+    private:
+        std::uint8_t*   data_;
+        std::size_t     capacity_;              // bytes
+        std::size_t     stored_     { 0 };      // bytes of flushed words
+        std::uint64_t   scratch_    { 0 };
+        unsigned        used_       { 0 };      // bits in scratch [0..63]
+        bool            overflow_   { false };
+        Body*           body_       { nullptr };
+        std::size_t     base_       { 0 };      // body payload size before the stream
+
+        void store(std::size_t n) noexcept {
+            const auto room { std::min(n, capacity_ - std::min(stored_, capacity_)) };
+            bits::storeLE(data_ + std::min(stored_, capacity_), scratch_, room);
+            overflow_ |= room < n;
+            stored_ += n;
+        }
+
+    public:
+        BitWriter(std::uint8_t* data, std::size_t capacity) noexcept
+            : data_(data)
+            , capacity_(capacity)
+        {}
+
+        // Appends to body payload up to capacity (Datagram::capacity()), flush() updates body.size
+        explicit BitWriter(Body& body, std::size_t capacity = CAPACITY) noexcept
+            : data_(body.buf.data() + body.size)
+            , capacity_(std::min(capacity, CAPACITY) - std::min<std::size_t>({ body.size, capacity, CAPACITY }))
+            , body_(&body)
+            , base_(body.size)
+        {}
+
+        // value's low n bits, n in [1..64]
+        void write(std::uint64_t value, unsigned n) noexcept {
+            value &= bits::mask(n);
+            scratch_ |= value << used_;
+            used_ += n;
+            if (used_ >= 64)
+            {
+                store(8);
+                used_ -= 64;
+                // bits of value that did not fit into the stored word
+                scratch_ = bits::shr(value, n - used_);
+            }
+        }
+
+        void writeBool(bool value) noexcept { write(value ? 1 : 0, 1); }
+
+        // float in [min, max] in n bits, precision (max - min) / (2^n - 1)
+        void writeFloat(float value, float min, float max, unsigned n) noexcept {
+            write(bits::quantize(value, min, max, n), n);
+        }
+
+        // 8 bits per 7 bit group, 1..10 groups
+        void writeVarint(std::uint64_t value) noexcept {
+            while (value > 0x7f)
+            {
+                write((value & 0x7f) | 0x80, 8);
+                value >>= 7;
+            }
+            write(value, 8);
+        }
+
+        void writeSignedVarint(std::int64_t value) noexcept { writeVarint(bits::zigzag(value)); }
+
+        // n bit value against baseline, delta of small bits (1..62) or the whole value
+        void writeDelta(std::uint64_t value, std::uint64_t baseline, unsigned n, unsigned small) noexcept {
+            value &= bits::mask(n);
+            const auto delta { bits::zigzag(static_cast<std::int64_t>(value - (baseline & bits::mask(n)))) };
+            if (0 == delta)
+                write(0, 1);
+            else if (delta <= bits::mask(small))
+                write(1 | (delta << 2), 2 + small);
+            else
+            {
+                write(3, 2);
+                write(value, n);
+            }
+        }
+
+        // unit quaternion in 2 + 3 * n bits; q and -q are the same rotation
+        void writeQuaternion(Quaternion const& q, unsigned n) noexcept {
+            const float c[4] { q.x, q.y, q.z, q.w };
+            unsigned largest { 0 };
+            for (unsigned i = 1; i < 4; ++i)
+                if (std::fabs(c[i]) > std::fabs(c[largest])) largest = i;
+
+            const float sign { c[largest] < 0.0f ? -1.0f : 1.0f };
+            write(largest, 2);
+            for (unsigned i = 0; i < 4; ++i)
+                if (i != largest) writeFloat(c[i] * sign, -bits::QUATERNION_BOUND, bits::QUATERNION_BOUND, n);
+        }
+
+        // Store the partial scratch word, returns bytes written
+        std::size_t flush() noexcept {
+            if (0 != used_) store((used_ + 7) / 8);
+            scratch_ = 0;
+            used_ = 0;
+
+            const auto written { std::min(stored_, capacity_) };
+            if (nullptr != body_) body_->size = static_cast<Body::SizeType>(base_ + written);
+            return written;
+        }
+
+        [[nodiscard]] std::size_t bitCount() const noexcept { return stored_ * 8 + used_; }
+        [[nodiscard]] bool overflow() const noexcept { return overflow_ or bitCount() > capacity_ * 8; }
+
+    };  // BitWriter
+
+    class BitReader
+    {
+    private:
+        const std::uint8_t* data_;
+        std::size_t         size_;              // bytes
+        std::size_t         loaded_     { 0 };  // bytes of loaded words
+        std::uint64_t       scratch_    { 0 };
+        unsigned            available_  { 0 };  // bits in scratch [0..63]
+        std::size_t         consumed_   { 0 };  // bits
+
+        std::uint64_t load() noexcept {
+            const auto n { std::min<std::size_t>(8, size_ - std::min(loaded_, size_)) };
+            const auto word { bits::loadLE(data_ + std::min(loaded_, size_), n) };
+            loaded_ += 8;
+            return word;
+        }
+
+    public:
+        BitReader(const std::uint8_t* data, std::size_t size) noexcept
+            : data_(data)
+            , size_(size)
+        {}
+
+        // Reads body payload from its start
+        explicit BitReader(Body const& body) noexcept
+            : data_(body.buf.data())
+            , size_(std::min<std::size_t>(body.size, CAPACITY))
+        {}
+
+        // n bits in [1..64]
+        std::uint64_t read(unsigned n) noexcept {
+            consumed_ += n;
+            if (n <= available_)
+            {
+                const auto value { scratch_ & bits::mask(n) };
+                scratch_ = bits::shr(scratch_, n);
+                available_ -= n;
+                return value;
+            }
+
+            const auto word { load() };
+            const auto value { (scratch_ | bits::shl(word, available_)) & bits::mask(n) };
+            const unsigned taken { n - available_ };
+            scratch_ = bits::shr(word, taken);
+            available_ = 64 - taken;
+            return value;
+        }
+
+        bool readBool() noexcept { return 0 != read(1); }
+
+        float readFloat(float min, float max, unsigned n) noexcept {
+            return bits::dequantize(read(n), min, max, n);
+        }
+
+        std::uint64_t readVarint() noexcept {
+            std::uint64_t value { 0 };
+            for (unsigned shift = 0; shift < 64; shift += 7)
+            {
+                const auto group { read(8) };
+                value |= (group & 0x7f) << shift;
+                if (0 == (group & 0x80)) break;
+            }
+            return value;
+        }
+
+        std::int64_t readSignedVarint() noexcept { return bits::unzigzag(readVarint()); }
+
+        std::uint64_t readDelta(std::uint64_t baseline, unsigned n, unsigned small) noexcept {
+            if (not readBool()) return baseline & bits::mask(n);
+            if (not readBool()) return (baseline + static_cast<std::uint64_t>(bits::unzigzag(read(small)))) & bits::mask(n);
+            return read(n);
+        }
+
+        Quaternion readQuaternion(unsigned n) noexcept {
+            const auto largest { static_cast<unsigned>(read(2)) };
+            float c[4];
+            float sum { 0.0f };
+            for (unsigned i = 0; i < 4; ++i)
+            {
+                if (i == largest) continue;
+                c[i] = readFloat(-bits::QUATERNION_BOUND, bits::QUATERNION_BOUND, n);
+                sum += c[i] * c[i];
+            }
+            c[largest] = std::sqrt(std::max(0.0f, 1.0f - sum));
+            return { c[0], c[1], c[2], c[3] };
+        }
+
+        [[nodiscard]] std::size_t bitCount() const noexcept { return consumed_; }
+        [[nodiscard]] bool overflow() const noexcept { return consumed_ > size_ * 8; }
+
+    };  // BitReader
+
+}   // network::message
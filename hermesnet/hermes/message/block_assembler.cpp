@@ -0,0 +1,90 @@
+#include "block_assembler.h"
+
+#include <utility>
+
+#include <hermes/common/memory.h>
+
+using namespace network::message;
+
+BlockAssembler::~BlockAssembler()
+{
+    release(ready_);
+    release(unpacked_);
+    for (auto& slot : slots_)
+        release(slot.data);
+}
+
+void BlockAssembler::release(std::uint8_t* data) noexcept
+{
+    if (nullptr != data) pool_.deallocate(data, MESSAGE_BYTES);
+}
+
+std::uint8_t* BlockAssembler::slot() noexcept
+{
+    if (nullptr == unpacked_) unpacked_ = static_cast<std::uint8_t*>(pool_.allocate(MESSAGE_BYTES));
+    return unpacked_;
+}
+
+BlockAssembler::Slot& BlockAssembler::find(std::uint8_t uuid, std::uint8_t count) noexcept
+{
+    Slot* oldest { &slots_.front() };
+    Slot* vacant { nullptr };
+    for (auto& slot : slots_)
+    {
+        if (nullptr == slot.data)
+        {
+            if (nullptr == vacant) vacant = &slot;
+            continue;
+        }
+        if (uuid == slot.uuid)
+        {
+            // same uuid with another block count is a new message
+            if (count == slot.count) return slot;
+            vacant = &slot;
+            break;
+        }
+        if (slot.started < oldest->started or nullptr == oldest->data) oldest = &slot;
+    }
+
+    // all slots busy: the oldest unfinished message gives way
+    Slot& slot { nullptr != vacant ? *vacant : *oldest };
+    if (nullptr != slot.data) ++dropped_;
+    else slot.data = static_cast<std::uint8_t*>(pool_.allocate(MESSAGE_BYTES));
+
+    slot.received.fill(0);
+    slot.size = 0;
+    slot.started = starts_++;
+    slot.uuid = uuid;
+    slot.count = count;
+    slot.got = 0;
+    return slot;
+}
+
+bool BlockAssembler::add(std::uint8_t uuid, std::uint8_t num, std::uint8_t count, const std::uint8_t* payload, std::size_t size) noexcept
+{
+    if (0 == num or num > count or size > BLOCK_PAYLOAD) return false;
+    // only the last block may be short
+    if (num != count and BLOCK_PAYLOAD != size) return false;
+
+    // the previous message has been read by now
+    release(std::exchange(ready_, nullptr));
+    size_ = 0;
+
+    auto& slot { find(uuid, count) };
+
+    const std::size_t index { num - 1u };
+    auto& word { slot.received[index >> 6] };
+    const auto bit { std::uint64_t(1) << (index & 63) };
+    if (word & bit) return false;   // duplicate
+
+    word |= bit;
+    memory::memcpy(slot.data + index * BLOCK_PAYLOAD, payload, size);
+    if (num == count) slot.size = index * BLOCK_PAYLOAD + size;
+
+    if (++slot.got != slot.count) return false;
+
+    // the block is handed over with the message and the slot is free again
+    ready_ = std::exchange(slot.data, nullptr);
+    size_ = slot.size;
+    return true;
+}
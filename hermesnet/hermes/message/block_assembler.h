@@ -0,0 +1,85 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/message/body.h>
+#include <hermes/message/header.h>
+#include <hermes/common/arena.h>
+
+namespace network::message
+{
+
+    /* ------------ Multi block message assembler -----------
+     *
+     * Collects payloads of a multi block message (blocks
+     * share the header uuid, numbered 1..count) into one
+     * continuous buffer. Blocks may come in any order and
+     * up to SLOTS messages of different uuids may be in
+     * progress at once (e.g. a snapshot stream and a
+     * service message); a new message with all slots busy
+     * drops the oldest unfinished one. Every block but the
+     * last carries a full payload (CAPACITY - BLOCKS_SIZE
+     * bytes).
+     *
+     * Message buffers (255 blocks, ~14 KB each) are blocks
+     * of a slab pool made at construction, taken when a
+     * message starts and returned after it is read, so
+     * add() does not allocate. One more block is kept as
+     * the receive slot of unpacked (decompressed)
+     * messages, see slot().
+     * ------------------------------------------------------ */
+
+    class BlockAssembler : boost::noncopyable
+    {
+    public:
+        static constexpr std::size_t BLOCK_PAYLOAD { CAPACITY - wire::BLOCKS_SIZE };
+        static constexpr std::size_t MAX_BLOCKS    { 255 };
+        static constexpr std::size_t MESSAGE_BYTES { MAX_BLOCKS * BLOCK_PAYLOAD };
+        static constexpr std::size_t SLOTS         { 4 };
+
+    private:
+        // message in progress
+        struct Slot
+        {
+            std::uint8_t*                   data        { nullptr };    // pool block, nullptr - slot is free
+            std::array<std::uint64_t, 4>    received    {};             // block bits
+            std::size_t                     size        { 0 };          // payload size once the last block is in
+            std::uint64_t                   started     { 0 };          // order of start, the oldest is dropped first
+            std::uint8_t                    uuid        { 0 };
+            std::uint8_t                    count       { 0 };
+            std::uint8_t                    got         { 0 };
+        };
+
+        memory::SlabPool                pool_       { MESSAGE_BYTES, SLOTS + 1 };
+        std::array<Slot, SLOTS>         slots_      {};
+        std::uint8_t*                   ready_      { nullptr };    // completed message, returned to the pool by the next add()
+        std::uint8_t*                   unpacked_   { nullptr };    // receive slot of unpacked messages, taken once
+        std::size_t                     size_       { 0 };
+        std::uint64_t                   starts_     { 0 };
+        std::uint64_t                   dropped_    { 0 };          // unfinished messages replaced by newer ones
+
+        // Слот сообщения uuid из count блоков, новый при необходимости
+        Slot& find(std::uint8_t uuid, std::uint8_t count) noexcept;
+        void release(std::uint8_t* data) noexcept;
+
+    public:
+        BlockAssembler() = default;
+        ~BlockAssembler();
+
+        // Добавить блок; true - сообщение собрано, data()/size() до следующего add()
+        bool add(std::uint8_t uuid, std::uint8_t num, std::uint8_t count, const std::uint8_t* payload, std::size_t size) noexcept;
+
+        // Слот приема распакованного сообщения (MESSAGE_BYTES байт), не пересекается с data()
+        std::uint8_t* slot() noexcept;
+
+        [[nodiscard]] const std::uint8_t* data() const noexcept { return ready_; }
+        [[nodiscard]] std::size_t size() const noexcept { return size_; }
+        [[nodiscard]] std::uint64_t dropped() const noexcept { return dropped_; }
+
+    };  // BlockAssembler
+
+}   // network::message
@@ -4,23 +4,29 @@
 #include <array>
 #include <cassert>
 #include <cstdint>
+#include <cstddef>
+#include <iomanip>
 #include <iostream>
 #include <iterator>
 #include <algorithm>
+#include <type_traits>
 
 #include <hermes/common/memory.h>
 
 namespace network::message
 {
-    static constexpr std::size_t CAPACITY { 51 };   // размер полезной нагрузки
+    static constexpr std::size_t CAPACITY { 57 };   // размер полезной нагрузки
 
     /* ------------- Net message body ------------
      *
      * Contains payload size and continuous buffer
-     * for it. Payload limit for one msg is 51 byte,
-     * last byte should be marked 0xff as finish flag.
+     * for it. Payload limit for one msg is 57 byte
+     * (55 for multi block messages, block fields
+     * are sent in the last two bytes), last byte
+     * should be marked 0xff as finish flag.
      *
-     * Structure size - 54 bytes
+     * Structure size - 60 bytes
+     * Part of the Datagram raw bytes, see Datagram.
      * ------------------------------------------- */
 
     struct Body
@@ -30,18 +36,9 @@ namespace network::message
 
         // ------------------------------------------------------------
         SizeType    size { 0 }; // current payload size      [2 bytes]
-        BufferType  buf  { 0 }; // raw bytes                 [52 bytes]
+        BufferType  buf  { 0 }; // raw bytes                 [58 bytes]
         // ------------------------------------------------------------
 
-        Body() = default;
-        ~Body() = default;
-        // noncopyable
-        Body(Body const&) = delete;
-        Body& operator= (Body const&) = delete;
-        // move semantic
-        Body(Body&&) noexcept;
-        Body& operator= (Body&&) noexcept;
-
         friend std::ostream& operator<< (std::ostream& os, Body const& b);
 
         /* Read/Write operation result
@@ -54,33 +51,26 @@ namespace network::message
 
         template <typename Data>
         inline ReadRes read(Data& dst, std::size_t n) noexcept;
+        // capacity - payload limit of the wire image (Datagram::capacity()), fails past it
         template <typename Data>
-        inline WriteRes write(Data& src, std::size_t n) noexcept;
-
-        void swap(Body& b) noexcept;
+        inline WriteRes write(Data& src, std::size_t n, std::size_t capacity = CAPACITY) noexcept;
 
     };  // Body
 
-    // ********************************* IMPLEMENTATION **********************************
-
-    Body::Body(Body &&other) noexcept
-    {
-        this != &other ? this->swap(other) : void(0);
-    }
+    static_assert(std::is_trivially_copyable_v<Body> and std::is_standard_layout_v<Body>);
+    static_assert(sizeof(Body) == 60 and alignof(Body) == 2);
+    static_assert(offsetof(Body, size) == 0 and offsetof(Body, buf) == 2);
 
-    Body& Body::operator= (Body &&other) noexcept
-    {
-        this != &other ? this->swap(other) : void(0);
-        return *this;
-    }
+    // ********************************* IMPLEMENTATION **********************************
 
     template <typename Data>
-    inline Body::Body::WriteRes Body::write(Data &src, std::size_t n) noexcept
+    inline Body::Body::WriteRes Body::write(Data &src, std::size_t n, std::size_t capacity) noexcept
     {
-        std::size_t free { CAPACITY - size };
-        assert(n <= free);
+        assert(capacity <= CAPACITY);
+        std::size_t free { capacity - std::min<std::size_t>(size, capacity) };
+        if (n > free) return { false, 0, free };
 
-        memory::memcpy(&buf + size, &src, n);
+        memory::memcpy(buf.data() + size, &src, n);
         size += n;
         free -= n;
 
@@ -92,13 +82,13 @@ namespace network::message
     {
         assert(n <= size);
 
-        memory::memcpy(&dst, &buf + size - n, n);
+        memory::memcpy(&dst, buf.data() + size - n, n);
         size -= n;
 
         return { true, n, (CAPACITY - size) };
     }
 
-    std::ostream& operator<< (std::ostream& os, Body const& b) {
+    inline std::ostream& operator<< (std::ostream& os, Body const& b) {
 
         auto asHex = [&os](std::uint8_t b) -> void {
             os  << "0x" << std::hex << std::setw(2) << std::setfill('0')
@@ -113,10 +103,4 @@ namespace network::message
         return os;
     }
 
-    void Body::swap(Body &b) noexcept
-    {
-        std::swap(size, b.size);
-        std::swap(buf, b.buf);
-    }
-
 }   // network::message
@@ -4,7 +4,14 @@
 #include "header.h"
 #include "body.h"
 
+#include <array>
+#include <cstddef>
 #include <utility>
+#include <algorithm>
+#include <type_traits>
+
+#include <hermes/common/types.h>
+#include <hermes/common/crc32c.h>
 
 namespace network::message
 {
@@ -16,31 +23,108 @@ namespace network::message
      * Uses continuous buffer with constant size
      * for DOD (SoA) features.
      *
-     * Structure size - 64 bytes
+     * Structure size - 70 bytes (in memory)
+     * Trivially copyable with its header and
+     * body: stored in rings and shard queues,
+     * moved and copied as raw bytes (no custom
+     * copy/move operations), see checkLayout().
+     *
+     * Wire size - 64 bytes:
+     *   [0..4]  packed header
+     *   [5]     payload size
+     *   [6..62] payload, last two bytes are
+     *           block number and count for
+     *           multi block messages, CRC32C
+     *           (little endian) right before
+     *           them when encoded with it
+     *           (checksum flag), then sequence
+     *           number and tag of sealed
+     *           messages (encode flag)
+     *   [63]    finish flag
+     * CRC32C covers 8-byte words of the image
+     * with header, size and payload, then the
+     * tail word (block fields, finish flag);
+     * the crc field itself reads as zero. So
+     * short messages are checked in a few
+     * crc32 steps without byte tails.
+     * The wire image is received at WIRE_OFFSET,
+     * so the payload lands right in the body
+     * buffer and only 6 bytes are unpacked.
      * ------------------------------------ */
 
+    namespace wire
+    {
+        static constexpr std::size_t PAYLOAD_OFFSET { HEADER_SIZE + 1 };
+
+        // Payload limit of the wire image with given flags
+        constexpr std::size_t capacity(std::uint8_t flags) noexcept {
+            return CAPACITY - ((flags & FLAG_BLOCKS) ? BLOCKS_SIZE : 0) - ((flags & FLAG_CHECKSUM) ? CHECKSUM_SIZE : 0)
+                            - ((flags & FLAG_ENCODE) ? SEQUENCE_SIZE + TAG_SIZE : 0);
+        }
+
+        // Start of the crc32c field in the wire image with given flags
+        constexpr std::size_t checksumPos(std::uint8_t flags) noexcept {
+            return PAYLOAD_OFFSET + CAPACITY - CHECKSUM_SIZE - ((flags & FLAG_BLOCKS) ? BLOCKS_SIZE : 0);
+        }
+
+        // Start of the sequence field of the sealed image, the tag is right before it
+        constexpr std::size_t sequencePos(std::uint8_t flags) noexcept {
+            return checksumPos(flags) + ((flags & FLAG_CHECKSUM) ? 0 : CHECKSUM_SIZE) - SEQUENCE_SIZE;
+        }
+
+        constexpr std::size_t tagPos(std::uint8_t flags) noexcept {
+            return sequencePos(flags) - TAG_SIZE;
+        }
+
+        // Words of the image before the tail word under crc32c for the payload size
+        constexpr std::size_t checksumWords(std::size_t size) noexcept {
+            return std::min<std::size_t>((PAYLOAD_OFFSET + size + 7) / 8, types::DATAGRAM_SIZE / 8 - 1);
+        }
+
+        // CRC32C of the wire image, payload size must be within capacity
+        inline std::uint32_t imageChecksum(const std::uint8_t* image) noexcept {
+            constexpr std::size_t TAIL { types::DATAGRAM_SIZE - 8 };
+            const auto words { checksumWords(image[HEADER_SIZE]) };
+            const auto field { checksumPos(image[HEADER_SIZE - 1]) };
+
+            std::array<std::uint8_t, types::DATAGRAM_SIZE> covered;
+            std::copy_n(image, words * 8, covered.data());
+            std::copy_n(image + TAIL, 8, covered.data() + words * 8);
+            for (auto at { field }; at < field + CHECKSUM_SIZE; ++at)
+            {
+                if (at < words * 8) covered[at] = 0;
+                if (at >= TAIL) covered[words * 8 + at - TAIL] = 0;
+            }
+            return checksum::crc32c(covered.data(), words * 8 + 8);
+        }
+
+        // Write the crc32c field of the image with the checksum flag
+        inline void storeChecksum(std::uint8_t* image) noexcept {
+            const auto crc { imageChecksum(image) };
+            const auto at { image + checksumPos(image[HEADER_SIZE - 1]) };
+            for (std::size_t i = 0; i < CHECKSUM_SIZE; ++i)
+                at[i] = static_cast<std::uint8_t>(crc >> (8 * i));
+        }
+    }
+
     template <typename IdType>
     class Datagram
     {
     private:
         // ---------------------------------------------------
         Header<IdType>  header_ {};              // [10 bytes]
-        Body            body_   {};              // [54 bytes]
+        Body            body_   {};              // [60 bytes]
         // ---------------------------------------------------
 
         using BufferType = Body::BufferType;
         using SizeType   = Body::SizeType;
 
     public:
+        // start of the wire image inside the datagram
+        static constexpr std::size_t WIRE_OFFSET { sizeof(Header<IdType>) + offsetof(Body, buf) - wire::PAYLOAD_OFFSET };
+
         Datagram() = default;
-        explicit Datagram(Header<IdType>&& h, Body&& b) noexcept;
-        ~Datagram() = default;
-        // noncopyable
-        Datagram(Datagram const&) = delete;
-        Datagram& operator= (Datagram const&) = delete;
-        // move semantic
-        Datagram(Datagram&& ) noexcept;
-        Datagram& operator= (Datagram&& ) noexcept;
+        explicit Datagram(Header<IdType> const& h, Body const& b) noexcept;
 
         template <class U>
         friend std::ostream& operator<< (std::ostream& os, Datagram& d);
@@ -50,37 +134,104 @@ namespace network::message
         Body& BodyRef();
         BufferType& Data();
         SizeType getDataSize() const;
+        // Payload limit for current header (block fields, sealing), with crc32c field or not
+        [[nodiscard]] std::size_t capacity(bool checksum = false) const noexcept;
+
+        // Write the wire image (types::DATAGRAM_SIZE bytes) with crc32c if asked, false if payload exceeds capacity(checksum);
+        // images of encode headers are plaintext until sealBatch (datagram_cipher.h)
+        bool encode(std::uint8_t* out, bool checksum = false) const noexcept;
+        // Read the wire image of n bytes
+        bool decode(const std::uint8_t* in, std::size_t n) noexcept;
 
-        void swap(Datagram&) noexcept;
+        // Receive buffer for the wire image (types::DATAGRAM_SIZE bytes)
+        std::uint8_t* wireBuffer() noexcept;
+        // Unpack the wire image received into wireBuffer(), payload stays in place
+        bool decodeInPlace() noexcept;
+
+        // Compile time wire layout check, use as static_assert(Datagram<T>::checkLayout())
+        static constexpr bool checkLayout() noexcept;
 
     };  // Datagram
 
     // ********************************* IMPLEMENTATION **********************************
 
     template <typename IdType>
-    Datagram<IdType>::Datagram(Header<IdType>&& h, Body&& b) noexcept
-        : header_(std::forward<decltype(h)>(h))
-        , body_(std::forward<decltype(b)>(b))
+    Datagram<IdType>::Datagram(Header<IdType> const& h, Body const& b) noexcept
+        : header_(h)
+        , body_(b)
     {}
 
     template <typename IdType>
-    Datagram<IdType>::Datagram(Datagram&& other) noexcept
+    constexpr bool Datagram<IdType>::checkLayout() noexcept
+    {
+        static_assert(Header<IdType>::checkLayout());
+        static_assert(std::is_trivially_copyable_v<Datagram> and std::is_standard_layout_v<Datagram>);
+        static_assert(sizeof(Datagram) == WIRE_OFFSET + types::DATAGRAM_SIZE and alignof(Datagram) == 2);
+        static_assert(offsetof(Datagram, header_) == 0 and offsetof(Datagram, body_) == sizeof(Header<IdType>));
+        static_assert(wire::PAYLOAD_OFFSET + CAPACITY + 1 == types::DATAGRAM_SIZE);
+        static_assert(types::END_MESSAGE_BYTE_POS == CAPACITY and types::ACCESS_BYTE_POS == 3);
+        static_assert(wire::tagPos(0xff) >= wire::PAYLOAD_OFFSET + wire::capacity(0xff));
+        return true;
+    }
+
+    template <typename IdType>
+    std::size_t Datagram<IdType>::capacity(bool checksum) const noexcept
     {
-        this != &other ? this->swap(other) : void(0);
+        return wire::capacity((header_.isSingleBlock() ? 0 : wire::FLAG_BLOCKS) | (header_.encode ? wire::FLAG_ENCODE : 0)
+                              | (checksum ? wire::FLAG_CHECKSUM : 0));
     }
 
     template <typename IdType>
-    Datagram<IdType>& Datagram<IdType>::operator= (Datagram&& other) noexcept
+    bool Datagram<IdType>::encode(std::uint8_t* out, bool checksum) const noexcept
     {
-        this != &other ? this->swap(other) : void(0);
-        return *this;
+        if (body_.size > capacity(checksum)) return false;
+
+        encodeHeader(header_, out);
+        if (checksum) out[wire::HEADER_SIZE - 1] |= wire::FLAG_CHECKSUM;
+        out[wire::HEADER_SIZE] = static_cast<std::uint8_t>(body_.size);
+        memory::memcpy(out + wire::PAYLOAD_OFFSET, body_.buf.data(), body_.buf.size());
+
+        if (not header_.isSingleBlock())
+        {
+            out[wire::PAYLOAD_OFFSET + CAPACITY - 2] = header_.block_num;
+            out[wire::PAYLOAD_OFFSET + CAPACITY - 1] = header_.block_count;
+        }
+
+        if (checksum) wire::storeChecksum(out);
+        return true;
     }
 
     template <typename IdType>
-    void Datagram<IdType>::swap(Datagram &d) noexcept
+    bool Datagram<IdType>::decode(const std::uint8_t* in, std::size_t n) noexcept
     {
-        std::swap(header_, d.header_);
-        std::swap(body_, d.body_);
+        if (types::DATAGRAM_SIZE != n) return false;
+
+        memory::memcpy(wireBuffer(), in, n);
+        return decodeInPlace();
+    }
+
+    template <typename IdType>
+    std::uint8_t* Datagram<IdType>::wireBuffer() noexcept
+    {
+        return reinterpret_cast<std::uint8_t*>(this) + WIRE_OFFSET;
+    }
+
+    template <typename IdType>
+    bool Datagram<IdType>::decodeInPlace() noexcept
+    {
+        // the packed prefix overlaps header and size fields, copy it out first
+        std::array<std::uint8_t, wire::PAYLOAD_OFFSET> prefix;
+        std::copy_n(wireBuffer(), prefix.size(), prefix.data());
+
+        header_ = decodeHeader<IdType>(prefix.data());
+        body_.size = prefix[wire::HEADER_SIZE];
+
+        if (prefix[wire::HEADER_SIZE - 1] & wire::FLAG_BLOCKS)
+        {
+            header_.block_num = body_.buf[CAPACITY - 2];
+            header_.block_count = body_.buf[CAPACITY - 1];
+        }
+        return body_.size <= wire::capacity(prefix[wire::HEADER_SIZE - 1]);
     }
 
     template <class IdType>
@@ -0,0 +1,218 @@
+#include "datagram_cipher.h"
+
+#include <array>
+#include <cstring>
+
+#include <hermes/message/body.h>
+#include <hermes/message/header.h>
+#include <hermes/message/datagram.h>
+
+using namespace network;
+using namespace network::message;
+
+namespace
+{
+    using byte = std::uint8_t;
+
+    constexpr std::size_t GROUP     { 4 };      // images per keystream call, 2 blocks each
+    constexpr std::size_t SIZE_POS  { wire::HEADER_SIZE };
+    constexpr std::size_t FLAGS_POS { wire::HEADER_SIZE - 1 };
+    constexpr std::size_t NUM_POS   { wire::PAYLOAD_OFFSET + CAPACITY - 2 };
+    constexpr std::size_t AAD_MAX   { wire::PAYLOAD_OFFSET + wire::BLOCKS_SIZE };
+
+    // one keystream block covers the largest sealed payload
+    static_assert(wire::capacity(wire::FLAG_ENCODE) <= crypto::BLOCK_SIZE);
+
+    constexpr std::array<byte, 4> KDF_LABEL { 'h', 'r', 'm', 's' };
+
+    inline std::uint32_t load32(const byte* p) noexcept
+    {
+        return p[0] | (std::uint32_t(p[1]) << 8) | (std::uint32_t(p[2]) << 16) | (std::uint32_t(p[3]) << 24);
+    }
+
+    inline void store32(byte* p, std::uint32_t v) noexcept
+    {
+        for (std::size_t i = 0; i < 4; ++i)
+            p[i] = static_cast<byte>(v >> (8 * i));
+    }
+
+    // 32-bit zero constant and the datagram number, little endian
+    inline crypto::Nonce nonce(std::uint64_t sequence) noexcept
+    {
+        crypto::Nonce n {};
+        store32(n.data() + 4, static_cast<std::uint32_t>(sequence));
+        store32(n.data() + 8, static_cast<std::uint32_t>(sequence >> 32));
+        return n;
+    }
+
+    // header and size bytes, block fields when present
+    inline std::size_t associated(const byte* p, byte* aad) noexcept
+    {
+        std::memcpy(aad, p, wire::PAYLOAD_OFFSET);
+        if (0 == (p[FLAGS_POS] & wire::FLAG_BLOCKS)) return wire::PAYLOAD_OFFSET;
+
+        aad[wire::PAYLOAD_OFFSET] = p[NUM_POS];
+        aad[wire::PAYLOAD_OFFSET + 1] = p[NUM_POS + 1];
+        return AAD_MAX;
+    }
+
+    /*
+     * Keystreams of up to GROUP images: block 0 gives the Poly1305
+     * key, block 1 encrypts the payload. The tags of the group are
+     * computed by one kernel call as well.
+     */
+    struct Keystreams
+    {
+        crypto::BlockInput  inputs[2 * GROUP];
+        byte                stream[2 * GROUP * crypto::BLOCK_SIZE];
+        crypto::MacInput    macs[GROUP];
+        byte                aad[GROUP][AAD_MAX];
+        std::size_t         count   { 0 };
+
+        void add(crypto::Key const& key, std::uint64_t sequence) noexcept {
+            const auto n { nonce(sequence) };
+            inputs[2 * count] = crypto::blockInput(key.data(), 0, n.data());
+            inputs[2 * count + 1] = inputs[2 * count];
+            inputs[2 * count + 1][12] = 1;
+            ++count;
+        }
+
+        void compute() noexcept { crypto::active->blocks(inputs, 2 * count, stream); }
+
+        [[nodiscard]] const byte* payload(std::size_t j) const noexcept { return stream + (2 * j + 1) * crypto::BLOCK_SIZE; }
+
+        // MAC of the sealed image p into tag
+        void authenticate(std::size_t j, const byte* p, byte* tag) noexcept {
+            macs[j] = { stream + 2 * j * crypto::BLOCK_SIZE, aad[j], associated(p, aad[j]), p + wire::PAYLOAD_OFFSET, p[SIZE_POS], tag };
+        }
+
+        void tags() noexcept { crypto::active->mac(macs, count); }
+    };
+
+    inline void xorPayload(byte* p, const byte* stream) noexcept
+    {
+        const std::size_t size { p[SIZE_POS] };
+        for (std::size_t i = 0; i < size; ++i)
+            p[wire::PAYLOAD_OFFSET + i] ^= stream[i];
+    }
+
+    inline std::size_t owner(const std::uint32_t* owners, std::size_t i) noexcept
+    {
+        return nullptr != owners ? owners[i] : 0;
+    }
+}
+
+SessionKeys message::deriveSessionKeys(crypto::Key const& secret, std::uint64_t salt, bool server) noexcept
+{
+    // one keystream block as a PRF of the secret: client to server key, then server to client
+    crypto::Nonce n { nonce(salt) };
+    std::memcpy(n.data(), KDF_LABEL.data(), KDF_LABEL.size());
+
+    const auto input { crypto::blockInput(secret.data(), 0, n.data()) };
+    byte block[crypto::BLOCK_SIZE];
+    crypto::active->blocks(&input, 1, block);
+
+    SessionKeys keys;
+    std::memcpy(keys.send.data(), block + (server ? crypto::KEY_SIZE : 0), crypto::KEY_SIZE);
+    std::memcpy(keys.receive.data(), block + (server ? 0 : crypto::KEY_SIZE), crypto::KEY_SIZE);
+    return keys;
+}
+
+std::uint64_t message::sealedImages(const std::uint8_t* images, std::size_t n) noexcept
+{
+    std::uint64_t sealed { 0 };
+    for (std::size_t i = 0; i < n; ++i)
+        sealed |= std::uint64_t((images[i * types::DATAGRAM_SIZE + FLAGS_POS] / wire::FLAG_ENCODE) & 1) << i;
+    return sealed;
+}
+
+void message::sealBatch(std::uint8_t* images, std::size_t n, std::uint64_t sealed,
+                        crypto::Key const* keys, const std::uint32_t* owners, const std::uint64_t* sequences) noexcept
+{
+    if (n < 64) sealed &= (std::uint64_t(1) << n) - 1;
+
+    while (0 != sealed)
+    {
+        std::size_t index[GROUP];
+        Keystreams ks;
+        for (; 0 != sealed and ks.count < GROUP; sealed &= sealed - 1)
+        {
+            const auto i { static_cast<std::size_t>(__builtin_ctzll(sealed)) };
+            index[ks.count] = i;
+            ks.add(keys[owner(owners, i)], sequences[i]);
+        }
+        ks.compute();
+
+        for (std::size_t j = 0; j < ks.count; ++j)
+        {
+            byte* p { images + index[j] * types::DATAGRAM_SIZE };
+            const byte flags { p[FLAGS_POS] };
+            const std::size_t size { p[SIZE_POS] };
+            const auto tag { wire::tagPos(flags) };
+
+            // stale body bytes past the payload must not leave in clear
+            xorPayload(p, ks.payload(j));
+            std::memset(p + wire::PAYLOAD_OFFSET + size, 0, tag - wire::PAYLOAD_OFFSET - size);
+            store32(p + wire::sequencePos(flags), static_cast<std::uint32_t>(sequences[index[j]]));
+            ks.authenticate(j, p, p + tag);
+        }
+        ks.tags();
+
+        for (std::size_t j = 0; j < ks.count; ++j)
+        {
+            byte* p { images + index[j] * types::DATAGRAM_SIZE };
+            if (p[FLAGS_POS] & wire::FLAG_CHECKSUM) wire::storeChecksum(p);
+        }
+    }
+}
+
+std::uint64_t message::openBatch(std::uint8_t* images, std::size_t n, std::uint64_t sealed, crypto::Key const* keys,
+                                 const std::uint32_t* owners, const std::uint64_t* highest, std::uint64_t* sequences) noexcept
+{
+    if (n < 64) sealed &= (std::uint64_t(1) << n) - 1;
+
+    std::uint64_t authentic { 0 };
+    while (0 != sealed)
+    {
+        std::size_t index[GROUP];
+        Keystreams ks;
+        for (; 0 != sealed and ks.count < GROUP; sealed &= sealed - 1)
+        {
+            const auto i { static_cast<std::size_t>(__builtin_ctzll(sealed)) };
+            const byte* p { images + i * types::DATAGRAM_SIZE };
+            const auto from { owner(owners, i) };
+
+            sequences[i] = wire::expandSequence(load32(p + wire::sequencePos(p[FLAGS_POS])), highest[from]);
+            index[ks.count] = i;
+            ks.add(keys[from], sequences[i]);
+        }
+        ks.compute();
+
+        crypto::Tag tags[GROUP];
+        for (std::size_t j = 0; j < ks.count; ++j)
+            ks.authenticate(j, images + index[j] * types::DATAGRAM_SIZE, tags[j].data());
+        ks.tags();
+
+        for (std::size_t j = 0; j < ks.count; ++j)
+        {
+            byte* p { images + index[j] * types::DATAGRAM_SIZE };
+            if (not crypto::equal(tags[j].data(), p + wire::tagPos(p[FLAGS_POS]), crypto::TAG_SIZE)) continue;
+
+            xorPayload(p, ks.payload(j));
+            authentic |= std::uint64_t(1) << index[j];
+        }
+    }
+    return authentic;
+}
+
+std::uint64_t message::acceptBatch(std::uint64_t authentic, const std::uint32_t* owners, const std::uint64_t* sequences,
+                                   std::uint64_t* highest, std::uint64_t* windows) noexcept
+{
+    for (auto m { authentic }; 0 != m; m &= m - 1)
+    {
+        const auto i { static_cast<std::size_t>(__builtin_ctzll(m)) };
+        const auto from { owner(owners, i) };
+        authentic &= ~(std::uint64_t(not acceptSequence(sequences[i], highest[from], windows[from])) << i);
+    }
+    return authentic;
+}
@@ -0,0 +1,98 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <hermes/crypto/chacha20_poly1305.h>
+
+namespace network::message
+{
+
+    /* --------------- Datagram sealing ---------------
+     *
+     * Authenticated encryption of wire images with the
+     * encode flag, ChaCha20-Poly1305 (RFC 8439) under
+     * per-session keys set on the handshake, one key
+     * per direction:
+     *   - payload bytes are encrypted in place, the
+     *     rest of the payload area is zeroed
+     *   - header, size and block fields are associated
+     *     data: sent in clear (the batch validator
+     *     needs them) and authenticated
+     *   - the nonce is the 64-bit datagram number, its
+     *     low half is sent right before the crc32c (or
+     *     block) fields, the receiver restores the high
+     *     half from the highest accepted number
+     *   - repeats are dropped by the anti-replay window
+     *     of the sender (RFC 4303, 3.4.3): bit k marks
+     *     number highest - k as accepted, older numbers
+     *     are dropped. Only authentic numbers move the
+     *     window, forged ones can not push it ahead
+     *   - 16 byte tag right before the sequence field
+     * Sealing goes before crc32c: the checksum of the
+     * sealed image is recomputed. Images are processed
+     * in batches, keystreams of 4 images (8 blocks)
+     * per ChaCha20 kernel call, keys may differ.
+     * ------------------------------------------------ */
+
+    struct SessionKeys
+    {
+        crypto::Key send;
+        crypto::Key receive;
+    };
+
+    // Ключи направлений из общего секрета рукопожатия, salt - уникален для сессии; у сторон пары зеркальны
+    SessionKeys deriveSessionKeys(crypto::Key const& secret, std::uint64_t salt, bool server) noexcept;
+
+    static constexpr std::size_t REPLAY_WINDOW { 64 };  // numbers behind the highest one
+
+    namespace wire
+    {
+        // Datagram number of the low half closest to the highest accepted one
+        constexpr std::uint64_t expandSequence(std::uint32_t low, std::uint64_t highest) noexcept
+        {
+            constexpr std::uint64_t HALF { std::uint64_t(1) << 31 };
+            constexpr std::uint64_t WRAP { std::uint64_t(1) << 32 };
+
+            const std::uint64_t candidate { (highest & ~(WRAP - 1)) | low };
+            if (candidate + HALF < highest) return candidate + WRAP;
+            if (candidate > highest + HALF and candidate >= WRAP) return candidate - WRAP;
+            return candidate;
+        }
+    }
+
+    // Принять номер подлинной датаграммы по окну отправителя: true - впервые, окно сдвигается
+    constexpr bool acceptSequence(std::uint64_t sequence, std::uint64_t& highest, std::uint64_t& window) noexcept
+    {
+        // a newer number slides the window and takes bit 0, an older one checks its bit
+        const bool ahead { sequence > highest };
+        const std::uint64_t distance { ahead ? sequence - highest : highest - sequence };
+        const std::uint64_t moved { ahead ? (distance < REPLAY_WINDOW ? window << distance : 0) : window };
+        const std::uint64_t bit { ahead ? 1 : (distance < REPLAY_WINDOW ? std::uint64_t(1) << distance : 0) };
+
+        const bool fresh { 0 != bit and 0 == (moved & bit) };
+        window = fresh ? moved | bit : window;
+        highest = fresh and ahead ? sequence : highest;
+        return fresh;
+    }
+
+    // Маска образов с флагом encode
+    std::uint64_t sealedImages(const std::uint8_t* images, std::size_t n) noexcept;
+
+    // Зашифровать на месте образы из маски sealed (записаны Datagram::encode); образ i -
+    // ключом keys[owners[i]] под номером sequences[i], owners == nullptr - keys[0] для всех
+    void sealBatch(std::uint8_t* images, std::size_t n, std::uint64_t sealed,
+                   crypto::Key const* keys, const std::uint32_t* owners, const std::uint64_t* sequences) noexcept;
+
+    // Проверить и расшифровать на месте образы из маски sealed (прошедшие validateBatch);
+    // highest[owners[i]] - наибольший принятый номер отправителя, восстановленные номера пишутся
+    // в sequences[i]. Возвращает маску подлинных образов, остальные не изменены
+    std::uint64_t openBatch(std::uint8_t* images, std::size_t n, std::uint64_t sealed, crypto::Key const* keys,
+                            const std::uint32_t* owners, const std::uint64_t* highest, std::uint64_t* sequences) noexcept;
+
+    // Снять повторы с маски подлинных образов (после openBatch), в порядке образов; окна
+    // отправителей highest/windows[owners[i]] сдвигаются принятыми номерами sequences[i]
+    std::uint64_t acceptBatch(std::uint64_t authentic, const std::uint32_t* owners, const std::uint64_t* sequences,
+                              std::uint64_t* highest, std::uint64_t* windows) noexcept;
+
+}   // network::message
@@ -1,9 +1,12 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
+#include <cstddef>
 #include <iomanip>
 #include <iostream>
+#include <type_traits>
 
 namespace network::message
 {
@@ -15,9 +18,42 @@ namespace network::message
      * message uuid (need only for combined messages),
      * encode and decode flags.
      *
-     * Structure size - 10 bytes
+     * Structure size - 10 bytes (in memory)
+     * Part of the Datagram raw bytes (IdType must be
+     * 4 bytes struct with 2 bytes action), see
+     * checkLayout().
+     *
+     * Wire size - 5 bytes, see encodeHeader():
+     *   [0..1] type action (little endian),
+     *          reserved half of the type is not sent
+     *   [2]    uuid
+     *   [3]    access code
+     *   [4]    flags (encode, compress, blocks,
+     *          checksum)
+     * Block number and count are sent only for
+     * multi block messages, CRC32C only when
+     * requested on encoding, sequence number and
+     * tag only for sealed (encode) messages (see
+     * Datagram).
      * ----------------------------------------------- */
 
+    namespace wire
+    {
+        static constexpr std::size_t HEADER_SIZE { 5 };     // packed header
+        static constexpr std::size_t BLOCKS_SIZE { 2 };     // block number and count
+        static constexpr std::size_t CHECKSUM_SIZE { 4 };   // crc32c
+        static constexpr std::size_t SEQUENCE_SIZE { 4 };   // low half of the sealed datagram number
+        static constexpr std::size_t TAG_SIZE { 16 };       // poly1305 tag of the sealed datagram
+
+        enum EFlags : std::uint8_t
+        {
+            FLAG_ENCODE   = 1u << 0,    // sealed, see datagram_cipher.h
+            FLAG_COMPRESS = 1u << 1,    // compressed message, see compression/lz_codec.h
+            FLAG_BLOCKS   = 1u << 2,    // block fields are present
+            FLAG_CHECKSUM = 1u << 3,    // crc32c field is present
+        };
+    }
+
     template <typename IdType>
     struct Header
     {
@@ -31,35 +67,79 @@ namespace network::message
         bool            compress    { false };  // message compress flag        [1 byte]
         // -----------------------------------------------------------------------------
 
-        Header() = default;
-        ~Header() = default;
-        // noncopyable
-        Header(Header<IdType> const&) = delete;
-        Header<IdType>& operator= (Header<IdType> const&) = delete;
-        // move semantic
-        Header(Header<IdType>&&) noexcept;
-        Header<IdType>& operator= (Header<IdType>&&) noexcept;
-
         template<class U>
         friend std::ostream& operator << (std::ostream& os, Header<IdType> const& h);
 
-        void swap(Header& b) noexcept;
+        // Block fields are omitted on the wire
+        [[nodiscard]] constexpr bool isSingleBlock() const noexcept { return 1 == block_num and 1 == block_count; }
+
+        // Compile time wire layout check, use as static_assert(Header<T>::checkLayout())
+        static constexpr bool checkLayout() noexcept;
 
     };  // Header
 
+    // Pack header into wire::HEADER_SIZE bytes (block fields are written by Datagram)
+    template <typename IdType>
+    constexpr void encodeHeader(Header<IdType> const& h, std::uint8_t* out) noexcept;
+
+    // Unpack header from wire::HEADER_SIZE bytes, block fields are set to a single block
+    template <typename IdType>
+    constexpr Header<IdType> decodeHeader(const std::uint8_t* in) noexcept;
+
     // ********************************* IMPLEMENTATION **********************************
 
     template <typename IdType>
-    Header<IdType>::Header(Header<IdType>&& other) noexcept
+    constexpr void encodeHeader(Header<IdType> const& h, std::uint8_t* out) noexcept
+    {
+        const auto action { static_cast<std::uint16_t>(h.type.action) };
+        out[0] = static_cast<std::uint8_t>(action);
+        out[1] = static_cast<std::uint8_t>(action >> 8);
+        out[2] = h.uuid;
+        out[3] = h.access_code;
+        out[4] = static_cast<std::uint8_t>((h.encode ? wire::FLAG_ENCODE : 0)
+                                         | (h.compress ? wire::FLAG_COMPRESS : 0)
+                                         | (h.isSingleBlock() ? 0 : wire::FLAG_BLOCKS));
+    }
+
+    template <typename IdType>
+    constexpr Header<IdType> decodeHeader(const std::uint8_t* in) noexcept
     {
-        this != &other ? this->swap(other) : void(0);
+        using ActionType = decltype(IdType::action);
+
+        Header<IdType> h {};
+        h.type.action = static_cast<ActionType>(in[0] | (in[1] << 8));
+        h.uuid = in[2];
+        h.access_code = in[3];
+        h.encode = 0 != (in[4] & wire::FLAG_ENCODE);
+        h.compress = 0 != (in[4] & wire::FLAG_COMPRESS);
+        return h;
     }
 
     template <typename IdType>
-    Header<IdType>& Header<IdType>::operator= (Header<IdType> &&other) noexcept
+    constexpr bool Header<IdType>::checkLayout() noexcept
     {
-        this != &other ? this->swap(other) : void(0);
-        return *this;
+        static_assert(std::is_trivially_copyable_v<IdType> and sizeof(IdType) == 4 and alignof(IdType) <= 2,
+                      "message type id should be plain 4 bytes struct");
+        static_assert(sizeof(IdType::action) == 2, "message type action is sent as 2 bytes");
+        static_assert(std::is_trivially_copyable_v<Header> and std::is_standard_layout_v<Header>);
+        static_assert(sizeof(Header) == 10 and alignof(Header) == 2);
+        static_assert(offsetof(Header, type) == 0 and offsetof(Header, uuid) == 4);
+        static_assert(offsetof(Header, block_num) == 5 and offsetof(Header, block_count) == 6);
+        static_assert(offsetof(Header, access_code) == 7 and offsetof(Header, encode) == 8);
+        static_assert(offsetof(Header, compress) == 9);
+
+        // packing is lossless for everything but block fields
+        constexpr Header h { decodeHeader<IdType>([] {
+            Header src {};
+            src.uuid = 0x42;
+            src.access_code = 0xEA;
+            src.compress = true;
+            std::array<std::uint8_t, wire::HEADER_SIZE> out {};
+            encodeHeader(src, out.data());
+            return out;
+        }().data()) };
+        static_assert(0x42 == h.uuid and 0xEA == h.access_code and not h.encode and h.compress and h.isSingleBlock());
+        return true;
     }
 
     template <typename IdType>
@@ -85,16 +165,4 @@ namespace network::message
         return os;
     }
 
-    template <typename IdType>
-    void Header<IdType>::swap(Header<IdType> &b) noexcept
-    {
-        std::swap(type, b.type);
-        std::swap(uuid, b.uuid);
-        std::swap(block_num, b.block_num);
-        std::swap(block_count, b.block_count);
-        std::swap(access_code, b.access_code);
-        std::swap(encode, b.encode);
-        std::swap(compress, b.compress);
-    }
-
 }   // network::message
\ No newline at end of file
@@ -25,11 +25,10 @@ namespace network::message::helper
                          std::uint8_t code = SERVER_ACCESS_CODE,
                          std::uint8_t last = END_MESSAGE_BYTE) noexcept
     {
-        const bool sc { 64 == sizeof(datagram) };
         const bool ac { code == datagram.HeaderRef().access_code };
         const bool ec { last == datagram.Data()[END_MESSAGE_BYTE_POS] };
 
-        return sc and ac and ec;
+        return ac and ec;
     }
 
 }   // network::message::helper
@@ -2,6 +2,7 @@
 #pragma once
 
 #include <hermes/common/utils.h>
+#include <hermes/message/schema.h>
 
 #include <string>
 #include <cassert>
@@ -18,7 +19,7 @@ namespace network::message::object
      * Clint send this object wrapped into net message to
      * try to connect server with protection value for got trusted.
      *
-     * Structure size - * bytes
+     * Wire size - 22 bytes (version is sent in 16 bits)
      * ----------------------------------------------------------- */
 
     class MConnect
@@ -29,6 +30,11 @@ namespace network::message::object
         boost::uuids::uuid  uuid_;      // id
 
     public:
+        using Schema = schema::Fields<
+            schema::Integer<&MConnect::prot_>,
+            schema::Integer<&MConnect::version_, 16>,
+            schema::Uuid<&MConnect::uuid_>>;
+
         explicit MConnect(std::uint32_t protectionValue) noexcept
             : prot_(protectionValue)
             , version_(1)   // temp
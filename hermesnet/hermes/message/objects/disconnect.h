@@ -2,6 +2,7 @@
 #pragma once
 
 #include <hermes/common/utils.h>
+#include <hermes/message/schema.h>
 
 #include <string>
 #include <string_view>
@@ -17,7 +18,7 @@ namespace network::message::object
      * Server or client send this object wrapped into net message
      * when one of those should disconnect or be disconnected.
      *
-     * Structure size - * bytes
+     * Wire size - 17 bytes (reason is sent in 3 bits)
      * ---------------------------------------------------------- */
 
     class MDisconnect
@@ -37,6 +38,10 @@ namespace network::message::object
         EDisconnectReason   reason_;    // what happened
 
     public:
+        using Schema = schema::Fields<
+            schema::Uuid<&MDisconnect::uuid_>,
+            schema::Integer<&MDisconnect::reason_, 3>>;
+
         explicit MDisconnect(boost::uuids::uuid uuid, EDisconnectReason reason)
             : uuid_(uuid)
             , reason_(reason)
@@ -6,6 +6,8 @@
 #include <iomanip>
 #include <cstdint>
 
+#include <hermes/message/schema.h>
+
 namespace network::message::object
 {
     using namespace std::chrono;
@@ -18,7 +20,7 @@ namespace network::message::object
      * back, where sets end_ on read message and later giving
      * the time difference.
      *
-     * Structure size - * bytes
+     * Wire size - 16 bytes (two 64-bit nanosecond counts)
      * ----------------------------------------------------- */
 
     class MPing
@@ -36,6 +38,10 @@ namespace network::message::object
         clock::time_point end_;     // sets when client received back
 
     public:
+        using Schema = schema::Fields<
+            schema::TimePoint<&MPing::start_>,
+            schema::TimePoint<&MPing::end_>>;
+
         MPing() = default;
         ~MPing() = default;
 
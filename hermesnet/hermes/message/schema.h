@@ -0,0 +1,272 @@
+#pragma once
+
+#include <ratio>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <utility>
+#include <type_traits>
+
+#include <boost/uuid/uuid.hpp>
+
+#include <hermes/message/body.h>
+#include <hermes/message/datagram.h>
+#include <hermes/message/bit_stream.h>
+
+namespace network::message::schema
+{
+
+    /* ------------- Message object schema -------------
+     *
+     * Compile time list of object fields with their wire
+     * encoding. The object declares it as a nested type,
+     * so private members can be listed:
+     *
+     *   using Schema = schema::Fields<
+     *       schema::Integer<&MConnect::prot_>,
+     *       schema::Integer<&MConnect::version_, 16>,
+     *       schema::Uuid<&MConnect::uuid_>>;
+     *
+     * Fields are packed in order without padding, integers
+     * in the given bit width, little endian on the wire
+     * whatever the host, see BitWriter. The serializer is
+     * fully unrolled at compile time.
+     *
+     * A trivially copyable object whose fields are all
+     * stored as is (full width integers, nanosecond time
+     * points, uuids) in member order without padding has
+     * the wire image of its own bytes on a little endian
+     * host, such objects are copied with one memcpy.
+     * ------------------------------------------------- */
+
+    namespace detail
+    {
+        template <typename T>
+        struct MemberTraits;
+
+        template <typename C, typename T>
+        struct MemberTraits<T C::*>
+        {
+            using ObjectType = C;
+            using ValueType  = T;
+        };
+
+        template <typename T, bool = std::is_enum_v<T>>
+        struct Underlying { using type = T; };
+
+        template <typename T>
+        struct Underlying<T, true> { using type = std::underlying_type_t<T>; };
+
+        // byte offset of the member, folded to a constant by the compiler
+        template <auto Member, typename ObjectType>
+        inline std::size_t offsetOf(ObjectType const& obj) noexcept
+        {
+            return static_cast<std::size_t>(reinterpret_cast<const std::byte*>(&(obj.*Member)) - reinterpret_cast<const std::byte*>(&obj));
+        }
+
+        constexpr bool LITTLE_ENDIAN_HOST { __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__ };
+    }
+
+    // Integer or enum in Bits bits (values must fit)
+    template <auto Member, unsigned Bits = 8 * sizeof(typename detail::MemberTraits<decltype(Member)>::ValueType)>
+    struct Integer
+    {
+        using ObjectType = typename detail::MemberTraits<decltype(Member)>::ObjectType;
+        using ValueType  = typename detail::MemberTraits<decltype(Member)>::ValueType;
+        using RawType    = typename detail::Underlying<ValueType>::type;
+
+        static_assert(std::is_integral_v<RawType> and Bits >= 1 and Bits <= 64);
+        static constexpr std::size_t BITS { Bits };
+        static constexpr bool AS_IS { 8 * sizeof(ValueType) == Bits and not std::is_same_v<RawType, bool> };   // bool bytes are normalized on read
+
+        static std::size_t offset(ObjectType const& obj) noexcept { return detail::offsetOf<Member>(obj); }
+
+        static void write(BitWriter& w, ObjectType const& obj) noexcept {
+            w.write(static_cast<std::uint64_t>(static_cast<RawType>(obj.*Member)), Bits);
+        }
+
+        static void read(BitReader& r, ObjectType& obj) noexcept {
+            auto raw { r.read(Bits) };
+            if constexpr (std::is_signed_v<RawType> and Bits < 64)
+                raw = (raw ^ (std::uint64_t(1) << (Bits - 1))) - (std::uint64_t(1) << (Bits - 1));   // sign extend
+            obj.*Member = static_cast<ValueType>(static_cast<RawType>(raw));
+        }
+    };
+
+    // Inclusive float range of a quantized field
+    template <std::int32_t Min, std::int32_t Max>
+    struct Range
+    {
+        static_assert(Min < Max);
+        static constexpr float MIN { static_cast<float>(Min) };
+        static constexpr float MAX { static_cast<float>(Max) };
+    };
+
+    // Float quantized to Bits bits over RangeType
+    template <auto Member, typename RangeType, unsigned Bits>
+    struct Float
+    {
+        using ObjectType = typename detail::MemberTraits<decltype(Member)>::ObjectType;
+
+        static_assert(std::is_same_v<float, typename detail::MemberTraits<decltype(Member)>::ValueType>);
+        static_assert(Bits >= 1 and Bits <= 32);
+        static constexpr std::size_t BITS { Bits };
+        static constexpr bool AS_IS { false };
+
+        static std::size_t offset(ObjectType const& obj) noexcept { return detail::offsetOf<Member>(obj); }
+
+        static void write(BitWriter& w, ObjectType const& obj) noexcept {
+            w.writeFloat(obj.*Member, RangeType::MIN, RangeType::MAX, Bits);
+        }
+
+        static void read(BitReader& r, ObjectType& obj) noexcept {
+            obj.*Member = r.readFloat(RangeType::MIN, RangeType::MAX, Bits);
+        }
+    };
+
+    // std::chrono::time_point as tick count of Period since clock epoch
+    template <auto Member, typename Period = std::nano, unsigned Bits = 64>
+    struct TimePoint
+    {
+        using ObjectType = typename detail::MemberTraits<decltype(Member)>::ObjectType;
+        using ValueType  = typename detail::MemberTraits<decltype(Member)>::ValueType;
+        using Duration   = std::chrono::duration<std::int64_t, Period>;
+
+        static constexpr std::size_t BITS { Bits };
+        static constexpr bool AS_IS { 64 == Bits and sizeof(ValueType) == 8 and std::is_same_v<typename ValueType::duration, Duration> };
+
+        static std::size_t offset(ObjectType const& obj) noexcept { return detail::offsetOf<Member>(obj); }
+
+        static void write(BitWriter& w, ObjectType const& obj) noexcept {
+            const auto ticks { std::chrono::duration_cast<Duration>((obj.*Member).time_since_epoch()).count() };
+            w.write(static_cast<std::uint64_t>(ticks), Bits);
+        }
+
+        static void read(BitReader& r, ObjectType& obj) noexcept {
+            const Duration ticks { static_cast<std::int64_t>(r.read(Bits)) };
+            obj.*Member = ValueType { std::chrono::duration_cast<typename ValueType::duration>(ticks) };
+        }
+    };
+
+    // boost::uuids::uuid as 16 bytes in their own order
+    template <auto Member>
+    struct Uuid
+    {
+        using ObjectType = typename detail::MemberTraits<decltype(Member)>::ObjectType;
+
+        static_assert(std::is_same_v<boost::uuids::uuid, typename detail::MemberTraits<decltype(Member)>::ValueType>);
+        static constexpr std::size_t BITS { 128 };
+        static constexpr bool AS_IS { sizeof(boost::uuids::uuid) == 16 };
+
+        static std::size_t offset(ObjectType const& obj) noexcept { return detail::offsetOf<Member>(obj); }
+
+        static void write(BitWriter& w, ObjectType const& obj) noexcept {
+            auto const& bytes { (obj.*Member).data };
+            w.write(bits::loadLE(bytes, 8), 64);
+            w.write(bits::loadLE(bytes + 8, 8), 64);
+        }
+
+        static void read(BitReader& r, ObjectType& obj) noexcept {
+            auto& bytes { (obj.*Member).data };
+            bits::storeLE(bytes, r.read(64), 8);
+            bits::storeLE(bytes + 8, r.read(64), 8);
+        }
+    };
+
+    template <typename... FieldTypes>
+    struct Fields
+    {
+        static_assert(sizeof...(FieldTypes) > 0);
+
+        static constexpr std::size_t BITS  { (FieldTypes::BITS + ...) };
+        static constexpr std::size_t BYTES { (BITS + 7) / 8 };
+
+        // all fields keep their bytes as is: the object may be its own wire image
+        template <typename ObjectType>
+        static constexpr bool MAY_COPY { detail::LITTLE_ENDIAN_HOST and (FieldTypes::AS_IS and ...) and
+                                         std::is_trivially_copyable_v<ObjectType> and sizeof(ObjectType) == BYTES };
+
+        // fields follow the members in order without gaps (constant after inlining)
+        template <typename ObjectType>
+        static bool inOrder(ObjectType const& obj) noexcept {
+            std::size_t at { 0 };
+            return ((FieldTypes::offset(obj) == std::exchange(at, at + FieldTypes::BITS / 8)) and ...);
+        }
+
+        template <typename ObjectType>
+        static void write(BitWriter& w, ObjectType const& obj) noexcept {
+            (FieldTypes::write(w, obj), ...);
+        }
+
+        template <typename ObjectType>
+        static void read(BitReader& r, ObjectType& obj) noexcept {
+            (FieldTypes::read(r, obj), ...);
+        }
+    };
+
+    // Packed size of the object on the wire
+    template <typename ObjectType>
+    constexpr std::size_t packedSize() noexcept { return ObjectType::Schema::BYTES; }
+
+    /*
+     * Body keeps objects as a stack: write() appends after the
+     * current payload, read() takes the last written object
+     * (same order as Body::write/read). The capacity is the
+     * payload limit of the wire image, Datagram::capacity():
+     * block fields, crc and sealing take the payload tail.
+     */
+    template <typename ObjectType>
+    bool write(Body& body, ObjectType const& obj, std::size_t capacity = CAPACITY) noexcept
+    {
+        constexpr auto bytes { packedSize<ObjectType>() };
+        if (capacity > CAPACITY or body.size + bytes > capacity) return false;
+
+        using Schema = typename ObjectType::Schema;
+        if constexpr (Schema::template MAY_COPY<ObjectType>)
+        {
+            if (Schema::inOrder(obj))
+            {
+                std::memcpy(body.buf.data() + body.size, &obj, bytes);
+                body.size += bytes;
+                return true;
+            }
+        }
+
+        BitWriter w { body, capacity };
+        Schema::write(w, obj);
+        w.flush();
+        return true;
+    }
+
+    // Append to the datagram payload within its wire capacity
+    template <typename IdType, typename ObjectType>
+    bool write(Datagram<IdType>& datagram, ObjectType const& obj, bool checksum = false) noexcept
+    {
+        return write(datagram.BodyRef(), obj, datagram.capacity(checksum));
+    }
+
+    template <typename ObjectType>
+    bool read(Body& body, ObjectType& obj) noexcept
+    {
+        constexpr auto bytes { packedSize<ObjectType>() };
+        if (body.size < bytes) return false;
+
+        body.size -= bytes;
+
+        using Schema = typename ObjectType::Schema;
+        if constexpr (Schema::template MAY_COPY<ObjectType>)
+        {
+            if (Schema::inOrder(obj))
+            {
+                std::memcpy(&obj, body.buf.data() + body.size, bytes);
+                return true;
+            }
+        }
+
+        BitReader r { body.buf.data() + body.size, bytes };
+        Schema::read(r, obj);
+        return true;
+    }
+
+}   // network::message::schema
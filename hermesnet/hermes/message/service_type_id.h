@@ -1,8 +1,12 @@
 
 #pragma once
 
+#include <string>
 #include <cstdint>
+#include <cstddef>
+#include <iostream>
 #include <algorithm>
+#include <type_traits>
 
 namespace network::message::id
 {
@@ -24,6 +28,8 @@ namespace network::message::id
             SERVICE_ACT_ACCEPT,
             SERVICE_ACT_DECLINE,
             SERVICE_ACT_DISCONNECT,
+            SERVICE_ACT_SNAPSHOT,       // replicated world state (delta), usually multi block
+            SERVICE_ACT_INPUT,          // client input with the last frames repeated
         };
 
         // *** reserved 2byte field ***
@@ -32,51 +38,33 @@ namespace network::message::id
             NONE = 0
         };
 
+        // actions above are rejected by the batch validator
+        static constexpr std::uint16_t ACTION_COUNT { static_cast<std::uint16_t>(EServiceAction::SERVICE_ACT_INPUT) + 1 };
+        // input frames, taken from the client sockets only (sealed, replays dropped)
+        static constexpr EServiceAction INPUT_ACTION { EServiceAction::SERVICE_ACT_INPUT };
+
         // --------------------------------------------
         EServiceAction  action   {};       // [2 bytes]
         EReserved       reserved {};       // [2 bytes]
         // --------------------------------------------
 
-        ServiceType() = default;
-        ~ServiceType() = default;
-        // noncopyable
-        ServiceType(ServiceType const&) = delete;
-        ServiceType& operator= (ServiceType const&) = delete;
-        // move semantic
-        ServiceType(ServiceType&&) noexcept;
-        ServiceType& operator= (ServiceType&&) noexcept;
-
-        void swap(ServiceType& other) noexcept;
-
         [[nodiscard]] std::string getActionStr() const;
 
         friend std::ostream& operator<< (std::ostream& os, ServiceType const& st);
 
     }; // ServiceType
 
-    ServiceType::ServiceType(ServiceType&& other) noexcept
-    {
-        this != &other ? this->swap(other) : void(0);
-    }
-
-    ServiceType& ServiceType::operator= (ServiceType&& other) noexcept
-    {
-        this != &other ? this->swap(other) : void(0);
-        return *this;
-    }
-
-    void ServiceType::swap(ServiceType& other)  noexcept
-    {
-        std::swap(action, other.action);
-        std::swap(reserved, other.reserved);
-    }
+    // part of the Datagram raw bytes
+    static_assert(std::is_trivially_copyable_v<ServiceType> and std::is_standard_layout_v<ServiceType>);
+    static_assert(sizeof(ServiceType) == 4 and alignof(ServiceType) == 2);
+    static_assert(offsetof(ServiceType, action) == 0 and offsetof(ServiceType, reserved) == 2);
 
-    std::ostream& operator<< (std::ostream &os, ServiceType const& st) {
+    inline std::ostream& operator<< (std::ostream &os, ServiceType const& st) {
         os << "action - " << st.getActionStr() << "\n";
         return os;
     }
 
-    std::string ServiceType::getActionStr() const
+    inline std::string ServiceType::getActionStr() const
     {
         switch(action) {
             default:
@@ -86,6 +74,8 @@ namespace network::message::id
             case EServiceAction::SERVICE_ACT_ACCEPT:        return "accept";
             case EServiceAction::SERVICE_ACT_DECLINE:       return "decline";
             case EServiceAction::SERVICE_ACT_DISCONNECT:    return "disconnect";
+            case EServiceAction::SERVICE_ACT_SNAPSHOT:      return "snapshot";
+            case EServiceAction::SERVICE_ACT_INPUT:         return "input";
         }
     }
 
@@ -2,7 +2,11 @@
 #include "netloop.h"
 
 #include <thread>
+#include <chrono>
+#include <sstream>
+#include <iomanip>
 #include <hermes/log/log.h>
+#include <hermes/common/arena.h>
 
 using namespace network;
 using namespace utility::logger;
@@ -13,8 +17,10 @@ namespace
 #define LOG(text) Logger::getInstance().log(EModule::NETLOOP, (text));
 }
 
-NetLoop::NetLoop(std::unique_ptr<IReceiver> r, std::unique_ptr<ISender> s)
+NetLoop::NetLoop(std::unique_ptr<IReceiver> r, std::unique_ptr<ISender> s, NetLoopConfig config)
     : bStopNetThreads_(false)
+    , config_(std::move(config))
+    , inWait_(config_.wait)
 {
     receiver_ = std::forward<decltype(r)>(r);
     sender_ = std::forward<decltype(s)>(s);
@@ -30,6 +36,14 @@ NetLoop::~NetLoop()
 bool NetLoop::runThreads()
 {
     LOG("run network threads")
+
+    if (config_.lockMemory)
+    {
+        std::string error;
+        if (not threading::lockProcessMemory(error))
+            LOG(("memory lock failed: " + error).c_str())
+    }
+
     inThread_ = std::thread(&NetLoop::processIncoming, this);
     outThread_ = std::thread(&NetLoop::processOutcoming, this);
     return true;
@@ -40,11 +54,47 @@ void NetLoop::stopThreads()
     if (not bStopNetThreads_)
     {
         bStopNetThreads_.store(true, std::memory_order::memory_order_acquire);
+        inWait_.wake();
 
         inThread_.joinable()  ? inThread_.join()  : void(0);
         outThread_.joinable() ? outThread_.join() : void(0);
 
         LOG("network threads stopped")
+
+        std::stringstream ss;
+        ss  << "in loop latency [ns]: count " << inLatency_.count()
+            << ", p50 " << inLatency_.percentile(0.5)
+            << ", p99 " << inLatency_.percentile(0.99)
+            << ", p99.9 " << inLatency_.percentile(0.999)
+            << ", max " << inLatency_.max();
+        LOG(ss.str().c_str())
+
+        const auto& ws { inWait_.stats() };
+        ss.str({});
+        ss  << "in loop wait [" << getProfileName(inWait_.config().profile) << "]: cpu "
+            << std::fixed << std::setprecision(1) << ws.cpuUsage * 100.0 << "%"
+            << ", spins " << ws.spins << ", yields " << ws.yields
+            << ", parks " << ws.parks << ", wakeups " << ws.wakeups;
+        LOG(ss.str().c_str())
+    }
+}
+
+bool NetLoop::watch(int fd) noexcept
+{
+    return inWait_.watch(fd);
+}
+
+utility::bench::LatencyHistogram const& NetLoop::inLatency() const
+{
+    return inLatency_;
+}
+
+void NetLoop::configureThread(ThreadConfig const& config)
+{
+    std::string error;
+    if (not threading::applyToCurrentThread(config, error))
+    {
+        LOG((config.name + " thread config failed: " + error).c_str())
     }
 }
 
@@ -53,16 +103,24 @@ void NetLoop::processIncoming()
     if (!receiver_)
         throw std::runtime_error("receiver not initialized");
 
+    configureThread(config_.in);
+    inWait_.begin();
+
     while(!bStopNetThreads_)
     {
-        receiver_->process();
+        const auto start { std::chrono::steady_clock::now() };
+        const auto received { receiver_->process() };
+        inLatency_.record(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count());
 
-        // ***** DEV ONLY *****
-        LOG("tick net::in_process")
-        std::this_thread::sleep_for(std::chrono::milliseconds(200));
-        // ********************
+        // per tick scratch memory of the receiver
+        memory::tickArena().reset();
+
+        // spin -> yield -> park on sockets while there is no traffic
+        inWait_.onIteration(received);
     }
 
+    inWait_.end();
+
     LOG("end of net::in_process loop")
 }
 
@@ -71,9 +129,12 @@ void NetLoop::processOutcoming()
     if (!sender_)
         throw std::runtime_error("sender not initialized");
 
+    configureThread(config_.out);
+
     while(!bStopNetThreads_)
     {
         sender_->process();
+        memory::tickArena().reset();
 
         // ***** DEV ONLY *****
         LOG("tick net::out_process")
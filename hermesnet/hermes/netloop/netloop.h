@@ -7,6 +7,8 @@
 
 #include <boost/noncopyable.hpp>
 
+#include <hermes/netloop/thread_config.h>
+#include <hermes/common/latency_histogram.h>
 #include <hermes/data_sender/interface/isender.h>
 #include <hermes/data_receiver/interface/ireceiver.h>
 
@@ -22,19 +24,32 @@ namespace network
     private:
         std::thread         inThread_, outThread_;
         std::atomic_bool    bStopNetThreads_;
+        NetLoopConfig       config_;
+        WaitStrategy        inWait_;
+
+        // длительность итераций цикла приема (нс), пишется только потоком in
+        utility::bench::LatencyHistogram inLatency_;
 
         std::unique_ptr<IReceiver>  receiver_   { nullptr };
         std::unique_ptr<ISender>    sender_     { nullptr };
 
     public:
-        explicit NetLoop(std::unique_ptr<IReceiver> r, std::unique_ptr<ISender> s);
+        explicit NetLoop(std::unique_ptr<IReceiver> r, std::unique_ptr<ISender> s, NetLoopConfig config = {});
         virtual ~NetLoop();
 
         // todo: better return value
         bool runThreads();
         void stopThreads();
 
+        // Ожидать датаграммы на сокете в простое цикла приема (вызывать до runThreads)
+        bool watch(int fd) noexcept;
+
+        // Гистограмма длительности итераций цикла приема (читать после stopThreads)
+        [[nodiscard]] utility::bench::LatencyHistogram const& inLatency() const;
+
     private:
+        // Применить параметры к текущему сетевому потоку
+        void configureThread(ThreadConfig const& config);
         // Принять и обработать входящие сообщения
         void processIncoming();
         // Подготовить и отправить сообщения клиентам
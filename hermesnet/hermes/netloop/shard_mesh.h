@@ -0,0 +1,175 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <utility>
+#include <memory_resource>
+
+#include <unistd.h>
+#include <sys/eventfd.h>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/buffers/spsc_queue.h>
+
+namespace network
+{
+    /*
+     *  Сетка очередей между шардами: для каждой пары (from, to)
+     *  своя SPSC очередь, писатель - поток шарда from, читатель -
+     *  поток шарда to. Позволяет пересылать сообщения (например,
+     *  широковещательные сообщения комнаты чата) между ядрами без
+     *  блокировок. У каждого шарда-получателя eventfd, который
+     *  взводится первой записью после опустошения, чтобы цикл приема,
+     *  уснувший в epoll, просыпался сразу, а не по таймауту.
+     */
+    template <typename ElementType>
+    class ShardMesh : boost::noncopyable
+    {
+    private:
+        using QueueType = buffer::SpscQueue<ElementType>;
+
+        // inbox of a receiving shard, written by all the others
+        struct alignas(64) Inbox
+        {
+            std::atomic_bool    signalled   { false };  // eventfd is readable or about to be
+            int                 eventFd     { -1 };
+        };
+
+        std::uint32_t                           count_ { 0 };
+        std::vector<std::unique_ptr<QueueType>> queues_;   // [from * count_ + to]
+        std::unique_ptr<Inbox[]>                inboxes_;  // [to]
+
+        // Разбудить получателя to, если он еще не разбужен
+        void signal(std::uint32_t to) noexcept;
+
+    public:
+        explicit ShardMesh(std::uint32_t shards, std::size_t queueCapacity, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+        ShardMesh() = delete;
+        ~ShardMesh();
+
+        // Переслать сообщение из шарда from в шард to
+        bool push(std::uint32_t from, std::uint32_t to, ElementType&& elem) noexcept;
+        // Извлечь все сообщения, пришедшие в шард to от остальных шардов
+        template <typename Handler>
+        std::size_t drain(std::uint32_t to, Handler&& handler);
+
+        [[nodiscard]] std::uint32_t count() const noexcept;
+        // eventfd шарда to для ожидания в epoll (NetLoop::watch), читается в drain(); -1 - нет
+        [[nodiscard]] int notifier(std::uint32_t to) const noexcept;
+
+    };  // ShardMesh
+
+
+    /*
+     *  Привязка конкретного шарда к сетке очередей
+     */
+    template <typename ElementType>
+    struct ShardLink
+    {
+        ShardMesh<ElementType>* mesh  { nullptr };
+        std::uint32_t           index { 0 };
+
+        [[nodiscard]] bool attached() const noexcept {
+            return nullptr != mesh and mesh->count() > 1;
+        }
+    };
+
+}   // namespace network
+
+// ********************************* IMPLEMENTATION **********************************
+
+using namespace network;
+
+template <typename ElementType>
+ShardMesh<ElementType>::ShardMesh(std::uint32_t shards, std::size_t queueCapacity, std::pmr::memory_resource* memory)
+    : count_(shards)
+    , inboxes_(std::make_unique<Inbox[]>(shards))
+{
+    for (std::uint32_t to = 0; to < shards; ++to)
+        inboxes_[to].eventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+
+    queues_.reserve(static_cast<std::size_t>(shards) * shards);
+    for (std::uint32_t from = 0; from < shards; ++from)
+    {
+        for (std::uint32_t to = 0; to < shards; ++to)
+        {
+            // no loopback queue for the shard itself
+            queues_.emplace_back(from == to ? nullptr : std::make_unique<QueueType>(queueCapacity, memory));
+        }
+    }
+}
+
+template <typename ElementType>
+ShardMesh<ElementType>::~ShardMesh()
+{
+    for (std::uint32_t to = 0; to < count_; ++to)
+        if (inboxes_[to].eventFd >= 0) close(inboxes_[to].eventFd);
+}
+
+template <typename ElementType>
+bool ShardMesh<ElementType>::push(std::uint32_t from, std::uint32_t to, ElementType&& elem) noexcept
+{
+    if (from == to or from >= count_ or to >= count_)
+        return false;
+
+    if (not queues_[from * count_ + to]->tryPush(std::forward<ElementType>(elem)))
+        return false;
+
+    signal(to);
+    return true;
+}
+
+template <typename ElementType>
+void ShardMesh<ElementType>::signal(std::uint32_t to) noexcept
+{
+    // one write per drain of the receiver, not per message
+    auto& inbox { inboxes_[to] };
+    if (inbox.signalled.exchange(true, std::memory_order_acq_rel) or inbox.eventFd < 0) return;
+
+    const std::uint64_t one { 1 };
+    [[maybe_unused]] auto rc { write(inbox.eventFd, &one, sizeof(one)) };
+}
+
+template <typename ElementType>
+template <typename Handler>
+std::size_t ShardMesh<ElementType>::drain(std::uint32_t to, Handler&& handler)
+{
+    std::size_t drained { 0 };
+    ElementType elem {};
+
+    // cleared before the queues are read: a push after that signals again
+    auto& inbox { inboxes_[to] };
+    if (inbox.signalled.load(std::memory_order_relaxed) and inbox.signalled.exchange(false, std::memory_order_acq_rel) and inbox.eventFd >= 0)
+    {
+        std::uint64_t value { 0 };
+        [[maybe_unused]] auto rc { read(inbox.eventFd, &value, sizeof(value)) };
+    }
+
+    for (std::uint32_t from = 0; from < count_; ++from)
+    {
+        if (from == to) continue;
+
+        auto& queue { *queues_[from * count_ + to] };
+        while (queue.tryPop(elem))
+        {
+            handler(std::move(elem));
+            ++drained;
+        }
+    }
+    return drained;
+}
+
+template <typename ElementType>
+std::uint32_t ShardMesh<ElementType>::count() const noexcept
+{
+    return count_;
+}
+
+template <typename ElementType>
+int ShardMesh<ElementType>::notifier(std::uint32_t to) const noexcept
+{
+    return to < count_ ? inboxes_[to].eventFd : -1;
+}
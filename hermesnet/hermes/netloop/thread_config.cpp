@@ -0,0 +1,129 @@
+#include "thread_config.h"
+
+#include <cerrno>
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#include <sched.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/mman.h>
+
+using namespace network;
+
+namespace
+{
+    std::string errorText(const char* what, int code)
+    {
+        std::stringstream ss;
+        ss << what << ": " << std::strerror(code);
+        return ss.str();
+    }
+}
+
+bool threading::applyToCurrentThread(ThreadConfig const& config, std::string& error)
+{
+    const pthread_t self { pthread_self() };
+    bool ok { true };
+
+    if (not config.name.empty())
+    {
+        // kernel limit is 16 bytes including terminator
+        const std::string name { config.name.substr(0, 15) };
+        if (const int rc { pthread_setname_np(self, name.c_str()) }; 0 != rc) {
+            error += errorText("setname", rc) + "; ";
+            ok = false;
+        }
+    }
+
+    std::vector<int> cpus { config.cpus };
+    if (cpus.empty() and config.numaNode >= 0)
+        cpus = numaNodeCpus(config.numaNode);
+
+    if (not cpus.empty())
+    {
+        // CPU_SET past the fixed size set writes out of it, the mask is not applied at all then
+        const long online { sysconf(_SC_NPROCESSORS_ONLN) };
+        const int limit { static_cast<int>(std::min<long>(CPU_SETSIZE, online > 0 ? online : CPU_SETSIZE)) };
+        const auto bad { std::find_if(cpus.begin(), cpus.end(), [limit](int cpu) { return cpu < 0 or cpu >= limit; }) };
+
+        if (bad != cpus.end())
+        {
+            std::stringstream ss;
+            ss << "affinity: cpu " << *bad << " (entry " << (bad - cpus.begin()) << ") out of [0, " << limit << "); ";
+            error += ss.str();
+            ok = false;
+        }
+        else
+        {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            for (const int cpu : cpus)
+                CPU_SET(cpu, &set);
+
+            if (const int rc { pthread_setaffinity_np(self, sizeof(set), &set) }; 0 != rc) {
+                error += errorText("affinity", rc) + "; ";
+                ok = false;
+            }
+        }
+    }
+
+    if (config.priority > 0)
+    {
+        sched_param param {};
+        param.sched_priority = config.priority;
+        // needs CAP_SYS_NICE or RLIMIT_RTPRIO
+        if (const int rc { pthread_setschedparam(self, SCHED_FIFO, &param) }; 0 != rc) {
+            error += errorText("SCHED_FIFO", rc) + "; ";
+            ok = false;
+        }
+    }
+
+    return ok;
+}
+
+bool threading::lockProcessMemory(std::string& error)
+{
+    if (0 != mlockall(MCL_CURRENT | MCL_FUTURE))
+    {
+        error += errorText("mlockall", errno) + "; ";
+        return false;
+    }
+    return true;
+}
+
+std::vector<int> threading::numaNodeCpus(int node)
+{
+    std::ifstream file("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string list;
+    if (not file.is_open() or not std::getline(file, list))
+        return {};
+
+    return parseCpuList(list);
+}
+
+std::vector<int> threading::parseCpuList(std::string const& list)
+{
+    std::vector<int> cpus;
+    std::stringstream ss(list);
+    std::string range;
+
+    while (std::getline(ss, range, ','))
+    {
+        if (range.empty()) continue;
+
+        const auto dash { range.find('-') };
+        try {
+            const int first { std::stoi(range.substr(0, dash)) };
+            const int last  { dash == std::string::npos ? first : std::stoi(range.substr(dash + 1)) };
+            for (int cpu = first; cpu <= last; ++cpu)
+                cpus.push_back(cpu);
+        }
+        catch (std::exception const&) {
+            return {};
+        }
+    }
+    return cpus;
+}
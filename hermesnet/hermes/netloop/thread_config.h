@@ -0,0 +1,49 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <thread>
+#include <cstdint>
+
+#include <hermes/common/huge_pages.h>
+#include <hermes/netloop/wait_strategy.h>
+
+namespace network
+{
+    /*
+     *  Параметры сетевого потока: имя, привязка к ядрам,
+     *  предпочтительный NUMA узел и приоритет реального времени.
+     */
+    struct ThreadConfig
+    {
+        std::string         name;               // thread name, up to 15 chars
+        std::vector<int>    cpus;               // affinity mask, empty - no pinning
+        int                 numaNode { -1 };    // use node's cpus if mask is empty, -1 - any node
+        int                 priority { 0 };     // SCHED_FIFO priority [1..99], 0 - SCHED_OTHER
+    };
+
+    /*
+     *  Параметры потоков цикла обработки сетевых сообщений
+     */
+    struct NetLoopConfig
+    {
+        ThreadConfig        in          { "hermes-in", {}, -1, 0 };
+        ThreadConfig        out         { "hermes-out", {}, -1, 0 };
+        WaitConfig          wait        {};         // in thread idle strategy
+        bool                lockMemory  { false };  // mlockall(MCL_CURRENT | MCL_FUTURE) on start
+        memory::EPagePolicy pages       { memory::EPagePolicy::REGULAR };  // pages of ring buffers
+    };
+
+    namespace threading
+    {
+        // Применить параметры к вызывающему потоку, возвращает false при любой ошибке (ядро вне [0, CPU_SETSIZE) или вне числа онлайн ядер - маска не применяется)
+        bool applyToCurrentThread(ThreadConfig const& config, std::string& error);
+        // Зафиксировать страницы процесса в памяти
+        bool lockProcessMemory(std::string& error);
+        // Список ядер NUMA узла (/sys/devices/system/node/nodeN/cpulist)
+        std::vector<int> numaNodeCpus(int node);
+        // Разобрать список ядер вида "0-3,8,10-11"
+        std::vector<int> parseCpuList(std::string const& list);
+    }
+
+}   // namespace network
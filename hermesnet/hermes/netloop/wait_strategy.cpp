@@ -0,0 +1,201 @@
+#include "wait_strategy.h"
+
+#include <thread>
+#include <algorithm>
+
+#include <time.h>
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <sys/eventfd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+    #include <immintrin.h>
+    #define CPU_RELAX() _mm_pause()
+#else
+    #define CPU_RELAX() std::this_thread::yield()
+#endif
+
+using namespace network;
+
+namespace
+{
+    struct ProfileLimits
+    {
+        std::uint64_t minSpinNs;
+        std::uint64_t maxSpinNs;
+        std::uint64_t minYieldNs;
+        std::uint64_t maxYieldNs;
+    };
+
+    constexpr ProfileLimits LATENCY_LIMITS    { 20'000, 200'000, 50'000, 1'000'000 };
+    constexpr ProfileLimits EFFICIENCY_LIMITS {      0,   5'000,      0,    20'000 };
+
+    constexpr std::uint32_t PAUSES_PER_SPIN { 32 };     // ~1us on modern x86
+    constexpr int           MAX_EVENTS      { 16 };
+
+    std::uint64_t threadCpuNs() noexcept
+    {
+        timespec ts {};
+        clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+        return static_cast<std::uint64_t>(ts.tv_sec) * 1'000'000'000ull + static_cast<std::uint64_t>(ts.tv_nsec);
+    }
+
+    // budget covering two expected gaps if the next packet is likely to arrive within max
+    std::uint64_t phaseBudget(double gapNs, std::uint64_t minNs, std::uint64_t maxNs) noexcept
+    {
+        if (gapNs <= 0.0 or gapNs > static_cast<double>(maxNs))
+            return minNs;
+        return std::clamp(static_cast<std::uint64_t>(2.0 * gapNs), minNs, maxNs);
+    }
+}
+
+WaitStrategy::WaitStrategy(WaitConfig config)
+    : config_(config)
+    , epollFd_(epoll_create1(EPOLL_CLOEXEC))
+    , wakeFd_(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC))
+{
+    if (epollFd_ >= 0 and wakeFd_ >= 0)
+    {
+        epoll_event ev {};
+        ev.events = EPOLLIN;
+        ev.data.fd = wakeFd_;
+        epoll_ctl(epollFd_, EPOLL_CTL_ADD, wakeFd_, &ev);
+    }
+    adapt();
+}
+
+WaitStrategy::~WaitStrategy()
+{
+    if (wakeFd_ >= 0) close(wakeFd_);
+    if (epollFd_ >= 0) close(epollFd_);
+}
+
+bool WaitStrategy::watch(int fd) noexcept
+{
+    if (epollFd_ < 0 or fd < 0) return false;
+
+    if (config_.busyPoll > 0)
+    {
+        // driver is polled for up to busyPoll us on blocking reads, needs CAP_NET_ADMIN to raise
+        const int usec { config_.busyPoll };
+        setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec));
+    }
+
+    epoll_event ev {};
+    ev.events = EPOLLIN;
+    ev.data.fd = fd;
+    return 0 == epoll_ctl(epollFd_, EPOLL_CTL_ADD, fd, &ev);
+}
+
+void WaitStrategy::wake() noexcept
+{
+    if (wakeFd_ < 0) return;
+    const std::uint64_t one { 1 };
+    [[maybe_unused]] auto rc { write(wakeFd_, &one, sizeof(one)) };
+}
+
+void WaitStrategy::begin() noexcept
+{
+    stats_ = {};
+    wallStart_ = clock::now();
+    cpuStartNs_ = threadCpuNs();
+    lastArrival_ = wallStart_;
+}
+
+void WaitStrategy::end() noexcept
+{
+    const auto wallNs { std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - wallStart_).count() };
+    const auto cpuNs  { threadCpuNs() - cpuStartNs_ };
+    stats_.cpuUsage = wallNs > 0 ? static_cast<double>(cpuNs) / static_cast<double>(wallNs) : 0.0;
+}
+
+void WaitStrategy::onIteration(std::size_t packets) noexcept
+{
+    const auto now { clock::now() };
+
+    if (0 != packets)
+    {
+        const double gap { static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - lastArrival_).count()) };
+        const double perPacket { gap / static_cast<double>(packets) };
+        avgGapNs_ = 0.0 == avgGapNs_ ? perPacket : avgGapNs_ * 0.875 + perPacket * 0.125;
+        lastArrival_ = now;
+        idle_ = false;
+        return;
+    }
+
+    if (not idle_)
+    {
+        idle_ = true;
+        idleSince_ = now;
+        adapt();
+    }
+
+    const auto idleNs { static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - idleSince_).count()) };
+
+    if (idleNs < spinNs_)
+    {
+        for (std::uint32_t i = 0; i < PAUSES_PER_SPIN; ++i)
+            CPU_RELAX();
+        ++stats_.spins;
+    }
+    else if (idleNs < spinNs_ + yieldNs_)
+    {
+        std::this_thread::yield();
+        ++stats_.yields;
+    }
+    else
+    {
+        park();
+        ++stats_.parks;
+    }
+}
+
+void WaitStrategy::adapt() noexcept
+{
+    const auto& limits { EWaitProfile::LATENCY == config_.profile ? LATENCY_LIMITS : EFFICIENCY_LIMITS };
+    spinNs_  = phaseBudget(avgGapNs_, limits.minSpinNs, limits.maxSpinNs);
+    yieldNs_ = phaseBudget(avgGapNs_, limits.minYieldNs, limits.maxYieldNs);
+}
+
+void WaitStrategy::park() noexcept
+{
+    if (epollFd_ < 0)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        return;
+    }
+
+    epoll_event events[MAX_EVENTS];
+    const int count { epoll_wait(epollFd_, events, MAX_EVENTS, config_.parkTimeout) };
+
+    for (int i = 0; i < count; ++i)
+    {
+        if (events[i].data.fd == wakeFd_)
+        {
+            std::uint64_t value { 0 };
+            [[maybe_unused]] auto rc { read(wakeFd_, &value, sizeof(value)) };
+            continue;
+        }
+        ++stats_.wakeups;
+    }
+}
+
+WaitStats const& WaitStrategy::stats() const noexcept
+{
+    return stats_;
+}
+
+WaitConfig const& WaitStrategy::config() const noexcept
+{
+    return config_;
+}
+
+const char* network::getProfileName(EWaitProfile profile) noexcept
+{
+    switch (profile) {
+        case EWaitProfile::LATENCY:    return "latency";
+        case EWaitProfile::EFFICIENCY: return "efficiency";
+        default: return "undefined";
+    }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <boost/noncopyable.hpp>
+
+namespace network
+{
+    enum class EWaitProfile : std::uint8_t
+    {
+        LATENCY = 0,    // spin long before parking, costs up to a core per loop
+        EFFICIENCY,     // spin briefly, park in epoll as soon as traffic stops
+    };
+
+    struct WaitConfig
+    {
+        EWaitProfile    profile     { EWaitProfile::EFFICIENCY };
+        int             parkTimeout { 50 };     // epoll_wait timeout, ms (stop flag check period)
+        int             busyPoll    { 0 };      // SO_BUSY_POLL for watched sockets, us (0 - off)
+    };
+
+    /*
+     *  Статистика ожидания цикла приема: сколько итераций ушло
+     *  на активное ожидание, уступку и блокировку, и доля процессорного
+     *  времени потока от реального времени работы цикла.
+     */
+    struct WaitStats
+    {
+        std::uint64_t   spins       { 0 };
+        std::uint64_t   yields      { 0 };
+        std::uint64_t   parks       { 0 };
+        std::uint64_t   wakeups     { 0 };      // parks ended by socket readiness
+        double          cpuUsage    { 0.0 };    // thread cpu time / wall time [0..1]
+    };
+
+    /*
+     *  Стратегия ожидания входящих датаграмм: активное ожидание
+     *  (pause), затем уступка ядра (yield), затем блокировка в epoll
+     *  на сокетах. Пороги фаз подстраиваются под интервал между
+     *  пакетами: при плотном трафике дешевле дождаться следующего
+     *  пакета на ядре, при редком - сразу уснуть.
+     */
+    class WaitStrategy : boost::noncopyable
+    {
+    private:
+        using clock = std::chrono::steady_clock;
+
+        WaitConfig          config_;
+        int                 epollFd_    { -1 };
+        int                 wakeFd_     { -1 };     // eventfd to interrupt parking
+
+        // adaptive state
+        clock::time_point   idleSince_  {};
+        clock::time_point   lastArrival_{};
+        double              avgGapNs_   { 0.0 };    // EWMA of packet inter-arrival time
+        std::uint64_t       spinNs_     { 0 };      // current spin phase budget
+        std::uint64_t       yieldNs_    { 0 };      // current yield phase budget
+        bool                idle_       { false };
+
+        // cost accounting
+        WaitStats           stats_      {};
+        clock::time_point   wallStart_  {};
+        std::uint64_t       cpuStartNs_ { 0 };
+
+        void adapt() noexcept;
+        void park() noexcept;
+
+    public:
+        explicit WaitStrategy(WaitConfig config);
+        WaitStrategy() = delete;
+        virtual ~WaitStrategy();
+
+        // Добавить сокет в набор ожидания
+        bool watch(int fd) noexcept;
+        // Прервать блокирующее ожидание (из любого потока)
+        void wake() noexcept;
+
+        // Начало и конец работы цикла (вызываются потоком цикла)
+        void begin() noexcept;
+        void end() noexcept;
+
+        // Итерация цикла обработала packets датаграмм; при 0 - ожидать
+        void onIteration(std::size_t packets) noexcept;
+
+        [[nodiscard]] WaitStats const& stats() const noexcept;
+        [[nodiscard]] WaitConfig const& config() const noexcept;
+
+    };  // WaitStrategy
+
+    // Имя профиля для журнала
+    const char* getProfileName(EWaitProfile profile) noexcept;
+
+}   // namespace network
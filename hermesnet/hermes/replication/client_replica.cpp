@@ -0,0 +1,91 @@
+#include "client_replica.h"
+
+using namespace network::message;
+using namespace network::replication;
+
+ClientReplica::ClientReplica(ReplicaConfig config, std::pmr::memory_resource* memory)
+    : snapshots_(config.snapshots, config.maxEntities, memory)
+    , jitter_(config.jitter)
+{}
+
+bool ClientReplica::receive(const std::uint8_t* data, std::size_t size, clock::time_point arrival) noexcept
+{
+    BitReader r { data, size };
+    Tick tick { 0 };
+    if (not decodeDelta(r, snapshots_, &tick))
+    {
+        ++rejected_;
+        return false;
+    }
+
+    jitter_.push(tick, arrival);
+    return true;
+}
+
+void ClientReplica::bracket(double tick, const Snapshot*& from, const Snapshot*& to) const noexcept
+{
+    // walk back from the newest: the last one passed after the render
+    // tick is the nearest after it, the first one at or before is the start
+    const auto latest { snapshots_.latest()->tick };
+    const double relative { tick - static_cast<double>(latest) };
+
+    from = nullptr;
+    to = nullptr;
+    for (std::size_t back = 0; back < snapshots_.depth(); ++back)
+    {
+        const auto snapshot { snapshots_.find(static_cast<Tick>(latest - back)) };
+        if (nullptr == snapshot) continue;
+
+        if (-static_cast<double>(back) <= relative)
+        {
+            from = snapshot;
+            return;
+        }
+        to = snapshot;
+    }
+}
+
+EntityTransform ClientReplica::interpolate(EntityState const& a, EntityState const& b, float alpha) noexcept
+{
+    const auto ta { dequantize(a) };
+    const auto tb { dequantize(b) };
+
+    EntityTransform out;
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        out.position[i] = ta.position[i] + (tb.position[i] - ta.position[i]) * alpha;
+        out.velocity[i] = ta.velocity[i] + (tb.velocity[i] - ta.velocity[i]) * alpha;
+    }
+
+    // normalized lerp along the shorter arc, q and -q are the same rotation
+    auto const& qa { ta.rotation };
+    auto const& qb { tb.rotation };
+    const float sign { qa.x * qb.x + qa.y * qb.y + qa.z * qb.z + qa.w * qb.w < 0.0f ? -1.0f : 1.0f };
+    Quaternion q {
+        qa.x + (sign * qb.x - qa.x) * alpha,
+        qa.y + (sign * qb.y - qa.y) * alpha,
+        qa.z + (sign * qb.z - qa.z) * alpha,
+        qa.w + (sign * qb.w - qa.w) * alpha
+    };
+    const float length { std::sqrt(q.x * q.x + q.y * q.y + q.z * q.z + q.w * q.w) };
+    if (length > 0.0f)
+    {
+        q.x /= length;
+        q.y /= length;
+        q.z /= length;
+        q.w /= length;
+    }
+    out.rotation = q;
+
+    // discrete state switches at the arrival of the next snapshot
+    out.flags = alpha < 1.0f ? ta.flags : tb.flags;
+    return out;
+}
+
+EntityTransform ClientReplica::extrapolate(EntityState const& a, float seconds) noexcept
+{
+    auto out { dequantize(a) };
+    for (std::size_t i = 0; i < 3; ++i)
+        out.position[i] += out.velocity[i] * seconds;
+    return out;
+}
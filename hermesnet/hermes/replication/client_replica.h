@@ -0,0 +1,130 @@
+#pragma once
+
+#include <cmath>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+#include <memory_resource>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/message/bit_stream.h>
+#include <hermes/replication/snapshot.h>
+#include <hermes/replication/delta_codec.h>
+#include <hermes/replication/jitter_buffer.h>
+
+namespace network::replication
+{
+    struct ReplicaConfig
+    {
+        std::size_t     snapshots   { 32 };     // not shorter than the server ring
+        std::size_t     maxEntities { 4096 };
+        JitterConfig    jitter      {};
+    };
+
+    // Как получено состояние для показа
+    enum class ESample : std::uint8_t
+    {
+        EMPTY = 0,      // nothing received yet
+        INTERPOLATED,   // between two received snapshots
+        EXTRAPOLATED,   // past the newest snapshot by velocity
+        HELD            // before the oldest snapshot, shown as is
+    };
+
+    /*
+     * Мир на стороне клиента. Принятые дельты применяются к кольцу
+     * снимков (то же кольцо служит базой для следующих дельт), время
+     * прихода уходит в JitterBuffer. sample() показывает мир с
+     * задержкой воспроизведения: состояние интерполируется между
+     * снимками по обе стороны от тика показа, а если новый снимок
+     * опаздывает - экстраполируется по скорости не дальше
+     * maxExtrapolation. Снимки только читаются, sample() не выделяет
+     * память и не копирует снимки.
+     */
+    class ClientReplica : boost::noncopyable
+    {
+    public:
+        using clock = JitterBuffer::clock;
+
+    private:
+        SnapshotRing    snapshots_;
+        JitterBuffer    jitter_;
+        std::uint64_t   rejected_   { 0 };  // deltas without baseline or damaged
+
+        // Снимки по обе стороны от тика показа (nullptr - нет)
+        void bracket(double tick, const Snapshot*& from, const Snapshot*& to) const noexcept;
+
+        static EntityTransform interpolate(EntityState const& a, EntityState const& b, float alpha) noexcept;
+        static EntityTransform extrapolate(EntityState const& a, float seconds) noexcept;
+
+    public:
+        explicit ClientReplica(ReplicaConfig config, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+        // Применить закодированную дельту, принятую в момент arrival
+        bool receive(const std::uint8_t* data, std::size_t size, clock::time_point arrival) noexcept;
+
+        /*
+         * Состояние мира на момент now: handler(EntityId, EntityTransform const&)
+         * вызывается для каждой сущности в порядке id.
+         */
+        template <typename Handler>
+        ESample sample(clock::time_point now, Handler&& handler) const noexcept;
+
+        // Последний примененный снимок, его тик подтверждается серверу
+        [[nodiscard]] const Snapshot* latest() const noexcept { return snapshots_.latest(); }
+        [[nodiscard]] JitterBuffer const& jitter() const noexcept { return jitter_; }
+        [[nodiscard]] std::uint64_t rejected() const noexcept { return rejected_; }
+
+    };  // ClientReplica
+
+}   // network::replication
+
+// ********************************* IMPLEMENTATION **********************************
+
+template <typename Handler>
+network::replication::ESample network::replication::ClientReplica::sample(clock::time_point now, Handler&& handler) const noexcept
+{
+    const auto latest { snapshots_.latest() };
+    if (nullptr == latest or not jitter_.synced()) return ESample::EMPTY;
+
+    const double tick { jitter_.renderTick(now) };
+    const Snapshot* from { nullptr };
+    const Snapshot* to { nullptr };
+    bracket(tick, from, to);
+
+    if (nullptr == from)
+    {
+        // render time is before everything still in the ring
+        for (auto const& e : to->entities)
+            handler(e.id, dequantize(e));
+        return ESample::HELD;
+    }
+
+    const double ahead { tick - static_cast<double>(from->tick) };
+    if (nullptr == to)
+    {
+        const double limit { std::chrono::duration<double>(jitter_.config().maxExtrapolation).count() };
+        const double interval { std::chrono::duration<double>(jitter_.config().tickInterval).count() };
+        const auto seconds { static_cast<float>(std::clamp(ahead * interval, 0.0, limit)) };
+
+        for (auto const& e : from->entities)
+            handler(e.id, extrapolate(e, seconds));
+        return 0.0f == seconds ? ESample::INTERPOLATED : ESample::EXTRAPOLATED;
+    }
+
+    // entities of both snapshots are in id order; removed ones stay until
+    // the render time passes them, new ones appear once it reaches them
+    const auto alpha { static_cast<float>(ahead / static_cast<double>(to->tick - from->tick)) };
+    auto b { to->entities.begin() };
+    const auto end { to->entities.end() };
+    for (auto const& a : from->entities)
+    {
+        while (b != end and b->id < a.id) ++b;
+        if (b != end and b->id == a.id)
+            handler(a.id, interpolate(a, *b, alpha));
+        else
+            handler(a.id, dequantize(a));
+    }
+    return ESample::INTERPOLATED;
+}
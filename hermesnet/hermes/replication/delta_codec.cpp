@@ -0,0 +1,109 @@
+#include "delta_codec.h"
+
+#include <limits>
+#include <algorithm>
+
+using namespace network::message;
+using namespace network::replication;
+
+namespace
+{
+    constexpr EntityId REMOVED_ID { std::numeric_limits<EntityId>::max() };
+
+    // reads the next id of a list, false at the list end or on an id
+    // out of [next, maxEntities) (broken is set, the update is rejected)
+    bool readId(BitReader& r, std::size_t maxEntities, EntityId& next, EntityId& id, bool& broken) noexcept
+    {
+        const auto code { r.readVarint() };
+        if (0 == code or r.overflow()) return false;
+
+        // ids are dense and ascending, the gap is checked before next + code - 1 can wrap
+        if (next >= maxEntities or code - 1 >= maxEntities - next)
+        {
+            broken = true;
+            return false;
+        }
+
+        id = static_cast<EntityId>(next + code - 1);
+        next = id + 1;
+        return true;
+    }
+}
+
+DeltaStats network::replication::encodeDelta(Snapshot const& current, Snapshot const* baseline, BitWriter& w) noexcept
+{
+    return encodeDelta(current, baseline, w, AllEntities {});
+}
+
+bool network::replication::decodeDelta(BitReader& r, SnapshotRing& received, Tick* decoded) noexcept
+{
+    const auto tick { static_cast<Tick>(r.read(32)) };
+    const bool full { r.readBool() };
+    if (nullptr != decoded) *decoded = tick;
+
+    // a tick behind the ring would replace a newer snapshot in its slot
+    if (r.overflow() or not received.window(tick)) return false;
+
+    const Snapshot* baseline { nullptr };
+    if (not full)
+    {
+        const auto distance { r.readVarint() };
+        // the result takes the baseline slot
+        if (0 == distance or distance >= received.depth()) return false;
+
+        baseline = received.find(static_cast<Tick>(tick - distance));
+        if (nullptr == baseline) return false;
+    }
+
+    // decoded aside, the ring changes only on success
+    auto& out { received.begin(tick) };
+    if (nullptr != baseline)
+        out.entities.assign(baseline->entities.begin(), baseline->entities.end());
+
+    auto& entities { out.entities };
+    const auto known { entities.size() };   // baseline part, in id order
+    const auto maxEntities { entities.capacity() };
+
+    std::size_t pos { 0 };
+    EntityId next { 0 };
+    EntityId id;
+    bool broken { false };
+    while (readId(r, maxEntities, next, id, broken))
+    {
+        const auto mask { static_cast<FieldMask>(r.read(FIELD_COUNT)) };
+
+        while (pos < known and entities[pos].id < id) ++pos;
+        if (pos < known and entities[pos].id == id)
+        {
+            readFields(r, entities[pos], mask);
+            continue;
+        }
+
+        EntityState state;
+        state.id = id;
+        readFields(r, state, mask);
+        if (not out.add(state)) return false;
+    }
+    if (broken) return false;
+
+    pos = 0;
+    next = 0;
+    bool removed { false };
+    while (readId(r, maxEntities, next, id, broken))
+    {
+        while (pos < known and entities[pos].id < id) ++pos;
+        if (pos < known and entities[pos].id == id)
+        {
+            entities[pos++].id = REMOVED_ID;
+            removed = true;
+        }
+    }
+
+    if (broken or r.overflow()) return false;
+
+    if (removed)
+        entities.erase(std::remove_if(entities.begin(), entities.end(),
+                                      [](EntityState const& e) { return REMOVED_ID == e.id; }), entities.end());
+    received.commit(out);
+    return true;
+}
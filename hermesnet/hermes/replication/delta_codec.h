@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+#include <hermes/message/bit_stream.h>
+#include <hermes/replication/snapshot.h>
+
+namespace network::replication
+{
+    /* ------------- Delta snapshot format -------------
+     *
+     * tick                 32 bits
+     * full                 1 bit
+     * baseline distance    varint, tick - baseline tick (if not full)
+     * changed entities     [id code][field mask][fields]..., 0 ends
+     * removed entities     [id code]..., 0 ends
+     *
+     * Entities go in id order, id code is the distance
+     * to the next id after the previous one plus one
+     * (consecutive ids take one byte). New entities
+     * and full snapshots send every field. Unchanged
+     * entities are not sent at all.
+     * ------------------------------------------------- */
+
+    struct DeltaStats
+    {
+        std::uint32_t   changed { 0 };  // entities with sent fields
+        std::uint32_t   removed { 0 };
+        bool            full    { false };
+    };
+
+    /*
+     * Что отправить клиенту (view кодирования):
+     *  held(base)          - клиент держит сущность базового снимка
+     *  relevant(cur)       - сущность должна остаться или появиться у клиента
+     *  fields(cur, base)   - поля к отправке, base - nullptr, если клиент
+     *                        сущность не держит; 0 для новой - отложить
+     * По умолчанию клиенту отправляется весь мир.
+     */
+    struct AllEntities
+    {
+        bool held(EntityState const&) const noexcept { return true; }
+        bool relevant(EntityState const&) const noexcept { return true; }
+        FieldMask fields(EntityState const& cur, EntityState const* base) const noexcept {
+            return nullptr != base ? changedFields(cur, *base) : FIELD_MASK_ALL;
+        }
+    };
+
+    /*
+     * Закодировать снимок current относительно baseline (nullptr -
+     * полный снимок, клиент ничего не держит).
+     */
+    template <typename View>
+    DeltaStats encodeDelta(Snapshot const& current, Snapshot const* baseline, message::BitWriter& w, View&& view) noexcept;
+
+    DeltaStats encodeDelta(Snapshot const& current, Snapshot const* baseline, message::BitWriter& w) noexcept;
+
+    /*
+     * Применить дельту к базовому снимку из received, результат
+     * публикуется в received под тиком дельты. false - базового
+     * снимка уже (или еще) нет, тик позади окна кольца, либо данные
+     * повреждены; received при этом не меняется.
+     * decoded - тик дельты, если заголовок прочитан.
+     */
+    bool decodeDelta(message::BitReader& r, SnapshotRing& received, Tick* decoded = nullptr) noexcept;
+
+}   // network::replication
+
+// ********************************* IMPLEMENTATION **********************************
+
+namespace network::replication::detail
+{
+    class IdWriter
+    {
+    private:
+        EntityId next_ { 0 };
+
+    public:
+        void write(message::BitWriter& w, EntityId id) noexcept {
+            w.writeVarint(static_cast<std::uint64_t>(id - next_) + 1);
+            next_ = id + 1;
+        }
+
+        static void end(message::BitWriter& w) noexcept { w.writeVarint(0); }
+    };
+}
+
+template <typename View>
+network::replication::DeltaStats network::replication::encodeDelta(Snapshot const& current, Snapshot const* baseline,
+                                                                   message::BitWriter& w, View&& view) noexcept
+{
+    DeltaStats stats;
+    stats.full = nullptr == baseline;
+
+    w.write(current.tick, 32);
+    w.writeBool(stats.full);
+    if (not stats.full)
+        w.writeVarint(current.tick - baseline->tick);
+
+    auto const& now { current.entities };
+    const auto none { now.end() };
+    auto const& base { stats.full ? now : baseline->entities };
+    const auto baseEnd { stats.full ? now.begin() : base.end() };   // empty baseline for full
+
+    // changed and new entities, both lists are in id order
+    detail::IdWriter changed;
+    auto b { base.begin() };
+    for (auto c { now.begin() }; c != none; ++c)
+    {
+        if (not view.relevant(*c)) continue;
+
+        while (b != baseEnd and (b->id < c->id or not view.held(*b))) ++b;
+        const bool known { b != baseEnd and b->id == c->id };
+        const FieldMask mask { view.fields(*c, known ? &*b : nullptr) };
+        if (0 == mask) continue;
+
+        changed.write(w, c->id);
+        w.write(mask, FIELD_COUNT);
+        writeFields(w, *c, mask);
+        ++stats.changed;
+    }
+    detail::IdWriter::end(w);
+
+    // entities the client holds which it should not have now
+    detail::IdWriter removed;
+    auto c { now.begin() };
+    for (b = base.begin(); b != baseEnd; ++b)
+    {
+        if (not view.held(*b)) continue;
+
+        while (c != none and c->id < b->id) ++c;
+        if (c != none and c->id == b->id and view.relevant(*c)) continue;
+
+        removed.write(w, b->id);
+        ++stats.removed;
+    }
+    detail::IdWriter::end(w);
+
+    return stats;
+}
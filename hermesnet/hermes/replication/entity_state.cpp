@@ -0,0 +1,100 @@
+#include "entity_state.h"
+
+using namespace network::message;
+using namespace network::replication;
+
+namespace
+{
+    constexpr unsigned ROTATION_PACKED_BITS { 2 + 3 * ROTATION_BITS };
+    static_assert(ROTATION_PACKED_BITS <= 32);
+
+    std::uint32_t packRotation(Quaternion const& q) noexcept
+    {
+        std::uint8_t packed[4] { 0, 0, 0, 0 };
+        BitWriter w { packed, sizeof(packed) };
+        w.writeQuaternion(q, ROTATION_BITS);
+        w.flush();
+        return static_cast<std::uint32_t>(bits::loadLE(packed, sizeof(packed)));
+    }
+
+    Quaternion unpackRotation(std::uint32_t rotation) noexcept
+    {
+        std::uint8_t packed[4];
+        bits::storeLE(packed, rotation, sizeof(packed));
+        BitReader r { packed, sizeof(packed) };
+        return r.readQuaternion(ROTATION_BITS);
+    }
+}
+
+EntityState network::replication::quantize(EntityId id, EntityTransform const& transform) noexcept
+{
+    EntityState state;
+    state.id = id;
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        state.position[i] = static_cast<std::uint32_t>(bits::quantize(transform.position[i], -WORLD_BOUND, WORLD_BOUND, POSITION_BITS));
+        state.velocity[i] = static_cast<std::uint16_t>(bits::quantize(transform.velocity[i], -SPEED_BOUND, SPEED_BOUND, VELOCITY_BITS));
+    }
+    state.rotation = packRotation(transform.rotation);
+    state.flags = transform.flags;
+    return state;
+}
+
+EntityTransform network::replication::dequantize(EntityState const& state) noexcept
+{
+    EntityTransform transform;
+    for (std::size_t i = 0; i < 3; ++i)
+    {
+        transform.position[i] = bits::dequantize(state.position[i], -WORLD_BOUND, WORLD_BOUND, POSITION_BITS);
+        transform.velocity[i] = bits::dequantize(state.velocity[i], -SPEED_BOUND, SPEED_BOUND, VELOCITY_BITS);
+    }
+    transform.rotation = unpackRotation(state.rotation);
+    transform.flags = state.flags;
+    return transform;
+}
+
+FieldMask network::replication::changedFields(EntityState const& current, EntityState const& baseline) noexcept
+{
+    // no branches: each comparison sets its field bit
+    const std::uint32_t position { (current.position[0] ^ baseline.position[0]) | (current.position[1] ^ baseline.position[1])
+                                 | (current.position[2] ^ baseline.position[2]) };
+    const std::uint32_t velocity { static_cast<std::uint32_t>((current.velocity[0] ^ baseline.velocity[0]) | (current.velocity[1] ^ baseline.velocity[1])
+                                 | (current.velocity[2] ^ baseline.velocity[2])) };
+
+    return static_cast<FieldMask>(((0 != position) << FIELD_POSITION)
+                                | ((0 != velocity) << FIELD_VELOCITY)
+                                | ((current.rotation != baseline.rotation) << FIELD_ROTATION)
+                                | ((current.flags != baseline.flags) << FIELD_FLAGS));
+}
+
+std::uint32_t network::replication::fieldBits(FieldMask mask) noexcept
+{
+    return ((mask >> FIELD_POSITION) & 1) * 3 * POSITION_BITS
+         + ((mask >> FIELD_VELOCITY) & 1) * 3 * VELOCITY_BITS
+         + ((mask >> FIELD_ROTATION) & 1) * ROTATION_PACKED_BITS
+         + ((mask >> FIELD_FLAGS) & 1) * 16;
+}
+
+void network::replication::writeFields(BitWriter& w, EntityState const& state, FieldMask mask) noexcept
+{
+    if (mask & (1u << FIELD_POSITION))
+        for (auto v : state.position) w.write(v, POSITION_BITS);
+    if (mask & (1u << FIELD_VELOCITY))
+        for (auto v : state.velocity) w.write(v, VELOCITY_BITS);
+    if (mask & (1u << FIELD_ROTATION))
+        w.write(state.rotation, ROTATION_PACKED_BITS);
+    if (mask & (1u << FIELD_FLAGS))
+        w.writeVarint(state.flags);
+}
+
+void network::replication::readFields(BitReader& r, EntityState& state, FieldMask mask) noexcept
+{
+    if (mask & (1u << FIELD_POSITION))
+        for (auto& v : state.position) v = static_cast<std::uint32_t>(r.read(POSITION_BITS));
+    if (mask & (1u << FIELD_VELOCITY))
+        for (auto& v : state.velocity) v = static_cast<std::uint16_t>(r.read(VELOCITY_BITS));
+    if (mask & (1u << FIELD_ROTATION))
+        state.rotation = static_cast<std::uint32_t>(r.read(ROTATION_PACKED_BITS));
+    if (mask & (1u << FIELD_FLAGS))
+        state.flags = static_cast<std::uint32_t>(r.readVarint());
+}
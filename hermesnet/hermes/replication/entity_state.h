@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include <hermes/message/bit_stream.h>
+
+namespace network::replication
+{
+    // Индекс сущности в мире, плотный: [0, maxEntities)
+    using EntityId  = std::uint32_t;
+    using FieldMask = std::uint8_t;
+
+    constexpr float     WORLD_BOUND     { 4096.0f };    // meters, position in [-bound, bound]
+    constexpr float     SPEED_BOUND     { 64.0f };      // meters per second
+    constexpr unsigned  POSITION_BITS   { 24 };         // ~0.5 mm
+    constexpr unsigned  VELOCITY_BITS   { 12 };         // ~3 cm/s
+    constexpr unsigned  ROTATION_BITS   { 10 };         // per smallest three component
+
+    // Поля состояния, изменения отслеживаются по каждому полю
+    enum EField : std::uint8_t
+    {
+        FIELD_POSITION = 0,
+        FIELD_VELOCITY,
+        FIELD_ROTATION,
+        FIELD_FLAGS,
+        FIELD_COUNT
+    };
+
+    constexpr FieldMask FIELD_MASK_ALL { (1u << FIELD_COUNT) - 1 };
+
+    /*
+     * Состояние сущности в игровых единицах
+     */
+    struct EntityTransform
+    {
+        float                   position[3] { 0.0f, 0.0f, 0.0f };
+        float                   velocity[3] { 0.0f, 0.0f, 0.0f };
+        message::Quaternion     rotation    {};
+        std::uint32_t           flags       { 0 };  // game specific state bits
+    };
+
+    /*
+     * Квантованное состояние сущности в снимке. Сервер сравнивает
+     * и отправляет именно его, поэтому у клиента после декодирования
+     * базовый снимок совпадает с серверным бит в бит.
+     *
+     * Structure size - 32 bytes
+     */
+    struct EntityState
+    {
+        EntityId        id          { 0 };
+        std::uint32_t   position[3] { 0, 0, 0 };    // POSITION_BITS each
+        std::uint16_t   velocity[3] { 0, 0, 0 };    // VELOCITY_BITS each
+        std::uint32_t   rotation    { 0 };          // 2 + 3 * ROTATION_BITS, packed smallest three
+        std::uint32_t   flags       { 0 };
+    };
+
+    static_assert(std::is_trivially_copyable_v<EntityState> and sizeof(EntityState) == 32);
+
+    EntityState quantize(EntityId id, EntityTransform const& transform) noexcept;
+    EntityTransform dequantize(EntityState const& state) noexcept;
+
+    // Поля, отличающиеся от базового состояния
+    FieldMask changedFields(EntityState const& current, EntityState const& baseline) noexcept;
+
+    // Оценка размера полей маски в битах (flags - varint, берется 16 бит)
+    std::uint32_t fieldBits(FieldMask mask) noexcept;
+
+    // Запись/чтение полей из маски (без id и самой маски)
+    void writeFields(message::BitWriter& w, EntityState const& state, FieldMask mask) noexcept;
+    void readFields(message::BitReader& r, EntityState& state, FieldMask mask) noexcept;
+
+}   // network::replication
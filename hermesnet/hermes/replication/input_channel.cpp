@@ -0,0 +1,123 @@
+#include "input_channel.h"
+
+#include <algorithm>
+
+using namespace network::message;
+using namespace network::replication;
+
+InputSender::InputSender(InputConfig config)
+    : config_(config)
+    , ring_(config.redundancy * config.frameBytes, 0)
+{}
+
+InputFrame InputSender::push(const std::uint8_t* input) noexcept
+{
+    std::copy_n(input, config_.frameBytes, ring_.data() + (next_ % config_.redundancy) * config_.frameBytes);
+    return next_++;
+}
+
+void InputSender::acknowledge(InputFrame frame) noexcept
+{
+    // acks may arrive out of order and must not pass the pushed frames
+    const auto after { static_cast<InputFrame>(frame + 1) };
+    if (newer(after, acked_) and not newer(after, next_)) acked_ = after;
+}
+
+std::size_t InputSender::encode(Body& body) const noexcept
+{
+    const auto size { config_.frameBytes };
+    const auto pending { static_cast<std::size_t>(next_ - acked_) };
+    const auto room { (CAPACITY - std::min<std::size_t>(body.size, CAPACITY)) * 8 };
+    if (0 == pending or room < 32 + 4 + 8 * size) return 0;
+
+    // older frames are added while they fit
+    const InputFrame newest { next_ - 1 };
+    std::size_t bits { 32 + 4 + 8 * size };
+    std::size_t count { 1 };
+    const auto limit { std::min({ pending, config_.redundancy, MAX_REDUNDANCY }) };
+    for (; count < limit; ++count)
+    {
+        const auto older { slot(newest - count) };
+        const auto later { slot(newest - count + 1) };
+        std::size_t cost { 1 };
+        if (not std::equal(older, older + size, later))
+        {
+            cost += size;
+            for (std::size_t i = 0; i < size; ++i)
+                cost += older[i] != later[i] ? 8 : 0;
+        }
+        if (bits + cost > room) break;
+        bits += cost;
+    }
+
+    BitWriter w { body };
+    w.write(newest, 32);
+    w.write(count - 1, 4);
+
+    const auto latest { slot(newest) };
+    for (std::size_t i = 0; i < size; ++i)
+        w.write(latest[i], 8);
+
+    for (std::size_t f = 1; f < count; ++f)
+    {
+        const auto older { slot(newest - f) };
+        const auto later { slot(newest - f + 1) };
+        std::uint64_t mask { 0 };
+        for (std::size_t i = 0; i < size; ++i)
+            mask |= std::uint64_t(older[i] != later[i]) << i;
+
+        w.writeBool(0 == mask);
+        if (0 == mask) continue;
+
+        w.write(mask, static_cast<unsigned>(size));
+        for (std::size_t i = 0; i < size; ++i)
+            if ((mask >> i) & 1) w.write(older[i] ^ later[i], 8);
+    }
+    w.flush();
+    return count;
+}
+
+InputReceiver::InputReceiver(InputConfig config)
+    : config_(config)
+    , started_(config.maxClients, 0)
+    , latest_(config.maxClients, 0)
+    , window_(config.maxClients, 0)
+    , repeated_(config.maxClients, 0)
+{}
+
+void InputReceiver::reset(ClientIndex client) noexcept
+{
+    started_[client] = 0;
+    latest_[client] = 0;
+    window_[client] = 0;
+    repeated_[client] = 0;
+}
+
+bool InputReceiver::accept(ClientIndex client, InputFrame frame) noexcept
+{
+    if (0 == started_[client])
+    {
+        started_[client] = 1;
+        latest_[client] = frame;
+        window_[client] = 1;
+        return true;
+    }
+
+    const auto ahead { static_cast<std::int32_t>(frame - latest_[client]) };
+    if (ahead > 0)
+    {
+        window_[client] = static_cast<std::size_t>(ahead) < INPUT_WINDOW ? (window_[client] << ahead) | 1 : 1;
+        latest_[client] = frame;
+        return true;
+    }
+
+    const auto back { static_cast<std::uint32_t>(-static_cast<std::int64_t>(ahead)) };
+    const auto bit { back < INPUT_WINDOW ? std::uint64_t(1) << back : 0 };
+    if (0 == bit or (window_[client] & bit))
+    {
+        ++repeated_[client];
+        return false;
+    }
+    window_[client] |= bit;
+    return true;
+}
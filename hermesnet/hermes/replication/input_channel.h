@@ -0,0 +1,166 @@
+#pragma once
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <type_traits>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/message/body.h>
+#include <hermes/message/bit_stream.h>
+#include <hermes/replication/snapshot.h>
+
+namespace network::replication
+{
+    // Номер кадра ввода клиента, идет подряд с переполнением
+    using InputFrame = std::uint32_t;
+
+    constexpr std::size_t MAX_INPUT_BYTES   { 32 };
+    constexpr std::size_t MAX_REDUNDANCY    { 16 };
+    constexpr std::size_t INPUT_WINDOW      { 64 };     // frames, server side dedupe window
+
+    struct InputConfig
+    {
+        std::size_t frameBytes  { 16 };     // input of one frame, [1..MAX_INPUT_BYTES]
+        std::size_t redundancy  { 8 };      // frames per packet, [1..MAX_REDUNDANCY]
+        std::size_t maxClients  { 256 };    // server side
+    };
+
+    // Действие ввода типа id: IdType::INPUT_ACTION, если объявлено; без него сокеты клиентов ввод не несут
+    template <typename IdType, typename = void>
+    struct InputAction { static constexpr bool declared { false }; };
+
+    template <typename IdType>
+    struct InputAction<IdType, std::void_t<decltype(IdType::INPUT_ACTION)>>
+    {
+        static constexpr bool declared { true };
+        static constexpr std::uint16_t value { static_cast<std::uint16_t>(IdType::INPUT_ACTION) };
+    };
+
+    /* ------------- Input redundancy format -------------
+     *
+     * newest frame     32 bits
+     * frames - 1       4 bits
+     * newest input     frameBytes bytes as is
+     * older inputs     newest to oldest, each XOR with
+     *                  the next newer one:
+     *                  [same 1 bit] or
+     *                  [0][nonzero byte mask][nonzero bytes]
+     *
+     * Inputs of neighbour frames differ in a few bytes,
+     * so the repeated frames cost a bit or a few bytes.
+     * --------------------------------------------------- */
+
+    /*
+     * Клиентская сторона: кольцо последних кадров ввода. Каждый пакет
+     * повторяет до redundancy последних неподтвержденных кадров, так
+     * что потерянный пакет восстанавливается следующим без повторной
+     * отправки по RTT. Подтверждение сервера сокращает повтор.
+     */
+    class InputSender : boost::noncopyable
+    {
+    private:
+        InputConfig                 config_;
+        std::vector<std::uint8_t>   ring_;          // redundancy * frameBytes
+        InputFrame                  next_   { 0 };  // frame of the next push
+        InputFrame                  acked_  { 0 };  // frames before it are on the server
+
+        [[nodiscard]] const std::uint8_t* slot(InputFrame frame) const noexcept {
+            return ring_.data() + (frame % config_.redundancy) * config_.frameBytes;
+        }
+
+    public:
+        explicit InputSender(InputConfig config);
+
+        // Ввод очередного кадра (frameBytes байт), возвращает его номер
+        InputFrame push(const std::uint8_t* input) noexcept;
+
+        // Сервер получил все кадры до frame включительно
+        void acknowledge(InputFrame frame) noexcept;
+
+        // Дописать пакет к body: сколько кадров поместилось (0 - нечего отправлять)
+        std::size_t encode(message::Body& body) const noexcept;
+
+        [[nodiscard]] InputFrame next() const noexcept { return next_; }
+
+    };  // InputSender
+
+    /*
+     * Серверная сторона: отсев повторов по номеру кадра. По клиенту
+     * хранится последний кадр и битовая маска окна из INPUT_WINDOW
+     * предыдущих, проверка и отметка кадра - O(1). Кадры старше окна
+     * отбрасываются. Состояние клиентов - по полям в отдельных массивах.
+     */
+    class InputReceiver : boost::noncopyable
+    {
+    private:
+        InputConfig                 config_;
+        std::vector<std::uint8_t>   started_;   // a frame was received
+        std::vector<InputFrame>     latest_;
+        std::vector<std::uint64_t>  window_;    // bit i - frame latest - i received
+        std::vector<std::uint64_t>  repeated_;  // frames dropped as duplicates or stale
+
+        // Новый кадр отмечается принятым
+        bool accept(ClientIndex client, InputFrame frame) noexcept;
+
+    public:
+        explicit InputReceiver(InputConfig config);
+
+        void reset(ClientIndex client) noexcept;
+
+        /*
+         * Разобрать пакет клиента: handler(InputFrame, const std::uint8_t*)
+         * вызывается для каждого нового кадра от старых к новым.
+         * false - пакет поврежден.
+         */
+        template <typename Handler>
+        bool receive(ClientIndex client, message::BitReader& r, Handler&& handler) noexcept;
+
+        // Последний принятый кадр, подтверждается клиенту
+        [[nodiscard]] bool started(ClientIndex client) const noexcept { return 0 != started_[client]; }
+        [[nodiscard]] InputFrame latest(ClientIndex client) const noexcept { return latest_[client]; }
+        [[nodiscard]] std::uint64_t repeated(ClientIndex client) const noexcept { return repeated_[client]; }
+
+    };  // InputReceiver
+
+}   // network::replication
+
+// ********************************* IMPLEMENTATION **********************************
+
+template <typename Handler>
+bool network::replication::InputReceiver::receive(ClientIndex client, message::BitReader& r, Handler&& handler) noexcept
+{
+    const auto size { config_.frameBytes };
+    const auto newest { static_cast<InputFrame>(r.read(32)) };
+    const auto count { static_cast<std::size_t>(r.read(4)) + 1 };
+
+    // newest first on the wire, restored into a stack buffer
+    std::array<std::uint8_t, MAX_REDUNDANCY * MAX_INPUT_BYTES> frames;
+    for (std::size_t i = 0; i < size; ++i)
+        frames[i] = static_cast<std::uint8_t>(r.read(8));
+
+    for (std::size_t f = 1; f < count; ++f)
+    {
+        auto out { frames.data() + f * size };
+        const auto later { out - size };
+        if (r.readBool())
+        {
+            std::copy_n(later, size, out);
+            continue;
+        }
+
+        const auto mask { r.read(static_cast<unsigned>(size)) };
+        for (std::size_t i = 0; i < size; ++i)
+            out[i] = later[i] ^ ((mask >> i) & 1 ? static_cast<std::uint8_t>(r.read(8)) : 0);
+    }
+    if (r.overflow()) return false;
+
+    for (auto f { count }; f-- > 0; )
+    {
+        const auto frame { static_cast<InputFrame>(newest - f) };
+        if (accept(client, frame)) handler(frame, static_cast<const std::uint8_t*>(frames.data() + f * size));
+    }
+    return true;
+}
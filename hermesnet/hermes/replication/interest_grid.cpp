@@ -0,0 +1,110 @@
+#include "interest_grid.h"
+
+#include <cmath>
+
+using namespace network::replication;
+
+InterestGrid::InterestGrid(InterestConfig config)
+    : config_(config)
+    , side_(static_cast<std::uint32_t>(std::ceil(2.0f * WORLD_BOUND / config.cellSize)))
+    , words_((config.maxEntities + 63) / 64)
+    , head_(static_cast<std::size_t>(side_) * side_, NONE)
+    , x_(config.maxEntities, 0.0f)
+    , z_(config.maxEntities, 0.0f)
+    , cell_(config.maxEntities, NONE)
+    , next_(config.maxEntities, NONE)
+    , prev_(config.maxEntities, NONE)
+    , active_(config.maxClients, 0)
+    , viewX_(config.maxClients, 0.0f)
+    , viewZ_(config.maxClients, 0.0f)
+    , radius_(config.maxClients, 0.0f)
+    , relevant_(config.maxClients * words_, 0)
+    , scratch_(words_, 0)
+{}
+
+std::uint32_t InterestGrid::axis(float v) const noexcept
+{
+    const auto c { static_cast<std::int64_t>(std::floor((v + WORLD_BOUND) / config_.cellSize)) };
+    return static_cast<std::uint32_t>(std::clamp<std::int64_t>(c, 0, side_ - 1));
+}
+
+std::uint32_t InterestGrid::cellIndex(float x, float z) const noexcept
+{
+    return axis(z) * side_ + axis(x);
+}
+
+void InterestGrid::link(EntityId id, std::uint32_t cell) noexcept
+{
+    prev_[id] = NONE;
+    next_[id] = head_[cell];
+    if (NONE != head_[cell]) prev_[head_[cell]] = id;
+    head_[cell] = id;
+    cell_[id] = cell;
+}
+
+void InterestGrid::unlink(EntityId id) noexcept
+{
+    if (NONE != prev_[id]) next_[prev_[id]] = next_[id];
+    else head_[cell_[id]] = next_[id];
+    if (NONE != next_[id]) prev_[next_[id]] = prev_[id];
+    cell_[id] = NONE;
+}
+
+void InterestGrid::place(EntityId id, float x, float z) noexcept
+{
+    x_[id] = x;
+    z_[id] = z;
+
+    // most moves stay inside the cell
+    const auto cell { cellIndex(x, z) };
+    if (cell == cell_[id]) return;
+
+    if (NONE != cell_[id]) unlink(id);
+    link(id, cell);
+}
+
+void InterestGrid::remove(EntityId id) noexcept
+{
+    if (NONE != cell_[id]) unlink(id);
+}
+
+void InterestGrid::setViewer(ClientIndex client, float x, float z, float radius) noexcept
+{
+    active_[client] = 1;
+    viewX_[client] = x;
+    viewZ_[client] = z;
+    radius_[client] = radius;
+}
+
+void InterestGrid::removeViewer(ClientIndex client) noexcept
+{
+    active_[client] = 0;
+    std::fill_n(relevant_.begin() + client * words_, words_, 0);
+}
+
+void InterestGrid::update() noexcept
+{
+    changes_ = 0;
+    for (ClientIndex client = 0; client < config_.maxClients; ++client)
+        if (active_[client]) updateViewer(client);
+}
+
+void InterestGrid::updateViewer(ClientIndex client) noexcept
+{
+    auto row { relevant_.data() + client * words_ };
+    const float enter2 { radius_[client] * radius_[client] };
+    const float exit { radius_[client] * (1.0f + config_.hysteresis) };
+
+    // everything outside the exit radius drops out by not being set
+    std::fill(scratch_.begin(), scratch_.end(), 0);
+    query(viewX_[client], viewZ_[client], exit, [&](EntityId id, float d2) {
+        if (d2 <= enter2 or testEntity(row, id))
+            scratch_[id >> 6] |= std::uint64_t(1) << (id & 63);
+    });
+
+    for (std::size_t w = 0; w < words_; ++w)
+    {
+        changes_ += static_cast<std::size_t>(__builtin_popcountll(row[w] ^ scratch_[w]));
+        row[w] = scratch_[w];
+    }
+}
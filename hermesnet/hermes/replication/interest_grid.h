@@ -0,0 +1,128 @@
+#pragma once
+
+#include <limits>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <algorithm>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/replication/snapshot.h>
+
+namespace network::replication
+{
+    struct InterestConfig
+    {
+        std::size_t     maxEntities { 4096 };
+        std::size_t     maxClients  { 256 };
+        float           cellSize    { 64.0f };  // meters, about the typical view radius
+        float           hysteresis  { 0.2f };   // entity leaves at radius * (1 + hysteresis)
+    };
+
+    // Бит сущности в строке релевантности
+    inline bool testEntity(const std::uint64_t* row, EntityId id) noexcept
+    {
+        return 0 != (row[id >> 6] & (std::uint64_t(1) << (id & 63)));
+    }
+
+    /*
+     * Отбор сущностей, интересных клиенту: равномерная сетка по
+     * горизонтальной плоскости (x, z) мира, сущность хранится в
+     * списке своей ячейки и перекладывается только при смене ячейки.
+     * Для каждого клиента (наблюдателя) update() строит битовую строку
+     * релевантных сущностей в радиусе обзора. Сущность входит в обзор
+     * на радиусе radius, а выходит только за radius * (1 + hysteresis),
+     * чтобы объекты на границе не появлялись и не пропадали каждый тик.
+     * Все массивы выделяются при создании.
+     */
+    class InterestGrid : boost::noncopyable
+    {
+    public:
+        struct Viewer
+        {
+            float x         { 0.0f };
+            float z         { 0.0f };
+            float radius    { 0.0f };
+        };
+
+    private:
+        static constexpr std::uint32_t NONE { std::numeric_limits<std::uint32_t>::max() };
+
+        InterestConfig              config_;
+        std::uint32_t               side_;          // cells per axis
+        std::size_t                 words_;         // bitset words per client
+
+        // cells: head of intrusive entity lists
+        std::vector<std::uint32_t>  head_;
+
+        // entities, one row per id
+        std::vector<float>          x_;
+        std::vector<float>          z_;
+        std::vector<std::uint32_t>  cell_;          // NONE - not in the grid
+        std::vector<std::uint32_t>  next_;
+        std::vector<std::uint32_t>  prev_;
+
+        // viewers, one row per client
+        std::vector<std::uint8_t>   active_;
+        std::vector<float>          viewX_;
+        std::vector<float>          viewZ_;
+        std::vector<float>          radius_;
+        std::vector<std::uint64_t>  relevant_;      // maxClients * words_
+        std::vector<std::uint64_t>  scratch_;       // words_
+
+        std::size_t                 changes_ { 0 };
+
+        [[nodiscard]] std::uint32_t cellIndex(float x, float z) const noexcept;
+        [[nodiscard]] std::uint32_t axis(float v) const noexcept;
+        void link(EntityId id, std::uint32_t cell) noexcept;
+        void unlink(EntityId id) noexcept;
+        void updateViewer(ClientIndex client) noexcept;
+
+    public:
+        explicit InterestGrid(InterestConfig config);
+
+        // Добавить или переместить сущность
+        void place(EntityId id, float x, float z) noexcept;
+        void remove(EntityId id) noexcept;
+
+        void setViewer(ClientIndex client, float x, float z, float radius) noexcept;
+        void removeViewer(ClientIndex client) noexcept;
+
+        // Пересчитать релевантность для всех наблюдателей
+        void update() noexcept;
+
+        // Сущности в радиусе от точки: handler(EntityId, float distance2)
+        template <typename Handler>
+        void query(float x, float z, float radius, Handler&& handler) const noexcept;
+
+        [[nodiscard]] bool relevant(ClientIndex client, EntityId id) const noexcept { return testEntity(row(client), id); }
+        [[nodiscard]] const std::uint64_t* row(ClientIndex client) const noexcept { return relevant_.data() + client * words_; }
+        [[nodiscard]] std::size_t words() const noexcept { return words_; }
+        [[nodiscard]] Viewer viewer(ClientIndex client) const noexcept { return { viewX_[client], viewZ_[client], radius_[client] }; }
+        // Сколько сущностей вошло в обзор и вышло из него при последнем update()
+        [[nodiscard]] std::size_t changes() const noexcept { return changes_; }
+
+    };  // InterestGrid
+
+}   // network::replication
+
+// ********************************* IMPLEMENTATION **********************************
+
+template <typename Handler>
+void network::replication::InterestGrid::query(float x, float z, float radius, Handler&& handler) const noexcept
+{
+    const auto x0 { axis(x - radius) }, x1 { axis(x + radius) };
+    const auto z0 { axis(z - radius) }, z1 { axis(z + radius) };
+    const float r2 { radius * radius };
+
+    for (auto cz { z0 }; cz <= z1; ++cz)
+        for (auto cx { x0 }; cx <= x1; ++cx)
+            for (auto id { head_[cz * side_ + cx] }; NONE != id; id = next_[id])
+            {
+                const float dx { x_[id] - x };
+                const float dz { z_[id] - z };
+                const float d2 { dx * dx + dz * dz };
+                if (d2 <= r2) handler(static_cast<EntityId>(id), d2);
+            }
+}
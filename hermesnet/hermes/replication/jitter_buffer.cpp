@@ -0,0 +1,76 @@
+#include "jitter_buffer.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace network::replication;
+
+namespace
+{
+    constexpr double JITTER_GAIN        { 1.0 / 16 };   // RFC 3550
+    constexpr double OFFSET_DRIFT_GAIN  { 1.0 / 256 };  // follows a slower path slowly
+    constexpr double DELAY_GROW_GAIN    { 1.0 / 4 };
+    constexpr double DELAY_SHRINK_GAIN  { 1.0 / 64 };
+}
+
+JitterBuffer::JitterBuffer(JitterConfig config) noexcept
+    : config_(config)
+    , interval_(static_cast<double>(config.tickInterval.count()))
+    , delay_(static_cast<double>(config.minDelay.count()))
+{}
+
+double JitterBuffer::nanos(clock::time_point t) noexcept
+{
+    return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(t.time_since_epoch()).count());
+}
+
+void JitterBuffer::reset() noexcept
+{
+    synced_ = false;
+    jitter_ = 0;
+    delay_ = static_cast<double>(config_.minDelay.count());
+}
+
+void JitterBuffer::push(Tick tick, clock::time_point arrival) noexcept
+{
+    const double transit { nanos(arrival) - static_cast<double>(tick) * interval_ };
+
+    if (not synced_)
+    {
+        synced_ = true;
+        latest_ = tick;
+        offset_ = transit;
+        lastTransit_ = transit;
+        return;
+    }
+
+    // the fastest snapshot shows the real offset, the rest were delayed
+    offset_ = transit < offset_ ? transit : offset_ + (transit - offset_) * OFFSET_DRIFT_GAIN;
+
+    // reordered snapshots say nothing new about jitter
+    if (not newer(tick, latest_)) return;
+    latest_ = tick;
+
+    jitter_ += (std::fabs(transit - lastTransit_) - jitter_) * JITTER_GAIN;
+    lastTransit_ = transit;
+
+    const double target { std::clamp(interval_ + config_.jitterFactor * jitter_,
+                                     static_cast<double>(config_.minDelay.count()),
+                                     static_cast<double>(config_.maxDelay.count())) };
+    delay_ += (target - delay_) * (target > delay_ ? DELAY_GROW_GAIN : DELAY_SHRINK_GAIN);
+}
+
+double JitterBuffer::renderTick(clock::time_point now) const noexcept
+{
+    return (nanos(now) - offset_ - delay_) / interval_;
+}
+
+std::chrono::nanoseconds JitterBuffer::jitter() const noexcept
+{
+    return std::chrono::nanoseconds { static_cast<std::int64_t>(jitter_) };
+}
+
+std::chrono::nanoseconds JitterBuffer::delay() const noexcept
+{
+    return std::chrono::nanoseconds { static_cast<std::int64_t>(delay_) };
+}
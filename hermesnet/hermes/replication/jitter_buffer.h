@@ -0,0 +1,62 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+
+#include <hermes/replication/snapshot.h>
+
+namespace network::replication
+{
+    struct JitterConfig
+    {
+        std::chrono::nanoseconds    tickInterval        { std::chrono::milliseconds(33) };  // server snapshot period
+        std::chrono::nanoseconds    minDelay            { std::chrono::milliseconds(33) };
+        std::chrono::nanoseconds    maxDelay            { std::chrono::milliseconds(250) };
+        std::chrono::nanoseconds    maxExtrapolation    { std::chrono::milliseconds(100) };
+        float                       jitterFactor        { 3.0f };   // delay = tickInterval + jitterFactor * jitter
+    };
+
+    /*
+     * Временная шкала клиента. По времени прихода снимков оценивает
+     * смещение часов сервера (минимальное время в пути) и разброс
+     * задержки (оценка джиттера из RFC 3550). Задержка воспроизведения
+     * держится около одного интервала снимков плюс запас на джиттер:
+     * растет быстро, когда сеть портится, и уменьшается медленно.
+     * renderTick() - дробный тик сервера, который нужно показывать
+     * сейчас; снимков, между которыми он лежит, обычно уже два.
+     */
+    class JitterBuffer
+    {
+    public:
+        using clock = std::chrono::steady_clock;
+
+    private:
+        JitterConfig    config_;
+        double          interval_       { 0 };  // ns
+        bool            synced_         { false };
+        Tick            latest_         { 0 };
+        double          offset_         { 0 };  // ns, local arrival time minus server send time, minimum
+        double          lastTransit_    { 0 };  // ns
+        double          jitter_         { 0 };  // ns
+        double          delay_          { 0 };  // ns, playout delay behind the offset
+
+        [[nodiscard]] static double nanos(clock::time_point t) noexcept;
+
+    public:
+        explicit JitterBuffer(JitterConfig config) noexcept;
+
+        // Снимок tick пришел в момент arrival
+        void push(Tick tick, clock::time_point arrival) noexcept;
+        void reset() noexcept;
+
+        // Тик сервера для показа в момент now
+        [[nodiscard]] double renderTick(clock::time_point now) const noexcept;
+
+        [[nodiscard]] bool synced() const noexcept { return synced_; }
+        [[nodiscard]] std::chrono::nanoseconds jitter() const noexcept;
+        [[nodiscard]] std::chrono::nanoseconds delay() const noexcept;
+        [[nodiscard]] JitterConfig const& config() const noexcept { return config_; }
+
+    };  // JitterBuffer
+
+}   // network::replication
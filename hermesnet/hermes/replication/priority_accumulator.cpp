@@ -0,0 +1,105 @@
+#include "priority_accumulator.h"
+
+#include <numeric>
+#include <algorithm>
+
+using namespace network::replication;
+
+PriorityCandidates::PriorityCandidates(std::size_t maxEntities)
+{
+    ids.reserve(maxEntities);
+    weight.reserve(maxEntities);
+    cost.reserve(maxEntities);
+    priority.reserve(maxEntities);
+    order.reserve(maxEntities);
+}
+
+void PriorityCandidates::clear() noexcept
+{
+    ids.clear();
+    weight.clear();
+    cost.clear();
+}
+
+void PriorityCandidates::add(EntityId id, float w, std::uint32_t bits) noexcept
+{
+    ids.push_back(id);
+    weight.push_back(w);
+    cost.push_back(bits);
+}
+
+PriorityAccumulator::PriorityAccumulator(std::size_t maxEntities, std::size_t maxClients)
+    : maxEntities_(maxEntities)
+    , importance_(maxEntities, 1.0f)
+    , accumulated_(maxEntities * maxClients, 0.0f)
+{}
+
+void PriorityAccumulator::setImportance(EntityId id, float importance) noexcept
+{
+    importance_[id] = importance;
+}
+
+void PriorityAccumulator::reset(ClientIndex client) noexcept
+{
+    std::fill_n(accumulated_.begin() + client * maxEntities_, maxEntities_, 0.0f);
+}
+
+std::size_t PriorityAccumulator::select(ClientIndex client, PriorityCandidates& candidates, std::size_t budget) noexcept
+{
+    const auto n { candidates.size() };
+    auto row { accumulated_.data() + client * maxEntities_ };
+
+    auto const& ids { candidates.ids };
+    auto& priority { candidates.priority };
+    priority.resize(n);
+
+    std::size_t total { 0 };
+    for (std::size_t i = 0; i < n; ++i)
+    {
+        priority[i] = row[ids[i]] += importance_[ids[i]] * candidates.weight[i];
+        total += candidates.cost[i];
+    }
+
+    auto& order { candidates.order };
+    order.resize(n);
+    std::iota(order.begin(), order.end(), 0u);
+
+    std::size_t chosen { n };
+    if (total > budget)
+    {
+        // [chosen, end) holds the best candidates not taken yet
+        const auto first { order.begin() };
+        auto byPriority { [&priority](std::uint32_t a, std::uint32_t b) { return priority[a] > priority[b]; } };
+        const std::size_t average { std::max<std::size_t>(1, total / n) };
+
+        chosen = 0;
+        std::size_t end { n };
+        std::size_t k { std::max<std::size_t>(1, budget / average) };
+        while (chosen < n)
+        {
+            k = std::min(k, end - chosen);
+            std::nth_element(first + chosen, first + chosen + k, first + end, byPriority);
+
+            std::size_t bits { 0 };
+            for (auto i { chosen }; i < chosen + k; ++i) bits += candidates.cost[order[i]];
+
+            if (bits <= budget)
+            {
+                chosen += k;
+                budget -= bits;
+                end = n;
+                k = std::max<std::size_t>(1, budget / average);
+            }
+            else if (1 == k) break;     // the best one left does not fit
+            else
+            {
+                end = chosen + k;
+                k /= 2;
+            }
+        }
+    }
+
+    for (std::size_t i = 0; i < chosen; ++i)
+        row[ids[order[i]]] = 0.0f;
+    return chosen;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/replication/snapshot.h>
+
+namespace network::replication
+{
+    /*
+     * Кандидаты на отправку клиенту за тик, по полям в отдельных
+     * массивах. Память выделяется один раз на поток кодирования.
+     */
+    struct PriorityCandidates
+    {
+        std::vector<EntityId>       ids;
+        std::vector<float>          weight;     // distance factor of this tick, (0, 1]
+        std::vector<std::uint32_t>  cost;       // estimated bits
+        std::vector<float>          priority;   // accumulated, filled by select()
+        std::vector<std::uint32_t>  order;      // selected first, filled by select()
+
+        explicit PriorityCandidates(std::size_t maxEntities);
+
+        void clear() noexcept;
+        void add(EntityId id, float w, std::uint32_t bits) noexcept;
+        [[nodiscard]] std::size_t size() const noexcept { return ids.size(); }
+    };
+
+    /*
+     * Накопитель приоритетов: каждый тик, пока сущность ждет отправки,
+     * к ее приоритету у клиента прибавляется importance * weight (вес
+     * падает с расстоянием), поэтому давно не отправленные сущности
+     * поднимаются сами. select() отбирает лучших кандидатов, которые
+     * помещаются в бюджет, частичным отбором (nth_element) без полной
+     * сортировки; приоритет отправленных обнуляется.
+     * Строка клиента меняется только потоком, кодирующим этого клиента.
+     */
+    class PriorityAccumulator : boost::noncopyable
+    {
+    private:
+        std::size_t         maxEntities_;
+        std::vector<float>  importance_;    // per entity
+        std::vector<float>  accumulated_;   // [client][entity]
+
+    public:
+        PriorityAccumulator(std::size_t maxEntities, std::size_t maxClients);
+
+        void setImportance(EntityId id, float importance) noexcept;
+        // Обнулить строку клиента (новое подключение)
+        void reset(ClientIndex client) noexcept;
+
+        // Накопить приоритет и выбрать кандидатов в пределах budget бит: order[0, k)
+        std::size_t select(ClientIndex client, PriorityCandidates& candidates, std::size_t budget) noexcept;
+
+        [[nodiscard]] float accumulated(ClientIndex client, EntityId id) const noexcept {
+            return accumulated_[client * maxEntities_ + id];
+        }
+
+    };  // PriorityAccumulator
+
+}   // network::replication
@@ -0,0 +1,341 @@
+#include "replication_engine.h"
+
+#include <cmath>
+#include <algorithm>
+
+using namespace network::message;
+using namespace network::replication;
+
+namespace
+{
+    // id code, mask and list ends of the stream are not in field bits
+    constexpr std::uint32_t ENTITY_OVERHEAD_BITS { 8 + FIELD_COUNT };
+    constexpr std::size_t   STREAM_OVERHEAD_BITS { 32 + 1 + 16 + 8 + 8 };
+    // estimates are short of the stream: retries of a split update with a smaller budget
+    constexpr std::size_t   SPLIT_ATTEMPTS { 4 };
+
+    ReplicationConfig limited(ReplicationConfig config) noexcept
+    {
+        config.streamBytes = std::min(config.streamBytes, MAX_STREAM_BYTES);
+        return config;
+    }
+
+    inline void setEntity(std::uint64_t* row, EntityId id) noexcept
+    {
+        row[id >> 6] |= std::uint64_t(1) << (id & 63);
+    }
+
+    /*
+     * View of the delta encoder for tracked clients: keeps held and
+     * fresh rows of the encoded tick in step with what is written.
+     */
+    struct TrackedView
+    {
+        const std::uint64_t*    relevantNow;    // null - every entity
+        const std::uint64_t*    heldWas;        // null - the whole baseline
+        const std::uint64_t*    freshWas;
+        const std::uint64_t*    selected;       // null - no budget, all
+        std::uint64_t*          heldNow;
+        std::uint64_t*          freshNow;
+
+        bool held(EntityState const& base) const noexcept {
+            return nullptr == heldWas or testEntity(heldWas, base.id);
+        }
+
+        bool relevant(EntityState const& cur) const noexcept {
+            return nullptr == relevantNow or testEntity(relevantNow, cur.id);
+        }
+
+        FieldMask fields(EntityState const& cur, EntityState const* base) noexcept {
+            const bool send { nullptr == selected or testEntity(selected, cur.id) };
+            FieldMask mask { 0 };
+            bool fresh { send };
+
+            if (nullptr != base)
+            {
+                if (nullptr == freshWas or testEntity(freshWas, cur.id))
+                {
+                    const auto changed { changedFields(cur, *base) };
+                    mask = send ? changed : 0;
+                    fresh = send or 0 == changed;
+                }
+                else mask = send ? FIELD_MASK_ALL : 0;  // client state is older than the baseline
+            }
+            else if (send) mask = FIELD_MASK_ALL;
+
+            if (nullptr != base or send)
+            {
+                setEntity(heldNow, cur.id);
+                if (fresh) setEntity(freshNow, cur.id);
+            }
+            return mask;
+        }
+    };
+}
+
+ReplicationEngine::ReplicationEngine(ReplicationConfig config, std::pmr::memory_resource* memory)
+    : config_(limited(config))
+    , snapshots_(config.snapshots, config.maxEntities, memory)
+    , active_(config.maxClients, 0)
+    , acked_(config.maxClients, 0)
+    , ackTick_(config.maxClients, 0)
+    , streamSize_(config.maxClients, 0)
+    , streamFull_(config.maxClients, 0)
+    , streams_(config_.maxClients * config_.streamBytes, 0, memory)
+    , words_((config.maxEntities + 63) / 64)
+    , held_(config.maxClients * config.snapshots * words_, 0)
+    , fresh_(held_.size(), 0)
+    , complete_(config.maxClients * config.snapshots, 0)
+    , priority_(config.maxEntities, config.maxClients)
+{
+    // any update may be split, so the rows and the selection are always there
+    const std::size_t parts { config_.workers + std::size_t(1) };
+    candidates_.reserve(parts);
+    for (std::size_t i = 0; i < parts; ++i)
+        candidates_.emplace_back(config_.maxEntities);
+    selected_.assign(parts * words_, 0);
+
+    workers_.reserve(config_.workers);
+    for (std::uint32_t i = 0; i < config_.workers; ++i)
+        workers_.emplace_back(&ReplicationEngine::workerLoop, this, i + 1);
+}
+
+ReplicationEngine::~ReplicationEngine()
+{
+    {
+        std::lock_guard lock { mutex_ };
+        stop_ = true;
+    }
+    wake_.notify_all();
+    for (auto& worker : workers_)
+        worker.join();
+}
+
+Snapshot& ReplicationEngine::beginSnapshot(Tick tick) noexcept
+{
+    return snapshots_.begin(tick);
+}
+
+void ReplicationEngine::commitSnapshot(Snapshot& snapshot) noexcept
+{
+    snapshots_.commit(snapshot);
+}
+
+void ReplicationEngine::setInterest(InterestGrid const* interest)
+{
+    interest_ = interest;
+
+    // rows of earlier ticks were built for another view
+    std::fill(acked_.begin(), acked_.end(), 0);
+}
+
+void ReplicationEngine::setImportance(EntityId id, float importance) noexcept
+{
+    priority_.setImportance(id, importance);
+}
+
+std::uint64_t* ReplicationEngine::row(std::vector<std::uint64_t>& rows, ClientIndex client, Tick tick) noexcept
+{
+    return rows.data() + (client * config_.snapshots + tick % config_.snapshots) * words_;
+}
+
+void ReplicationEngine::connect(ClientIndex client) noexcept
+{
+    active_[client] = 1;
+    acked_[client] = 0;
+    streamSize_[client] = 0;
+    priority_.reset(client);
+}
+
+void ReplicationEngine::disconnect(ClientIndex client) noexcept
+{
+    active_[client] = 0;
+    acked_[client] = 0;
+    streamSize_[client] = 0;
+}
+
+void ReplicationEngine::acknowledge(ClientIndex client, Tick tick) noexcept
+{
+    // acks may arrive out of order, the newest one is the baseline
+    if (0 == acked_[client] or newer(tick, ackTick_[client]))
+    {
+        ackTick_[client] = tick;
+        acked_[client] = 1;
+    }
+}
+
+void ReplicationEngine::encode()
+{
+    current_ = snapshots_.latest();
+    if (nullptr == current_) return;
+
+    if (workers_.empty())
+    {
+        encodePart(0);
+        return;
+    }
+
+    {
+        std::lock_guard lock { mutex_ };
+        ++generation_;
+        pending_ = static_cast<std::uint32_t>(workers_.size());
+    }
+    wake_.notify_all();
+
+    encodePart(0);
+
+    std::unique_lock lock { mutex_ };
+    done_.wait(lock, [this] { return 0 == pending_; });
+}
+
+void ReplicationEngine::workerLoop(std::uint32_t part)
+{
+    std::uint64_t seen { 0 };
+    for (;;)
+    {
+        {
+            std::unique_lock lock { mutex_ };
+            wake_.wait(lock, [&] { return stop_ or generation_ != seen; });
+            if (stop_) return;
+            seen = generation_;
+        }
+
+        encodePart(part);
+
+        std::lock_guard lock { mutex_ };
+        if (0 == --pending_) done_.notify_one();
+    }
+}
+
+void ReplicationEngine::encodePart(std::uint32_t part) noexcept
+{
+    // contiguous client ranges, rows of one range are written by one thread
+    const std::size_t parts { workers_.size() + 1 };
+    const std::size_t step  { (config_.maxClients + parts - 1) / parts };
+    const std::size_t begin { std::min(config_.maxClients, step * part) };
+    const std::size_t end   { std::min(config_.maxClients, begin + step) };
+
+    for (auto client { begin }; client < end; ++client)
+        if (active_[client]) encodeClient(static_cast<ClientIndex>(client), part, *current_);
+}
+
+void ReplicationEngine::encodeClient(ClientIndex client, std::uint32_t part, Snapshot const& current) noexcept
+{
+    // baseline is gone once the ring wrapped past it
+    const Snapshot* baseline { acked_[client] ? snapshots_.find(ackTick_[client]) : nullptr };
+    if (nullptr != baseline and baseline->tick == current.tick)
+    {
+        // client already has it
+        streamSize_[client] = 0;
+        return;
+    }
+
+    auto data { streams_.data() + client * config_.streamBytes };
+    auto& complete { complete_[client * config_.snapshots + current.tick % config_.snapshots] };
+    const bool baseComplete { nullptr == baseline or 0 != complete_[client * config_.snapshots + baseline->tick % config_.snapshots] };
+
+    std::size_t budget { config_.budgetBytes };
+    if (not tracking())
+    {
+        // the whole update while it fits, the client then holds the whole tick
+        if (baseComplete)
+        {
+            BitWriter w { data, config_.streamBytes };
+            const auto stats { encodeDelta(current, baseline, w) };
+            const auto size { w.flush() };
+            if (not w.overflow())
+            {
+                streamSize_[client] = static_cast<std::uint32_t>(size);
+                streamFull_[client] = stats.full ? 1 : 0;
+                complete = 1;
+                return;
+            }
+        }
+        // the rest of the world goes with the next ticks
+        budget = config_.streamBytes;
+    }
+
+    // rows of this tick are rebuilt by the view while encoding
+    auto heldNow { row(held_, client, current.tick) };
+    auto freshNow { row(fresh_, client, current.tick) };
+    for (std::size_t attempt = 0; attempt < SPLIT_ATTEMPTS; ++attempt)
+    {
+        std::fill_n(heldNow, words_, 0);
+        std::fill_n(freshNow, words_, 0);
+
+        bool all { true };
+        TrackedView view {
+            nullptr != interest_ ? interest_->row(client) : nullptr,
+            nullptr != baseline and not baseComplete ? row(held_, client, baseline->tick) : nullptr,
+            nullptr != baseline and not baseComplete ? row(fresh_, client, baseline->tick) : nullptr,
+            0 != budget ? select(client, part, current, baseline, baseComplete, std::min(budget, config_.streamBytes), all) : nullptr,
+            heldNow,
+            freshNow
+        };
+
+        BitWriter w { data, config_.streamBytes };
+        const auto stats { encodeDelta(current, baseline, w, view) };
+        const auto size { w.flush() };
+        if (not w.overflow())
+        {
+            streamSize_[client] = static_cast<std::uint32_t>(size);
+            streamFull_[client] = stats.full ? 1 : 0;
+            complete = all and nullptr == interest_ ? 1 : 0;
+            return;
+        }
+        budget = (0 != budget ? std::min(budget, config_.streamBytes) : config_.streamBytes) * 3 / 4;
+    }
+
+    streamSize_[client] = 0;
+    complete = 0;
+}
+
+const std::uint64_t* ReplicationEngine::select(ClientIndex client, std::uint32_t part, Snapshot const& current, Snapshot const* baseline,
+                                               bool baseComplete, std::size_t budgetBytes, bool& all) noexcept
+{
+    auto& candidates { candidates_[part] };
+    candidates.clear();
+
+    const auto relevantNow { nullptr != interest_ ? interest_->row(client) : nullptr };
+    const auto heldWas { nullptr != baseline and not baseComplete ? row(held_, client, baseline->tick) : nullptr };
+    const auto freshWas { nullptr != baseline and not baseComplete ? row(fresh_, client, baseline->tick) : nullptr };
+    const auto viewer { nullptr != interest_ ? interest_->viewer(client) : InterestGrid::Viewer {} };
+
+    // entities waiting for data: new, stale or changed since the baseline
+    const EntityState* b { nullptr != baseline ? baseline->entities.data() : nullptr };
+    const EntityState* baseEnd { nullptr != baseline ? b + baseline->entities.size() : nullptr };
+    for (auto const& c : current.entities)
+    {
+        if (nullptr != relevantNow and not testEntity(relevantNow, c.id)) continue;
+
+        while (b != baseEnd and (b->id < c.id or (nullptr != heldWas and not testEntity(heldWas, b->id)))) ++b;
+        FieldMask need { FIELD_MASK_ALL };
+        if (b != baseEnd and b->id == c.id and (nullptr == freshWas or testEntity(freshWas, c.id)))
+            need = changedFields(c, *b);
+        if (0 == need) continue;
+
+        float weight { 1.0f };
+        if (viewer.radius > 0.0f)
+        {
+            const float dx { bits::dequantize(c.position[0], -WORLD_BOUND, WORLD_BOUND, POSITION_BITS) - viewer.x };
+            const float dz { bits::dequantize(c.position[2], -WORLD_BOUND, WORLD_BOUND, POSITION_BITS) - viewer.z };
+            weight = viewer.radius / (viewer.radius + std::sqrt(dx * dx + dz * dz));
+        }
+        candidates.add(c.id, weight, ENTITY_OVERHEAD_BITS + fieldBits(need));
+    }
+
+    const std::size_t budget { budgetBytes * 8 > STREAM_OVERHEAD_BITS ? budgetBytes * 8 - STREAM_OVERHEAD_BITS : 0 };
+    const auto chosen { priority_.select(client, candidates, budget) };
+    all = chosen == candidates.size();
+
+    auto selected { selected_.data() + part * words_ };
+    std::fill_n(selected, words_, 0);
+    for (std::size_t i = 0; i < chosen; ++i)
+        setEntity(selected, candidates.ids[candidates.order[i]]);
+    return selected;
+}
+
+ReplicationEngine::Stream ReplicationEngine::stream(ClientIndex client) const noexcept
+{
+    return { streams_.data() + client * config_.streamBytes, streamSize_[client], 0 != streamFull_[client] };
+}
@@ -0,0 +1,149 @@
+#pragma once
+
+#include <mutex>
+#include <vector>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <condition_variable>
+#include <memory_resource>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/message/block_assembler.h>
+#include <hermes/replication/snapshot.h>
+#include <hermes/replication/delta_codec.h>
+#include <hermes/replication/interest_grid.h>
+#include <hermes/replication/priority_accumulator.h>
+
+namespace network::replication
+{
+    // the largest update a client can assemble from blocks
+    constexpr std::size_t MAX_STREAM_BYTES { message::BlockAssembler::MAX_BLOCKS * message::BlockAssembler::BLOCK_PAYLOAD };
+
+    struct ReplicationConfig
+    {
+        std::size_t     snapshots   { 32 };         // ring depth, older baselines are sent in full
+        std::size_t     maxEntities { 4096 };
+        std::size_t     maxClients  { 256 };
+        std::size_t     streamBytes { MAX_STREAM_BYTES };   // encoded update limit per client, up to MAX_STREAM_BYTES
+        std::uint32_t   workers     { 0 };          // extra encoding threads, 0 - caller thread only
+        std::size_t     budgetBytes { 0 };          // per client update, 0 - no limit
+    };
+
+    static_assert(ReplicationConfig {}.streamBytes <= MAX_STREAM_BYTES);
+
+    /*
+     * Репликация состояния мира. Сервер каждый тик публикует снимок
+     * в кольцо, encode() для каждого клиента кодирует изменения
+     * относительно последнего подтвержденного им снимка (или полный
+     * снимок, если подтверждения нет или базовый снимок вытеснен из
+     * кольца). Клиенты делятся между потоками кодирования, снимки
+     * при этом только читаются. Состояние клиентов хранится по полям
+     * в отдельных массивах, поток пишет только в строки своих клиентов.
+     * Все методы вызываются из одного потока, потоки кодирования
+     * работают только внутри encode(). Кольцо снимков клиента должно
+     * быть не короче серверного.
+     *
+     * С подключенной InterestGrid клиент получает только релевантные
+     * ему сущности; строка релевантности сохраняется по тику, чтобы
+     * дельта считалась от того набора, который клиент действительно
+     * видел в базовом снимке.
+     *
+     * С бюджетом budgetBytes сущности, ждущие отправки, отбираются по
+     * накопленному приоритету (PriorityAccumulator), остальные клиент
+     * пока держит в старом состоянии. Для каждого тика по клиенту
+     * хранятся две строки: held - сущности у клиента, fresh - те из
+     * них, чье состояние совпадает с серверным снимком этого тика;
+     * несвежая сущность при следующей отправке уходит целиком.
+     *
+     * Обновление, не влезающее в streamBytes (не больше, чем клиент
+     * соберет из блоков), делится так же: отправляется часть сущностей
+     * по приоритету, остальные уходят следующими тиками. Пока снимки
+     * клиента полные, строки held/fresh не ведутся (complete_).
+     */
+    class ReplicationEngine : boost::noncopyable
+    {
+    public:
+        struct Stream
+        {
+            const std::uint8_t* data    { nullptr };
+            std::size_t         size    { 0 };
+            bool                full    { false };  // not a delta
+        };
+
+    private:
+        ReplicationConfig               config_;
+        SnapshotRing                    snapshots_;
+
+        // clients, one row per index
+        std::vector<std::uint8_t>       active_;
+        std::vector<std::uint8_t>       acked_;         // has an acknowledged baseline
+        std::vector<Tick>               ackTick_;
+        std::vector<std::uint32_t>      streamSize_;    // 0 - nothing encoded or overflow
+        std::vector<std::uint8_t>       streamFull_;
+        std::pmr::vector<std::uint8_t>  streams_;       // maxClients * streamBytes
+
+        // relevancy, null - every entity is sent to everyone
+        InterestGrid const*             interest_   { nullptr };
+
+        // what clients hold, [client][tick % snapshots] rows, kept for partial updates only
+        std::size_t                     words_;         // bitset words per row
+        std::vector<std::uint64_t>      held_;
+        std::vector<std::uint64_t>      fresh_;
+        std::vector<std::uint8_t>       complete_;      // [client][tick % snapshots], the client got the whole tick
+
+        // bandwidth budget and split updates
+        PriorityAccumulator             priority_;
+        std::vector<PriorityCandidates> candidates_;    // per encoding thread
+        std::vector<std::uint64_t>      selected_;      // per encoding thread row
+
+        // encoding threads
+        std::vector<std::thread>        workers_;
+        std::mutex                      mutex_;
+        std::condition_variable         wake_;
+        std::condition_variable         done_;
+        std::uint64_t                   generation_ { 0 };
+        std::uint32_t                   pending_    { 0 };
+        bool                            stop_       { false };
+        const Snapshot*                 current_    { nullptr };
+
+        void workerLoop(std::uint32_t part);
+        void encodePart(std::uint32_t part) noexcept;
+        void encodeClient(ClientIndex client, std::uint32_t part, Snapshot const& current) noexcept;
+        // Выбрать сущности в пределах budgetBytes, all - выбраны все ждущие
+        const std::uint64_t* select(ClientIndex client, std::uint32_t part, Snapshot const& current, Snapshot const* baseline,
+                                    bool baseComplete, std::size_t budgetBytes, bool& all) noexcept;
+
+        [[nodiscard]] bool tracking() const noexcept { return nullptr != interest_ or 0 != config_.budgetBytes; }
+        [[nodiscard]] std::uint64_t* row(std::vector<std::uint64_t>& rows, ClientIndex client, Tick tick) noexcept;
+
+    public:
+        explicit ReplicationEngine(ReplicationConfig config, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+        virtual ~ReplicationEngine();
+
+        // Снимок тика для заполнения и его публикация
+        Snapshot& beginSnapshot(Tick tick) noexcept;
+        void commitSnapshot(Snapshot& snapshot) noexcept;
+
+        // Отбор сущностей по клиентам (nullptr - отключить), задается до encode()
+        void setInterest(InterestGrid const* interest);
+
+        // Вес сущности в приоритете отправки (1 по умолчанию)
+        void setImportance(EntityId id, float importance) noexcept;
+
+        void connect(ClientIndex client) noexcept;
+        void disconnect(ClientIndex client) noexcept;
+        // Клиент получил и применил снимок tick
+        void acknowledge(ClientIndex client, Tick tick) noexcept;
+
+        // Закодировать последний снимок для всех клиентов
+        void encode();
+
+        [[nodiscard]] Stream stream(ClientIndex client) const noexcept;
+        [[nodiscard]] SnapshotRing const& snapshots() const noexcept { return snapshots_; }
+        [[nodiscard]] ReplicationConfig const& config() const noexcept { return config_; }
+
+    };  // ReplicationEngine
+
+}   // network::replication
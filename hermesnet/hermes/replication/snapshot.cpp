@@ -0,0 +1,90 @@
+#include "snapshot.h"
+
+#include <algorithm>
+
+using namespace network::replication;
+
+Snapshot::Snapshot(std::size_t maxEntities, std::pmr::memory_resource* memory)
+    : entities(memory)
+{
+    entities.reserve(maxEntities);
+}
+
+bool Snapshot::add(EntityId id, EntityTransform const& transform) noexcept
+{
+    return add(quantize(id, transform));
+}
+
+bool Snapshot::add(EntityState const& state) noexcept
+{
+    if (entities.size() == entities.capacity()) return false;
+    entities.push_back(state);
+    return true;
+}
+
+void Snapshot::clear(Tick t) noexcept
+{
+    tick = t;
+    valid = false;
+    entities.clear();
+}
+
+void Snapshot::seal() noexcept
+{
+    // entities are usually added in id order already
+    auto byId { [](EntityState const& a, EntityState const& b) { return a.id < b.id; } };
+    if (not std::is_sorted(entities.begin(), entities.end(), byId))
+        std::sort(entities.begin(), entities.end(), byId);
+}
+
+const EntityState* Snapshot::find(EntityId id) const noexcept
+{
+    auto it { std::lower_bound(entities.begin(), entities.end(), id,
+                               [](EntityState const& e, EntityId value) { return e.id < value; }) };
+    return entities.end() != it and it->id == id ? &*it : nullptr;
+}
+
+SnapshotRing::SnapshotRing(std::size_t depth, std::size_t maxEntities, std::pmr::memory_resource* memory)
+    : spare_(maxEntities, memory)
+{
+    slots_.reserve(depth);
+    for (std::size_t i = 0; i < depth; ++i)
+        slots_.emplace_back(maxEntities, memory);
+}
+
+Snapshot& SnapshotRing::begin(Tick tick) noexcept
+{
+    spare_.clear(tick);
+    return spare_;
+}
+
+void SnapshotRing::commit(Snapshot& snapshot) noexcept
+{
+    snapshot.seal();
+
+    // same memory resource, buffers are exchanged without copying
+    auto& slot { slots_[snapshot.tick % slots_.size()] };
+    slot.entities.swap(snapshot.entities);
+    slot.tick = snapshot.tick;
+    slot.valid = true;
+    snapshot.valid = false;
+
+    if (empty_ or newer(slot.tick, latest_)) latest_ = slot.tick;
+    empty_ = false;
+}
+
+bool SnapshotRing::window(Tick tick) const noexcept
+{
+    return empty_ or newer(tick, static_cast<Tick>(latest_ - slots_.size()));
+}
+
+const Snapshot* SnapshotRing::find(Tick tick) const noexcept
+{
+    auto const& snapshot { slots_[tick % slots_.size()] };
+    return snapshot.valid and snapshot.tick == tick ? &snapshot : nullptr;
+}
+
+const Snapshot* SnapshotRing::latest() const noexcept
+{
+    return empty_ ? nullptr : find(latest_);
+}
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <memory_resource>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/replication/entity_state.h>
+
+namespace network::replication
+{
+    using Tick        = std::uint32_t;
+    using ClientIndex = std::uint32_t;
+
+    // a is newer than b, with tick counter wraparound
+    constexpr bool newer(Tick a, Tick b) noexcept { return static_cast<std::int32_t>(a - b) > 0; }
+
+    /*
+     * Снимок мира на тике: квантованные состояния сущностей,
+     * упорядоченные по id (после seal()). Емкость задается при
+     * создании, добавление сущностей не выделяет память.
+     * После публикации в кольце снимок только читается, в том
+     * числе параллельно несколькими потоками кодирования.
+     */
+    struct Snapshot
+    {
+        Tick                            tick    { 0 };
+        bool                            valid   { false };
+        std::pmr::vector<EntityState>   entities;
+
+        explicit Snapshot(std::size_t maxEntities, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+        // false - снимок заполнен
+        bool add(EntityId id, EntityTransform const& transform) noexcept;
+        bool add(EntityState const& state) noexcept;
+        void clear(Tick t) noexcept;
+        // Упорядочить по id
+        void seal() noexcept;
+
+        // Состояние сущности или nullptr
+        [[nodiscard]] const EntityState* find(EntityId id) const noexcept;
+    };
+
+    /*
+     * Кольцо последних снимков: базовые снимки для дельта-кодирования
+     * (на сервере) и для применения дельт (на клиенте). Снимок тика t
+     * хранится в слоте t % depth, пока не будет перезаписан снимком
+     * тика t + depth. Новый снимок заполняется отдельно и попадает
+     * в слот только при commit(), брошенный begin() кольцо не меняет.
+     */
+    class SnapshotRing : boost::noncopyable
+    {
+    private:
+        std::vector<Snapshot>   slots_;
+        Snapshot                spare_;     // filled by begin(), swapped into the slot by commit()
+        Tick                    latest_ { 0 };
+        bool                    empty_  { true };
+
+    public:
+        SnapshotRing(std::size_t depth, std::size_t maxEntities, std::pmr::memory_resource* memory = std::pmr::get_default_resource());
+
+        // Очищенный снимок тика, публикуется в слот commit()
+        Snapshot& begin(Tick tick) noexcept;
+        void commit(Snapshot& snapshot) noexcept;
+
+        // Тик новее последнего снимка без depth, его слот не занят более новым снимком
+        [[nodiscard]] bool window(Tick tick) const noexcept;
+
+        // Снимок тика, если он еще в кольце, иначе nullptr
+        [[nodiscard]] const Snapshot* find(Tick tick) const noexcept;
+        [[nodiscard]] const Snapshot* latest() const noexcept;
+
+        [[nodiscard]] std::size_t depth() const noexcept { return slots_.size(); }
+
+    };  // SnapshotRing
+
+}   // network::replication
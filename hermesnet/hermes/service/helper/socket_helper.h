@@ -1,14 +1,22 @@
 
 #pragma once
 
+#include <optional>
+
+#include <sys/socket.h>
+#include <linux/filter.h>
+
 #include <hermes/common/types.h>
 
 using namespace network::types;
 
 namespace network::service::helper
 {
+    using reuse_port = net::detail::socket_option::boolean<SOL_SOCKET, SO_REUSEPORT>;
+
     // Создать и подготовить сокет на указанном порту
-    std::optional<net::ip::udp::socket> prepareSocket(net::io_service& ios, boost::system::error_code& ec, std::uint16_t port)
+    // reusePort - несколько сокетов (по одному на шард) слушают один порт
+    std::optional<net::ip::udp::socket> prepareSocket(net::io_service& ios, boost::system::error_code& ec, std::uint16_t port, bool reusePort = false)
     {
         const std::string& address = "127.0.0.1";   // todo: get local ip address
         net::ip::udp::endpoint endpoint(net::ip::address::from_string(address), port);
@@ -19,6 +27,15 @@ namespace network::service::helper
             return std::nullopt;
         }
 
+        if (reusePort)
+        {
+            // must be set on every socket of the group before bind
+            sock.set_option(reuse_port(true), ec);
+            if (ec.failed()) {
+                return std::nullopt;
+            }
+        }
+
         sock.bind(endpoint, ec);
         if (ec.failed()) {
             return std::nullopt;
@@ -35,6 +52,28 @@ namespace network::service::helper
         return sock;
     }
 
+    // Распределять датаграммы группы SO_REUSEPORT по номеру ядра, принявшего пакет
+    // (socket index = cpu % shards) вместо хэша 4-tuple; достаточно вызвать для
+    // одного сокета группы. При ошибке ядро продолжает использовать хэш.
+    // Клиент остается на своем шарде, только если RSS/RPS направляют все пакеты
+    // потока на одно ядро, иначе его датаграммы расходятся по шардам.
+    static bool attachCpuSteering(net::ip::udp::socket& sock, std::uint32_t shards, boost::system::error_code& ec)
+    {
+        sock_filter code[] = {
+            { BPF_LD  | BPF_W   | BPF_ABS, 0, 0, static_cast<std::uint32_t>(SKF_AD_OFF + SKF_AD_CPU) },
+            { BPF_ALU | BPF_MOD | BPF_K,   0, 0, shards },
+            { BPF_RET | BPF_A,             0, 0, 0 },
+        };
+        sock_fprog prog { static_cast<unsigned short>(std::size(code)), code };
+
+        if (0 != ::setsockopt(sock.native_handle(), SOL_SOCKET, SO_ATTACH_REUSEPORT_CBPF, &prog, sizeof(prog)))
+        {
+            ec.assign(errno, boost::system::system_category());
+            return false;
+        }
+        return true;
+    }
+
 // Закрыть указанный сокет
     static void closeSocket(net::ip::udp::socket& sock)
     {
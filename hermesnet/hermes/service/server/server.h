@@ -1,12 +1,16 @@
 
 #pragma once
 
+#include <optional>
+
 #include <hermes/common/duration_bench.h>
 
 #include <boost/noncopyable.hpp>
 
 #include <hermes/netloop/netloop.h>
 #include <hermes/common/structures.h>
+#include <hermes/common/huge_pages.h>
+#include <hermes/data_receiver/server_data_receiver.h>
 
 namespace network::service
 {
@@ -30,6 +34,8 @@ namespace network::service
         // Event event_;
         class Entry     entry_;
         class Clients   clients_;
+        memory::HugePagePool    pages_;     // memory of receiver ring buffers
+        ServerDataReceiver<MessageType>*    receiver_ { nullptr };  // owned by netloop
         class NetLoop   netloop_;
 
         // todo: make special buffer class for message exchange logic (read/write flags) with event class (todo too)
@@ -38,14 +44,18 @@ namespace network::service
 
     private:
         bool init(std::pair<std::uint16_t, std::uint16_t> ports);
+        std::unique_ptr<ServerDataReceiver<MessageType>> makeReceiver();
 
     public:
-        Server() noexcept;
+        explicit Server(NetLoopConfig config = {}) noexcept;
         virtual ~Server();
 
         bool start(std::pair<std::uint16_t, std::uint16_t> ports);
         bool stop();
 
+        // Принять клиента после рукопожатия (из потока приема или до start): индекс клиента, nullopt - отказ
+        std::optional<std::size_t> accept(net::ip::udp::endpoint const& endpoint, std::uint32_t uuid, std::uint8_t accessCode);
+
     };  // server
 }   // network
 
@@ -60,7 +70,6 @@ namespace network::service
 #include <hermes/message/datagram.h>
 #include <hermes/service/helper/socket_helper.h>
 #include <hermes/data_sender/server_data_sender.h>
-#include <hermes/data_receiver/server_data_receiver.h>
 
 using namespace utility::logger;
 using namespace network::types;
@@ -73,15 +82,24 @@ namespace
 }
 
 template <typename MessageType>
-Server<MessageType>::Server() noexcept
+Server<MessageType>::Server(NetLoopConfig config) noexcept
         : entry_(ios_)
-        , netloop_(std::make_unique<ServerDataReceiver<MessageType>>(ios_, entry_, clients_), std::make_unique<ServerDataSender>())
+        , pages_(config.pages)
+        , netloop_(makeReceiver(), std::make_unique<ServerDataSender>(), std::move(config))
 {
     LOG_REGISTER_MODULE(EModule::SERVER)
 
     entry_.accessCode = network::types::SERVER_ACCESS_CODE;
 }
 
+template <typename MessageType>
+std::unique_ptr<ServerDataReceiver<MessageType>> Server<MessageType>::makeReceiver()
+{
+    auto r { std::make_unique<ServerDataReceiver<MessageType>>(ios_, entry_, clients_, &pages_) };
+    receiver_ = r.get();
+    return r;
+}
+
 template <typename MessageType>
 Server<MessageType>::~Server()
 {
@@ -111,6 +129,10 @@ bool Server<MessageType>::start(std::pair<std::uint16_t, std::uint16_t> ports)
         return false;
     }
 
+    // parked loop wakes on the entry socket and client sockets
+    netloop_.watch(entry_.in.native_handle());
+    for (auto& s : clients_.vIn)
+        netloop_.watch(s.native_handle());
     netloop_.runThreads();
 
     {
@@ -119,6 +141,18 @@ bool Server<MessageType>::start(std::pair<std::uint16_t, std::uint16_t> ports)
         LOG(ss.str().c_str())
     }
 
+    if (memory::EPagePolicy::REGULAR != pages_.policy())
+    {
+        using memory::EPagePolicy;
+        std::stringstream ss;
+        ss  << "ring buffers [" << memory::getPagePolicyName(pages_.policy()) << "]: "
+            << "hugetlb " << (pages_.mapped(EPagePolicy::EXPLICIT) >> 10) << " KB, "
+            << "transparent " << (pages_.mapped(EPagePolicy::TRANSPARENT) >> 10) << " KB, "
+            << "regular " << (pages_.mapped(EPagePolicy::REGULAR) >> 10) << " KB, "
+            << "heap " << (pages_.heap() >> 10) << " KB";
+        LOG(ss.str().c_str())
+    }
+
     return true;
 }
 
@@ -181,4 +215,22 @@ bool Server<MessageType>::init(std::pair<std::uint16_t, std::uint16_t> entryPort
     return true;
 }
 
+template <typename MessageType>
+std::optional<std::size_t> Server<MessageType>::accept(net::ip::udp::endpoint const& endpoint, std::uint32_t uuid, std::uint8_t accessCode)
+{
+    boost::system::error_code ec;
+    auto in  { helper::prepareSocket(ios_, ec, 0) };
+    auto out { in.has_value() ? helper::prepareSocket(ios_, ec, 0) : std::nullopt };
+    if (not in.has_value() or not out.has_value())
+    {
+        std::stringstream ss;
+        ss << "prepare client socket error: " << ec.message();
+        LOG(ss.str().c_str())
+        return std::nullopt;
+    }
 
+    const int fd { in->native_handle() };
+    const auto client { receiver_->acceptClient(std::move(in.value()), std::move(out.value()), endpoint, uuid, accessCode) };
+    if (client.has_value()) netloop_.watch(fd);
+    return client;
+}
@@ -0,0 +1,4 @@
+
+#include "sharded_server.h"
+
+/* just for standard .obj compilation */
@@ -0,0 +1,280 @@
+#pragma once
+
+#include <memory>
+#include <vector>
+#include <thread>
+#include <algorithm>
+
+#include <boost/noncopyable.hpp>
+
+#include <hermes/netloop/netloop.h>
+#include <hermes/netloop/shard_mesh.h>
+#include <hermes/common/structures.h>
+#include <hermes/service/server/server.h>
+#include <hermes/data_sender/server_data_sender.h>
+#include <hermes/data_receiver/server_data_receiver.h>
+
+namespace network::service
+{
+#ifndef ASIO_TYPEDEF
+    #define ASIO_TYPEDEF
+    namespace net = boost::asio;
+#endif
+
+    static constexpr std::uint32_t MAX_SHARDS { 64 };   // router mask width
+
+    struct ShardContext
+    {
+        std::uint32_t   shards       { 1 };     // netloop count, one per core
+        std::size_t     meshCapacity { 1024 };  // messages per shard pair queue
+        bool            cpuSteering  { false }; // cBPF steering by receiving cpu instead of the kernel 4-tuple hash (needs RSS/RPS keeping a flow on one cpu)
+        bool            pinThreads   { false }; // shard i in/out threads are bound to cpus 2i/2i+1 (to cpu i if too few)
+        int             priority     { 0 };     // SCHED_FIFO priority of shard threads (in thread only on a shared cpu)
+        WaitConfig      wait         {};        // idle strategy of shard receive loops
+        memory::EPagePolicy pages    { memory::EPagePolicy::REGULAR };  // pages of rings and mesh queues
+    };
+
+    /*
+     *  Шард сервера: собственные сокеты SO_REUSEPORT на общих портах,
+     *  собственный раздел клиентов, буферы и цикл обработки. Клиент
+     *  принадлежит тому шарду, в сокет которого ядро направило его
+     *  датаграммы, поэтому разделяемого между шардами состояния нет.
+     */
+    template <typename MessageType>
+    struct Shard : boost::noncopyable
+    {
+        using ReceiverType = ServerDataReceiver<MessageType>;
+
+        net::io_service             ios;
+        class Entry                 entry;
+        class Clients               clients;
+        memory::HugePagePool        pages;                  // memory of shard's ring buffers
+        ReceiverType*               receiver { nullptr };   // owned by netloop
+        std::unique_ptr<NetLoop>    netloop;
+
+        explicit Shard(NetLoopConfig config)
+            : entry(ios)
+            , pages(config.pages)
+        {
+            auto r { std::make_unique<ReceiverType>(ios, entry, clients, &pages) };
+            receiver = r.get();
+            netloop = std::make_unique<NetLoop>(std::move(r), std::make_unique<ServerDataSender>(), std::move(config));
+        }
+    };
+
+    /*
+     *  Многоядерный режим сервера: N независимых циклов NetLoop,
+     *  связанных только SPSC очередями для пересылки сообщений,
+     *  адресованных клиентам других шардов.
+     */
+    template <typename MessageType>
+    class ShardedServer : public boost::noncopyable
+    {
+    private:
+        using ShardType   = Shard<MessageType>;
+        using MessageItem = TimedMessage<Datagram<MessageType>>;
+        using ShardRouter = typename ShardType::ReceiverType::ShardRouter;
+
+        class Context                           context_ {};
+        ShardContext                            shardContext_ {};
+        memory::HugePagePool                    meshPages_;     // memory of mesh queues
+        std::unique_ptr<ShardMesh<MessageItem>> mesh_;
+        std::vector<std::unique_ptr<ShardType>> shards_;
+
+    private:
+        bool init(std::pair<std::uint16_t, std::uint16_t> ports);
+
+    public:
+        explicit ShardedServer(ShardContext ctx) noexcept;
+        virtual ~ShardedServer();
+
+        // router - выбор шардов-получателей для сообщений клиентов (nullptr - без пересылки)
+        bool start(std::pair<std::uint16_t, std::uint16_t> ports, ShardRouter router = nullptr);
+        bool stop();
+
+        // Принять клиента в шард после рукопожатия (из потока приема шарда или до start): индекс клиента в шарде, nullopt - отказ
+        std::optional<std::size_t> accept(std::uint32_t shard, net::ip::udp::endpoint const& endpoint, std::uint32_t uuid, std::uint8_t accessCode);
+
+        [[nodiscard]] std::uint32_t shardCount() const noexcept;
+
+    };  // ShardedServer
+
+}   // network::service
+
+// ********************************* IMPLEMENTATION **********************************
+
+#include <hermes/log/log.h>
+#include <hermes/service/helper/socket_helper.h>
+
+using namespace utility::logger;
+using namespace network::types;
+using namespace network::service;
+
+namespace
+{
+#undef  LOG
+#define LOG(text) Logger::getInstance().log(EModule::SERVER, (text));
+}
+
+template <typename MessageType>
+ShardedServer<MessageType>::ShardedServer(ShardContext ctx) noexcept
+    : shardContext_(ctx)
+    , meshPages_(ctx.pages)
+{
+    LOG_REGISTER_MODULE(EModule::SERVER)
+
+    if (0 == shardContext_.shards)
+        shardContext_.shards = std::max(1u, std::thread::hardware_concurrency());
+    shardContext_.shards = std::min(shardContext_.shards, MAX_SHARDS);
+
+    mesh_ = std::make_unique<ShardMesh<MessageItem>>(shardContext_.shards, shardContext_.meshCapacity, &meshPages_);
+
+    shards_.reserve(shardContext_.shards);
+    for (std::uint32_t i = 0; i < shardContext_.shards; ++i)
+    {
+        NetLoopConfig config;
+        config.in.name = "hermes-in-" + std::to_string(i);
+        config.out.name = "hermes-out-" + std::to_string(i);
+        config.in.priority = config.out.priority = shardContext_.priority;
+        config.wait = shardContext_.wait;
+        config.pages = shardContext_.pages;
+        if (shardContext_.pinThreads)
+        {
+            // a spinning SCHED_FIFO in thread never yields its cpu, so out gets its own
+            // while there are enough cpus, on a shared one it runs as SCHED_OTHER
+            const auto cpus { std::max(1u, std::thread::hardware_concurrency()) };
+            const bool paired { 2 * shardContext_.shards <= cpus };
+            config.in.cpus = { static_cast<int>((paired ? 2 * i : i) % cpus) };
+            config.out.cpus = { static_cast<int>((paired ? 2 * i + 1 : i) % cpus) };
+            if (not paired) config.out.priority = 0;
+        }
+
+        shards_.emplace_back(std::make_unique<ShardType>(std::move(config)));
+        shards_.back()->entry.accessCode = SERVER_ACCESS_CODE;
+    }
+}
+
+template <typename MessageType>
+ShardedServer<MessageType>::~ShardedServer()
+{
+    stop();
+}
+
+template <typename MessageType>
+bool ShardedServer<MessageType>::start(std::pair<std::uint16_t, std::uint16_t> ports, ShardRouter router)
+{
+    if (not init(ports))
+    {
+        LOG("can't initiate shard entry sockets, restart or try another entry ports")
+        return false;
+    }
+
+    for (std::uint32_t i = 0; i < shards_.size(); ++i)
+    {
+        shards_[i]->receiver->attachShard({ mesh_.get(), i }, router);
+        // parked loops wake on the entry socket, client sockets and forwarded messages
+        shards_[i]->netloop->watch(shards_[i]->entry.in.native_handle());
+        for (auto& s : shards_[i]->clients.vIn)
+            shards_[i]->netloop->watch(s.native_handle());
+        if (shards_.size() > 1)
+            shards_[i]->netloop->watch(mesh_->notifier(i));
+        shards_[i]->netloop->runThreads();
+    }
+
+    {
+        std::stringstream ss;
+        ss << "sharded server started on port: " << context_.inPort << "/" << context_.outPort
+           << " [" << shards_.size() << " shards]";
+        LOG(ss.str().c_str())
+    }
+
+    return true;
+}
+
+template <typename MessageType>
+bool ShardedServer<MessageType>::stop()
+{
+    for (auto& shard : shards_)
+    {
+        shard->netloop->stopThreads();
+        shard->ios.stop();
+
+        std::for_each(std::begin(shard->clients.vIn), std::end(shard->clients.vIn), helper::closeSocket);
+        std::for_each(std::begin(shard->clients.vOut), std::end(shard->clients.vOut), helper::closeSocket);
+        helper::closeSocket(shard->entry.in);
+        helper::closeSocket(shard->entry.out);
+    }
+
+    LOG("sharded server stopped")
+    return true;
+}
+
+template <typename MessageType>
+bool ShardedServer<MessageType>::init(std::pair<std::uint16_t, std::uint16_t> entryPorts)
+{
+    context_.inPort = entryPorts.first;
+    context_.outPort = entryPorts.second;
+
+    LOG("sharded server init")
+    boost::system::error_code ec;
+
+    for (auto& shard : shards_)
+    {
+        auto in  { helper::prepareSocket(shard->ios, ec, context_.inPort, true) };
+        auto out { in.has_value() ? helper::prepareSocket(shard->ios, ec, context_.outPort, true) : std::nullopt };
+
+        if (not in.has_value() or not out.has_value())
+        {
+            std::stringstream ss;
+            ss << "prepare shard entry socket error [" << context_.inPort << "/" << context_.outPort << "] " << ec.message();
+            LOG(ss.str().c_str())
+            return false;
+        }
+
+        shard->entry.in = std::move(in.value());
+        shard->entry.out = std::move(out.value());
+        shard->clients.reserve(MAX_CLIENTS / shards_.size() + 1);
+    }
+
+    // the program is attached to the whole reuseport group through any of its sockets
+    if (shardContext_.cpuSteering and shards_.size() > 1)
+    {
+        if (not helper::attachCpuSteering(shards_.front()->entry.in, shardContext_.shards, ec))
+        {
+            std::stringstream ss;
+            ss << "cpu steering not available, kernel hash is used: " << ec.message();
+            LOG(ss.str().c_str())
+        }
+    }
+
+    return true;
+}
+
+template <typename MessageType>
+std::uint32_t ShardedServer<MessageType>::shardCount() const noexcept
+{
+    return static_cast<std::uint32_t>(shards_.size());
+}
+
+template <typename MessageType>
+std::optional<std::size_t> ShardedServer<MessageType>::accept(std::uint32_t shard, net::ip::udp::endpoint const& endpoint, std::uint32_t uuid, std::uint8_t accessCode)
+{
+    if (shard >= shards_.size()) return std::nullopt;
+    auto& s { *shards_[shard] };
+
+    boost::system::error_code ec;
+    auto in  { helper::prepareSocket(s.ios, ec, 0) };
+    auto out { in.has_value() ? helper::prepareSocket(s.ios, ec, 0) : std::nullopt };
+    if (not in.has_value() or not out.has_value())
+    {
+        std::stringstream ss;
+        ss << "prepare client socket error [shard " << shard << "]: " << ec.message();
+        LOG(ss.str().c_str())
+        return std::nullopt;
+    }
+
+    const int fd { in->native_handle() };
+    const auto client { s.receiver->acceptClient(std::move(in.value()), std::move(out.value()), endpoint, uuid, accessCode) };
+    if (client.has_value()) s.netloop->watch(fd);
+    return client;
+}
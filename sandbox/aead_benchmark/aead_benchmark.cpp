@@ -0,0 +1,164 @@
+/*
+ *  Запечатывание датаграмм ChaCha20-Poly1305: пакетов в секунду на ядро
+ *  с шифрованием и без. Отправка - копия образов в буфер отправки и
+ *  sealBatch, прием - копия из буфера приема, validateBatch и openBatch;
+ *  открытый текст - те же копия и проверка без шифра. Ядра avx2
+ *  (ChaCha20 - 8 блоков за раз, Poly1305 - 4 сообщения) и scalar, ключи
+ *  у датаграмм пачки разные (8 клиентов), нагрузка - 16 байт и полная
+ *  (37 байт).
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet -I../../libs/boost/include aead_benchmark.cpp \
+ *      ../../hermesnet/hermes/crypto/chacha20_poly1305.cpp ../../hermesnet/hermes/message/datagram_cipher.cpp \
+ *      ../../hermesnet/hermes/message/batch_validator.cpp ../../hermesnet/hermes/common/crc32c.cpp \
+ *      ../../hermesnet/hermes/common/memory.cpp -o aead_benchmark
+ *  ./aead_benchmark [rounds]
+ */
+
+#include <hermes/message/datagram.h>
+#include <hermes/message/batch_validator.h>
+#include <hermes/message/datagram_cipher.h>
+#include <hermes/message/service_type_id.h>
+#include <hermes/crypto/chacha20_poly1305.h>
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    using namespace network;
+    using namespace network::message;
+    using clock = std::chrono::steady_clock;
+
+    constexpr std::size_t BATCH   { validator::BATCH_MAX };
+    constexpr std::size_t BATCHES { 32 };   // 128 KB of images
+    constexpr std::size_t CLIENTS { 8 };
+
+    struct Traffic
+    {
+        std::vector<std::uint8_t>   images;
+        std::vector<std::uint32_t>  lengths;
+    };
+
+    Traffic generate(std::size_t payload, bool sealed)
+    {
+        std::mt19937 rng { 42 };
+        Traffic t { std::vector<std::uint8_t>(BATCHES * BATCH * types::DATAGRAM_SIZE), std::vector<std::uint32_t>(BATCHES * BATCH, types::DATAGRAM_SIZE) };
+
+        for (std::size_t i = 0; i < BATCHES * BATCH; ++i)
+        {
+            Header<id::ServiceType> h {};
+            h.type.action = id::ServiceType::EServiceAction::SERVICE_ACT_INPUT;
+            h.access_code = types::SERVER_ACCESS_CODE;
+            h.encode = sealed;
+
+            Datagram<id::ServiceType> d { h, Body {} };
+            for (auto& b : d.Data())
+                b = static_cast<std::uint8_t>(rng());
+            d.BodyRef().size = static_cast<Body::SizeType>(std::min(payload, d.capacity()));
+            d.Data()[types::END_MESSAGE_BYTE_POS] = types::END_MESSAGE_BYTE;
+            d.encode(t.images.data() + i * types::DATAGRAM_SIZE);
+        }
+        return t;
+    }
+
+    template <typename Work>
+    double measure(std::size_t rounds, Work&& work)
+    {
+        std::size_t sink { 0 };
+        const auto start { clock::now() };
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t b = 0; b < BATCHES; ++b)
+                sink += work(b * BATCH);
+        const auto ns { std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() };
+
+        if (42 == sink) std::printf(" ");
+        return static_cast<double>(ns) / static_cast<double>(rounds * BATCHES * BATCH);
+    }
+
+    void report(const char* what, double ns)
+    {
+        std::printf("  %-24s %7.2f ns/datagram, %6.2f Mpps\n", what, ns, 1e3 / ns);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t rounds { argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 200 };
+
+    std::mt19937 rng { 7 };
+    std::vector<crypto::Key> keys(CLIENTS);
+    for (auto& key : keys)
+        for (auto& b : key)
+            b = static_cast<std::uint8_t>(rng());
+
+    // datagram i of a batch belongs to client i % CLIENTS
+    std::vector<std::uint32_t> owners(BATCH);
+    std::vector<std::uint64_t> sequences(BATCH), opened(BATCH);
+    for (std::size_t i = 0; i < BATCH; ++i)
+    {
+        owners[i] = static_cast<std::uint32_t>(i % CLIENTS);
+        sequences[i] = 1000 + i / CLIENTS;
+    }
+    std::vector<std::uint64_t> highest(CLIENTS, 1000);
+
+    std::vector<std::uint8_t> work(BATCH * types::DATAGRAM_SIZE);
+    const auto plainRules { rulesFor<id::ServiceType>() };
+    const auto sealedRules { rulesFor<id::ServiceType>(types::SERVER_ACCESS_CODE, false, true) };
+
+    for (std::size_t payload : { std::size_t(16), CAPACITY })
+    {
+        const auto plain { generate(payload, false) };
+        const auto outgoing { generate(payload, true) };
+
+        // received traffic is the outgoing one sealed once
+        auto incoming { outgoing };
+        for (std::size_t b = 0; b < BATCHES; ++b)
+        {
+            auto images { incoming.images.data() + b * BATCH * types::DATAGRAM_SIZE };
+            sealBatch(images, BATCH, sealedImages(images, BATCH), keys.data(), owners.data(), sequences.data());
+        }
+
+        std::printf("payload %zu bytes, %zu rounds of %zu datagrams\n", std::min(payload, wire::capacity(wire::FLAG_ENCODE)), rounds, BATCHES * BATCH);
+
+        const double plainSend { measure(rounds, [&](std::size_t first) {
+            std::memcpy(work.data(), plain.images.data() + first * types::DATAGRAM_SIZE, work.size());
+            return std::size_t(work[wire::HEADER_SIZE]);
+        }) };
+        const double plainReceive { measure(rounds, [&](std::size_t first) {
+            std::memcpy(work.data(), plain.images.data() + first * types::DATAGRAM_SIZE, work.size());
+            return static_cast<std::size_t>(__builtin_popcountll(validateBatch(work.data(), plain.lengths.data() + first, nullptr, BATCH, plainRules)));
+        }) };
+        report("plaintext send", plainSend);
+        report("plaintext receive", plainReceive);
+
+        for (auto name : { "avx2", "scalar" })
+        {
+            const auto kernels { crypto::find(name) };
+            if (nullptr == kernels) continue;
+            crypto::active = kernels;
+
+            const double send { measure(rounds, [&](std::size_t first) {
+                std::memcpy(work.data(), outgoing.images.data() + first * types::DATAGRAM_SIZE, work.size());
+                sealBatch(work.data(), BATCH, ~std::uint64_t(0), keys.data(), owners.data(), sequences.data());
+                return std::size_t(work[wire::PAYLOAD_OFFSET]);
+            }) };
+            const double receive { measure(rounds, [&](std::size_t first) {
+                std::memcpy(work.data(), incoming.images.data() + first * types::DATAGRAM_SIZE, work.size());
+                const auto valid { validateBatch(work.data(), incoming.lengths.data() + first, nullptr, BATCH, sealedRules) };
+                const auto authentic { openBatch(work.data(), BATCH, valid, keys.data(), owners.data(), highest.data(), opened.data()) };
+                return static_cast<std::size_t>(__builtin_popcountll(authentic));
+            }) };
+
+            char what[64];
+            std::snprintf(what, sizeof(what), "sealed send (%s)", name);
+            report(what, send);
+            std::snprintf(what, sizeof(what), "sealed receive (%s)", name);
+            report(what, receive);
+        }
+    }
+    return 0;
+}
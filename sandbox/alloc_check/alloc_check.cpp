@@ -0,0 +1,96 @@
+/*
+ *  Проверка отсутствия обращений к куче в установившемся цикле приема:
+ *  глобальные operator new/delete подсчитываются, по loopback сокетам
+ *  гоняется трафик, итерации цикла повторяют NetLoop (process + reset
+ *  временной памяти). Код возврата 1, если в окне измерения были выделения.
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet -I../../libs/boost/include -I../../libs/P7/include alloc_check.cpp \
+ *      -L../../libs -L../../libs/P7/lib -lhermesnet -lp7 -lpthread -lrt -ldl -o alloc_check
+ */
+
+#include <new>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+
+#include <hermes/log/log.h>
+#include <hermes/common/arena.h>
+#include <hermes/common/structures.h>
+#include <hermes/message/helper.h>
+#include <hermes/data_receiver/server_data_receiver.h>
+
+namespace
+{
+    std::atomic<std::uint64_t>  allocations { 0 };
+    std::atomic<bool>           counting    { false };
+
+    constexpr std::size_t WARMUP_TICKS { 1'000 };
+    constexpr std::size_t TICKS        { 100'000 };
+}
+
+void* operator new(std::size_t size)
+{
+    if (counting.load(std::memory_order_relaxed)) allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void* p { std::malloc(size ? size : 1) }) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+int main()
+{
+    using namespace network;
+    using namespace utility::logger;
+
+    Logger::init("/P7.Sink=Null /P7.On=1 /P7.Pool=1024", "alloc_check");
+
+    const auto loopback { net::ip::address::from_string("127.0.0.1") };
+
+    net::io_service ios;
+    Entry entry { ios };
+    entry.in.open(net::ip::udp::v4());
+    entry.in.bind({ loopback, 0 });
+    entry.accessCode = SERVER_ACCESS_CODE;
+
+    Clients clients;
+    clients.reserve(1);
+    clients.vIn.emplace_back(ios, net::ip::udp::endpoint { loopback, 0 });
+    clients.vAccessCodes.push_back(SERVER_ACCESS_CODE);
+
+    net::ip::udp::socket peer { ios, net::ip::udp::endpoint { loopback, 0 } };
+    const auto entryPoint  { entry.in.local_endpoint() };
+    const auto clientPoint { clients.vIn.front().local_endpoint() };
+
+    Datagram<ServiceType> datagram {};
+    datagram.HeaderRef().type.action = ServiceType::EServiceAction::SERVICE_ACT_PING;
+    message::helper::prepareDatagram(datagram, SERVER_ACCESS_CODE, END_MESSAGE_BYTE);
+
+    std::array<std::uint8_t, DATAGRAM_SIZE> packet {};
+    datagram.encode(packet.data());
+
+    service::ServerDataReceiver<ServiceType> receiver { ios, entry, clients };
+
+    auto tick = [&](std::size_t i) {
+        if (0 == i % 4)
+        {
+            peer.send_to(net::buffer(packet), entryPoint);
+            peer.send_to(net::buffer(packet), clientPoint);
+        }
+        receiver.process();
+        memory::tickArena().reset();
+    };
+
+    for (std::size_t i = 0; i < WARMUP_TICKS; ++i) tick(i);
+
+    counting = true;
+    for (std::size_t i = 0; i < TICKS; ++i) tick(i);
+    counting = false;
+
+    auto& arena { memory::tickArena() };
+    std::printf("ticks %zu, heap allocations %llu, arena high water %zu of %zu, overflows %llu\n",
+                TICKS, static_cast<unsigned long long>(allocations.load()),
+                arena.highWater(), arena.capacity(), static_cast<unsigned long long>(arena.overflows()));
+
+    return 0 == allocations.load() ? 0 : 1;
+}
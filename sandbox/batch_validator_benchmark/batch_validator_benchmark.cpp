@@ -0,0 +1,119 @@
+/*
+ *  Пакетная проверка датаграмм: цена проверки (нс на датаграмму) пачками
+ *  по 64 образа ядрами validateBatch против прежнего пути - копирование
+ *  в Datagram, распаковка и validateDataram для каждой датаграммы -
+ *  при разной доле мусора (случайно испорченное поле заголовка или хвоста).
+ *  Пачки лежат в кеше (как сразу после recvmmsg) и проходятся по кругу.
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet -I../../libs/boost/include batch_validator_benchmark.cpp \
+ *      ../../hermesnet/hermes/message/batch_validator.cpp ../../hermesnet/hermes/common/memory.cpp \
+ *      ../../hermesnet/hermes/common/crc32c.cpp -o batch_validator_benchmark
+ *  ./batch_validator_benchmark [rounds]
+ */
+
+#include <hermes/message/helper.h>
+#include <hermes/message/datagram.h>
+#include <hermes/message/batch_validator.h>
+#include <hermes/message/service_type_id.h>
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    using namespace network;
+    using namespace network::message;
+    using clock = std::chrono::steady_clock;
+
+    constexpr std::size_t BATCH   { validator::BATCH_MAX };
+    constexpr std::size_t BATCHES { 32 };   // 128 KB of images
+
+    struct Traffic
+    {
+        std::vector<std::uint8_t>   images;
+        std::vector<std::uint32_t>  lengths;
+    };
+
+    Traffic generate(std::size_t batches, unsigned junkPercent)
+    {
+        std::mt19937 rng { 42 };
+        Traffic t { std::vector<std::uint8_t>(batches * BATCH * types::DATAGRAM_SIZE), std::vector<std::uint32_t>(batches * BATCH, types::DATAGRAM_SIZE) };
+
+        for (std::size_t i = 0; i < batches * BATCH; ++i)
+        {
+            Header<id::ServiceType> h {};
+            h.type.action = static_cast<id::ServiceType::EServiceAction>(1 + rng() % 6);
+            Datagram<id::ServiceType> d { h, Body {} };
+            d.BodyRef().size = static_cast<Body::SizeType>(rng() % 40);
+            helper::prepareDatagram(d);
+
+            auto image { t.images.data() + i * types::DATAGRAM_SIZE };
+            d.encode(image);
+            image[types::DATAGRAM_SIZE - 1] = types::END_MESSAGE_BYTE;
+
+            if (rng() % 100 < junkPercent)
+            {
+                switch (rng() % 4)
+                {
+                    case 0:  image[types::ACCESS_BYTE_POS] ^= 0x5a; break;
+                    case 1:  image[types::DATAGRAM_SIZE - 1] = 0; break;
+                    case 2:  t.lengths[i] = static_cast<std::uint32_t>(rng() % types::DATAGRAM_SIZE); break;
+                    default: image[1] = 0x7f; break;
+                }
+            }
+        }
+        return t;
+    }
+
+    template <typename Validate>
+    void measure(const char* name, Traffic const& t, std::size_t rounds, Validate&& validate)
+    {
+        std::size_t valid { 0 };
+        const auto start { clock::now() };
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t b = 0; b < BATCHES; ++b)
+                valid += validate(t.images.data() + b * BATCH * types::DATAGRAM_SIZE, t.lengths.data() + b * BATCH);
+        const auto ns { std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() };
+
+        const double datagrams { static_cast<double>(rounds * BATCHES * BATCH) };
+        std::printf("  %-10s %6.2f ns/datagram  valid %5.1f%%\n", name, static_cast<double>(ns) / datagrams,
+                    100.0 * static_cast<double>(valid) / datagrams);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t rounds { argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000 };
+    const auto rules { rulesFor<id::ServiceType>() };
+
+    for (unsigned junk : { 0u, 10u, 50u })
+    {
+        const auto traffic { generate(BATCHES, junk) };
+        std::printf("junk %u%%, %zu batches of %zu, %zu rounds\n", junk, BATCHES, BATCH, rounds);
+
+        measure("datagram", traffic, rounds, [](const std::uint8_t* images, const std::uint32_t* lengths) {
+            std::size_t valid { 0 };
+            for (std::size_t i = 0; i < BATCH; ++i)
+            {
+                Datagram<id::ServiceType> d;
+                std::memcpy(d.wireBuffer(), images + i * types::DATAGRAM_SIZE, types::DATAGRAM_SIZE);
+                valid += types::DATAGRAM_SIZE == lengths[i] and d.decodeInPlace() and helper::validateDataram(d);
+            }
+            return valid;
+        });
+
+        for (auto name : { "scalar", "avx2" })
+        {
+            const auto kernels { validator::find(name) };
+            if (nullptr == kernels) continue;
+            measure(name, traffic, rounds, [&](const std::uint8_t* images, const std::uint32_t* lengths) {
+                return static_cast<std::size_t>(__builtin_popcountll(kernels->validate(images, lengths, nullptr, BATCH, rules, types::DATAGRAM_SIZE)));
+            });
+        }
+    }
+    return 0;
+}
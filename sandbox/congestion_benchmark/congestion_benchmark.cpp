@@ -0,0 +1,152 @@
+/*
+ *  Управление скоростью отправки на модели узкого канала: сервер
+ *  30 раз в секунду отдает клиенту обновление больше, чем пропускает
+ *  канал; канал - очередь с отбрасыванием хвоста (буфер на сотню мс,
+ *  bufferbloat) и задержка распространения. Неотправленный к
+ *  следующему тику остаток устаревает и заменяется новым. Обратная
+ *  связь клиента (RTT и потери) приходит каждые 50 мс.
+ *  Сравниваются отправка пачкой без управления, AIMD и режим по
+ *  задержке: полезная скорость, задержка от тика до доставки, потери.
+ *
+ *  g++ -std=c++17 -O2 -pthread -I../../hermesnet -I../../libs/boost/include congestion_benchmark.cpp \
+ *      ../../hermesnet/hermes/data_sender/rate_control.cpp -o congestion_benchmark
+ *  ./congestion_benchmark [link KB/s] [update KB]
+ */
+
+#include <hermes/data_sender/rate_control.h>
+
+#include <queue>
+#include <vector>
+#include <cstdio>
+#include <numeric>
+#include <cstdlib>
+#include <algorithm>
+
+namespace
+{
+    using namespace network;
+    using namespace network::service;
+    using clock = RateControl::clock;
+    using ns = std::chrono::nanoseconds;
+
+    constexpr std::size_t   PACKET      { types::DATAGRAM_SIZE };
+    constexpr ns            STEP        { std::chrono::microseconds(100) };
+    constexpr ns            TICK        { std::chrono::microseconds(33333) };
+    constexpr ns            DELAY       { std::chrono::milliseconds(20) };     // one way
+    constexpr ns            FEEDBACK    { std::chrono::milliseconds(50) };
+    constexpr ns            DURATION    { std::chrono::seconds(30) };
+
+    struct Outcome
+    {
+        clock::time_point   known;      // when the sender learns it
+        ns                  rtt;
+        bool                lost;
+
+        bool operator>(Outcome const& o) const noexcept { return known > o.known; }
+    };
+
+    void run(const char* name, RateControl const* control, double linkRate, std::size_t updateBytes, std::size_t queueBytes)
+    {
+        Clients clients;
+        const clock::time_point start {};
+        if (nullptr != control) control->connect(clients, 0, start);
+
+        std::priority_queue<Outcome, std::vector<Outcome>, std::greater<>> outcomes;
+        std::vector<double> latencies;
+        latencies.reserve(1 << 20);
+
+        clock::time_point linkFree { start };
+        clock::time_point offered { start };        // tick of the pending update
+        std::size_t pending { 0 };                  // packets of the update not sent yet
+        std::uint64_t sent { 0 }, lost { 0 }, stale { 0 }, delivered { 0 };
+        std::uint32_t periodSent { 0 }, periodLost { 0 };
+        ns lastRtt { 0 };
+        clock::time_point nextTick { start }, nextFeedback { start + FEEDBACK };
+
+        for (auto now { start }; now - start < DURATION; now += STEP)
+        {
+            if (now >= nextTick)
+            {
+                stale += pending;
+                pending = updateBytes / PACKET;
+                offered = now;
+                nextTick += TICK;
+            }
+
+            while (0 != pending and (nullptr == control or control->trySend(clients, 0, PACKET, now)))
+            {
+                --pending;
+                ++sent;
+
+                // tail drop bottleneck
+                const double backlog { std::max(0.0, std::chrono::duration<double>(linkFree - now).count()) * linkRate };
+                if (backlog + PACKET > static_cast<double>(queueBytes))
+                {
+                    ++lost;
+                    outcomes.push({ now + 2 * DELAY, ns { 0 }, true });
+                    continue;
+                }
+
+                linkFree = std::max(linkFree, now) + std::chrono::duration_cast<ns>(std::chrono::duration<double>(PACKET / linkRate));
+                const auto arrival { linkFree + DELAY };
+                latencies.push_back(std::chrono::duration<double, std::milli>(arrival - offered).count());
+                ++delivered;
+                outcomes.push({ arrival + DELAY, arrival + DELAY - now, false });
+            }
+
+            while (not outcomes.empty() and outcomes.top().known <= now)
+            {
+                auto const& o { outcomes.top() };
+                ++periodSent;
+                if (o.lost) ++periodLost;
+                else lastRtt = o.rtt;
+                outcomes.pop();
+            }
+
+            if (now >= nextFeedback)
+            {
+                if (nullptr != control and 0 != periodSent and 0 != lastRtt.count())
+                    control->feedback(clients, 0, lastRtt, periodSent, periodLost, now);
+                periodSent = periodLost = 0;
+                nextFeedback += FEEDBACK;
+            }
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        const double mean { latencies.empty() ? 0.0 : std::accumulate(latencies.begin(), latencies.end(), 0.0) / static_cast<double>(latencies.size()) };
+        const double p95 { latencies.empty() ? 0.0 : latencies[latencies.size() * 95 / 100] };
+        const double seconds { std::chrono::duration<double>(DURATION).count() };
+
+        std::printf("%-6s goodput %7.1f KB/s  latency mean %6.1f ms p95 %6.1f ms  link loss %5.1f%%  stale %5.1f%%",
+                    name, static_cast<double>(delivered * PACKET) / seconds / 1024, mean, p95,
+                    100.0 * static_cast<double>(lost) / static_cast<double>(std::max<std::uint64_t>(1, sent)),
+                    100.0 * static_cast<double>(stale) / static_cast<double>(sent + stale + pending));
+        if (nullptr != control) std::printf("  rate %.1f KB/s", clients.vSendRate[0] / 1024);
+        std::printf("\n");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const double linkKb { argc > 1 ? std::strtod(argv[1], nullptr) : 512.0 };
+    const std::size_t updateKb { argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 24 };
+
+    const double linkRate { linkKb * 1024 };
+    const std::size_t queueBytes { static_cast<std::size_t>(linkRate * 0.25) };   // 250 ms of buffer
+
+    std::printf("link %.0f KB/s, %zu KB buffer, %lld ms one way; update %zu KB at 30 Hz (%.0f KB/s offered)\n",
+                linkKb, queueBytes / 1024, static_cast<long long>(DELAY.count() / 1000000), updateKb, updateKb * 30.0);
+
+    RateConfig aimd;
+    aimd.mode = ERateMode::AIMD;
+    RateConfig delay;
+    delay.mode = ERateMode::DELAY;
+
+    const RateControl aimdControl { aimd };
+    const RateControl delayControl { delay };
+
+    run("none", nullptr, linkRate, updateKb * 1024, queueBytes);
+    run("aimd", &aimdControl, linkRate, updateKb * 1024, queueBytes);
+    run("delay", &delayControl, linkRate, updateKb * 1024, queueBytes);
+    return 0;
+}
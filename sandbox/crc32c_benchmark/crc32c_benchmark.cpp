@@ -0,0 +1,120 @@
+/*
+ *  CRC32C датаграмм: цена подсчета (нс на датаграмму) ядрами sse42 и
+ *  slice8 по покрытым словам образа с полной нагрузкой (53 байта,
+ *  все 8 слов) и с короткой (16 байт, 4 слова), и добавка проверки
+ *  контрольной суммы к пакетной валидации (validateBatch с полем и без).
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet -I../../libs/boost/include crc32c_benchmark.cpp \
+ *      ../../hermesnet/hermes/common/crc32c.cpp ../../hermesnet/hermes/common/memory.cpp \
+ *      ../../hermesnet/hermes/message/batch_validator.cpp -o crc32c_benchmark
+ *  ./crc32c_benchmark [rounds]
+ */
+
+#include <hermes/common/crc32c.h>
+#include <hermes/message/datagram.h>
+#include <hermes/message/batch_validator.h>
+#include <hermes/message/service_type_id.h>
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    using namespace network;
+    using namespace network::message;
+    using clock = std::chrono::steady_clock;
+
+    constexpr std::size_t BATCH   { validator::BATCH_MAX };
+    constexpr std::size_t BATCHES { 32 };   // 128 KB of images
+
+    struct Traffic
+    {
+        std::vector<std::uint8_t>   images;
+        std::vector<std::uint32_t>  lengths;
+    };
+
+    Traffic generate(std::size_t payload, bool checksum)
+    {
+        std::mt19937 rng { 42 };
+        Traffic t { std::vector<std::uint8_t>(BATCHES * BATCH * types::DATAGRAM_SIZE), std::vector<std::uint32_t>(BATCHES * BATCH, types::DATAGRAM_SIZE) };
+
+        for (std::size_t i = 0; i < BATCHES * BATCH; ++i)
+        {
+            Header<id::ServiceType> h {};
+            h.type.action = id::ServiceType::EServiceAction::SERVICE_ACT_INPUT;
+            h.access_code = types::SERVER_ACCESS_CODE;
+
+            Datagram<id::ServiceType> d { h, Body {} };
+            for (auto& b : d.Data())
+                b = static_cast<std::uint8_t>(rng());
+            d.BodyRef().size = static_cast<Body::SizeType>(std::min(payload, d.capacity(checksum)));
+            d.Data()[types::END_MESSAGE_BYTE_POS] = types::END_MESSAGE_BYTE;
+            d.encode(t.images.data() + i * types::DATAGRAM_SIZE, checksum);
+        }
+        return t;
+    }
+
+    template <typename Work>
+    double measure(std::size_t rounds, Work&& work)
+    {
+        std::size_t sink { 0 };
+        const auto start { clock::now() };
+        for (std::size_t r = 0; r < rounds; ++r)
+            for (std::size_t b = 0; b < BATCHES; ++b)
+                sink += work(b * BATCH);
+        const auto ns { std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() };
+
+        if (42 == sink) std::printf(" ");
+        return static_cast<double>(ns) / static_cast<double>(rounds * BATCHES * BATCH);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t rounds { argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000 };
+
+    for (std::size_t payload : { std::size_t(16), CAPACITY })
+    {
+        const auto plain { generate(payload, false) };
+        const auto summed { generate(payload, true) };
+        std::printf("payload %zu bytes, %zu rounds of %zu datagrams\n", std::min(payload, CAPACITY - wire::CHECKSUM_SIZE), rounds, BATCHES * BATCH);
+
+        for (auto name : { "sse42", "slice8" })
+        {
+            const auto kernels { checksum::find(name) };
+            if (nullptr == kernels) continue;
+
+            const double ns { measure(rounds, [&](std::size_t first) {
+                std::size_t sum { 0 };
+                for (std::size_t i = first; i < first + BATCH; ++i)
+                {
+                    const auto image { summed.images.data() + i * types::DATAGRAM_SIZE };
+                    sum += kernels->update(~std::uint32_t(0), image, 8 * (wire::checksumWords(image[wire::HEADER_SIZE]) + 1));
+                }
+                return sum;
+            }) };
+            std::printf("  crc32c %-8s %6.2f ns/datagram\n", name, ns);
+        }
+
+        for (auto name : { "avx2", "scalar" })
+        {
+            const auto kernels { validator::find(name) };
+            if (nullptr == kernels) continue;
+
+            const auto rules { rulesFor<id::ServiceType>() };
+            auto validate = [&](Traffic const& t) {
+                return [&](std::size_t first) {
+                    const auto mask { kernels->validate(t.images.data() + first * types::DATAGRAM_SIZE, t.lengths.data() + first, nullptr, BATCH, rules, types::DATAGRAM_SIZE) };
+                    return static_cast<std::size_t>(__builtin_popcountll(mask));
+                };
+            };
+            const double without { measure(rounds, validate(plain)) };
+            const double with { measure(rounds, validate(summed)) };
+            std::printf("  validate %-6s %6.2f ns/datagram, with crc32c %6.2f (+%.2f)\n", name, without, with, with - without);
+        }
+    }
+    return 0;
+}
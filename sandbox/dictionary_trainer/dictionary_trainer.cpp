@@ -0,0 +1,379 @@
+/*
+ *  Тренер словаря сжатия (compression/lz_codec.h) по захвату трафика.
+ *  Читает pcap файлы (классический формат, Ethernet/VLAN, Linux SLL,
+ *  loopback, raw IP; IPv4 и IPv6), берет UDP датаграммы hermes
+ *  (DATAGRAM_SIZE байт), собирает многоблочные сообщения по потокам
+ *  и учит словарь на сообщениях: жадно отбирает куски сообщений с
+ *  самыми частыми k-граммами (по числу сообщений, где они встречаются),
+ *  покрытые k-граммы дальше не считаются. Лучшие куски кладутся в
+ *  конец словаря. Каждое десятое сообщение не участвует в обучении,
+ *  на них печатается степень сжатия без словаря и со словарем.
+ *  Запечатанные и уже сжатые датаграммы пропускаются.
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet -I../../libs/boost/include dictionary_trainer.cpp \
+ *      ../../hermesnet/hermes/compression/lz_codec.cpp ../../hermesnet/hermes/message/block_assembler.cpp ../../hermesnet/hermes/common/arena.cpp \
+ *      ../../hermesnet/hermes/common/memory.cpp -o dictionary_trainer
+ *  ./dictionary_trainer [-o dictionary.bin] [-s bytes] [-p udp port] capture.pcap...
+ */
+
+#include <hermes/common/types.h>
+#include <hermes/message/header.h>
+#include <hermes/message/datagram.h>
+#include <hermes/message/block_assembler.h>
+#include <hermes/compression/lz_codec.h>
+
+#include <map>
+#include <array>
+#include <queue>
+#include <memory>
+#include <chrono>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <algorithm>
+#include <unordered_map>
+
+using namespace network;
+using namespace network::message;
+using namespace network::compression;
+
+namespace
+{
+    using byte = std::uint8_t;
+    using Sample = std::vector<byte>;
+    using clock = std::chrono::steady_clock;
+
+    constexpr std::size_t KMER      { 6 };      // bytes of a counted fragment
+    constexpr std::size_t SEGMENT   { 32 };     // dictionary piece
+    constexpr std::size_t STEP      { 8 };      // candidate pieces start every STEP bytes
+    constexpr std::size_t HOLDOUT   { 10 };     // every HOLDOUT-th message is for evaluation
+
+    // ----------------------------- pcap -----------------------------
+
+    enum ELinkType : std::uint32_t
+    {
+        LINK_NULL       = 0,
+        LINK_ETHERNET   = 1,
+        LINK_RAW        = 101,
+        LINK_LINUX_SLL  = 113,
+        LINK_IPV4       = 228,
+        LINK_IPV6       = 229,
+    };
+
+    std::uint16_t be16(const byte* p) { return static_cast<std::uint16_t>((p[0] << 8) | p[1]); }
+
+    struct Udp
+    {
+        std::string flow;       // source and destination addresses and ports
+        const byte* payload { nullptr };
+        std::size_t size    { 0 };
+        std::uint16_t source { 0 }, destination { 0 };
+    };
+
+    // UDP datagram of the IP packet, false - not UDP or truncated
+    bool parseIp(const byte* p, std::size_t n, Udp& udp)
+    {
+        if (n < 1) return false;
+
+        std::size_t header { 0 }, addresses { 0 }, length { 0 };
+        if (4 == (p[0] >> 4))
+        {
+            header = std::size_t(p[0] & 0x0f) * 4;
+            if (n < 20 or header < 20 or n < header or 17 != p[9]) return false;
+            if (0 != (be16(p + 6) & 0x3fff)) return false;  // fragments
+            addresses = 12;
+            length = 8;
+        }
+        else if (6 == (p[0] >> 4))
+        {
+            header = 40;
+            if (n < header or 17 != p[6]) return false;     // extension headers are not followed
+            addresses = 8;
+            length = 32;
+        }
+        else return false;
+
+        if (n < header + 8) return false;
+        const byte* u { p + header };
+        const std::size_t total { be16(u + 4) };
+        if (total < 8 or header + total > n) return false;
+
+        udp.flow.assign(reinterpret_cast<const char*>(p + addresses), length);
+        udp.flow.append(reinterpret_cast<const char*>(u), 4);
+        udp.source = be16(u);
+        udp.destination = be16(u + 2);
+        udp.payload = u + 8;
+        udp.size = total - 8;
+        return true;
+    }
+
+    bool parseFrame(std::uint32_t link, const byte* p, std::size_t n, Udp& udp)
+    {
+        switch (link)
+        {
+            case LINK_NULL:
+                return n > 4 and parseIp(p + 4, n - 4, udp);
+            case LINK_RAW:
+            case LINK_IPV4:
+            case LINK_IPV6:
+                return parseIp(p, n, udp);
+            case LINK_LINUX_SLL:
+                return n > 16 and parseIp(p + 16, n - 16, udp);
+            case LINK_ETHERNET:
+            {
+                std::size_t at { 12 };
+                while (n >= at + 2 and (0x8100 == be16(p + at) or 0x88a8 == be16(p + at)))
+                    at += 4;    // VLAN tags
+                if (n < at + 2) return false;
+                const auto type { be16(p + at) };
+                if (0x0800 != type and 0x86dd != type) return false;
+                return parseIp(p + at + 2, n - at - 2, udp);
+            }
+            default:
+                return false;
+        }
+    }
+
+    // UDP payloads of the capture, false - not a pcap file
+    template <typename Handler>
+    bool readPcap(const char* path, Handler&& handler)
+    {
+        std::ifstream file { path, std::ios::binary };
+        std::vector<byte> data { std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>() };
+        if (data.size() < 24) return false;
+
+        std::uint32_t magic;
+        std::memcpy(&magic, data.data(), 4);
+        const bool swapped { 0xd4c3b2a1 == magic or 0x4d3cb2a1 == magic };
+        if (not swapped and 0xa1b2c3d4 != magic and 0xa1b23c4d != magic) return false;
+
+        auto u32 = [&](std::size_t at) {
+            std::uint32_t v;
+            std::memcpy(&v, data.data() + at, 4);
+            return swapped ? __builtin_bswap32(v) : v;
+        };
+
+        const std::uint32_t link { u32(20) & 0x0fffffff };
+        for (std::size_t at = 24; at + 16 <= data.size(); )
+        {
+            const std::size_t captured { u32(at + 8) };
+            at += 16;
+            if (at + captured > data.size()) break;
+
+            Udp udp;
+            if (parseFrame(link, data.data() + at, captured, udp)) handler(udp);
+            at += captured;
+        }
+        return true;
+    }
+
+    // --------------------------- messages ---------------------------
+
+    struct Messages
+    {
+        std::vector<Sample>                                     samples;
+        std::map<std::string, std::unique_ptr<BlockAssembler>>  flows;
+        std::size_t     datagrams   { 0 };
+        std::size_t     skipped     { 0 };      // sealed, compressed or malformed
+
+        void add(Udp const& udp)
+        {
+            if (types::DATAGRAM_SIZE != udp.size) return;
+            ++datagrams;
+
+            const byte* image { udp.payload };
+            const byte flags { image[wire::HEADER_SIZE - 1] };
+            const std::size_t size { image[wire::HEADER_SIZE] };
+            const byte* payload { image + wire::PAYLOAD_OFFSET };
+            if ((flags & (wire::FLAG_ENCODE | wire::FLAG_COMPRESS)) or size > wire::capacity(flags)) {
+                ++skipped;
+                return;
+            }
+            if (0 == (flags & wire::FLAG_BLOCKS))
+            {
+                if (0 != size) samples.emplace_back(payload, payload + size);
+                return;
+            }
+
+            auto& assembler { flows[udp.flow] };
+            if (nullptr == assembler) assembler = std::make_unique<BlockAssembler>();
+            const byte num { payload[CAPACITY - 2] }, count { payload[CAPACITY - 1] };
+            if (assembler->add(image[2], num, count, payload, size))
+                samples.emplace_back(assembler->data(), assembler->data() + assembler->size());
+        }
+    };
+
+    // --------------------------- training ---------------------------
+
+    std::uint64_t kmer(const byte* p)
+    {
+        std::uint64_t v { 0 };
+        std::memcpy(&v, p, KMER);
+        return v;
+    }
+
+    // distinct k-grams of the piece
+    void kmers(const byte* p, std::size_t n, std::vector<std::uint64_t>& out)
+    {
+        out.clear();
+        for (std::size_t i = 0; i + KMER <= n; ++i)
+            out.push_back(kmer(p + i));
+        std::sort(out.begin(), out.end());
+        out.erase(std::unique(out.begin(), out.end()), out.end());
+    }
+
+    Sample train(std::vector<const Sample*> const& samples, std::size_t capacity)
+    {
+        // in how many messages each k-gram occurs
+        std::unordered_map<std::uint64_t, std::uint32_t> frequency;
+        std::vector<std::uint64_t> grams;
+        for (auto s : samples)
+        {
+            kmers(s->data(), s->size(), grams);
+            for (auto g : grams) ++frequency[g];
+        }
+
+        struct Piece { const byte* data; std::size_t size; };
+        std::vector<Piece> pieces;
+        for (auto s : samples)
+            for (std::size_t at = 0; at + KMER <= s->size(); at += STEP)
+                pieces.push_back({ s->data() + at, std::min(SEGMENT, s->size() - at) });
+
+        // k-grams seen once do not help other messages
+        auto score = [&](Piece const& piece) {
+            kmers(piece.data, piece.size, grams);
+            std::uint64_t sum { 0 };
+            for (auto g : grams)
+            {
+                const auto f { frequency[g] };
+                if (f > 1) sum += f;
+            }
+            return sum;
+        };
+
+        // lazy greedy: scores only go down as k-grams get covered
+        std::priority_queue<std::pair<std::uint64_t, std::size_t>> queue;
+        for (std::size_t i = 0; i < pieces.size(); ++i)
+            queue.emplace(score(pieces[i]), i);
+
+        std::vector<Piece> chosen;
+        std::size_t total { 0 };
+        while (not queue.empty() and total < capacity)
+        {
+            const auto [stale, i] { queue.top() };
+            queue.pop();
+            if (0 == stale) break;
+
+            const auto fresh { score(pieces[i]) };
+            if (not queue.empty() and fresh < queue.top().first)
+            {
+                queue.emplace(fresh, i);
+                continue;
+            }
+            if (0 == fresh) break;
+
+            chosen.push_back(pieces[i]);
+            total += pieces[i].size;
+            kmers(pieces[i].data, pieces[i].size, grams);
+            for (auto g : grams) frequency[g] = 0;
+        }
+
+        // the best pieces go last, the dictionary keeps its tail
+        Sample dictionary;
+        for (auto it { chosen.rbegin() }; it != chosen.rend(); ++it)
+            dictionary.insert(dictionary.end(), it->data, it->data + it->size);
+        if (dictionary.size() > capacity)
+            dictionary.erase(dictionary.begin(), dictionary.end() - static_cast<std::ptrdiff_t>(capacity));
+        return dictionary;
+    }
+
+    void evaluate(const char* what, std::vector<const Sample*> const& samples, Dictionary const* dictionary)
+    {
+        CompressConfig config { ECompressMode::LZ, dictionary, 1 };
+        Compressor compressor { config };
+        std::vector<byte> packed(MAX_MESSAGE), unpacked(MAX_MESSAGE);
+
+        std::size_t raw { 0 }, sent { 0 }, compressed { 0 }, failed { 0 };
+        clock::duration packing {}, unpacking {};
+        for (auto s : samples)
+        {
+            auto start { clock::now() };
+            const auto size { compressor.compress(s->data(), s->size(), packed.data(), packed.size()) };
+            packing += clock::now() - start;
+
+            raw += s->size();
+            sent += 0 != size ? size : s->size();
+            if (0 == size) continue;
+            ++compressed;
+
+            start = clock::now();
+            const auto back { decompress(config, packed.data(), size, unpacked.data(), unpacked.size()) };
+            unpacking += clock::now() - start;
+            if (back != s->size() or 0 != std::memcmp(unpacked.data(), s->data(), back)) ++failed;
+        }
+
+        auto rate = [](std::size_t bytes, clock::duration d) {
+            const auto ns { std::chrono::duration_cast<std::chrono::nanoseconds>(d).count() };
+            return 0 != ns ? static_cast<double>(bytes) * 1e3 / static_cast<double>(ns) : 0.0;
+        };
+        std::printf("  %-18s %6.1f%% of raw, %zu of %zu compressed, %7.1f MB/s packing, %7.1f MB/s unpacking%s\n", what,
+                    0 != raw ? 100.0 * static_cast<double>(sent) / static_cast<double>(raw) : 100.0, compressed, samples.size(),
+                    rate(raw, packing), rate(raw, unpacking), 0 != failed ? ", ROUND TRIP FAILED" : "");
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const char* output { "dictionary.bin" };
+    std::size_t capacity { MAX_DICTIONARY };
+    long port { -1 };
+    std::vector<const char*> captures;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg { argv[i] };
+        if ("-o" == arg and i + 1 < argc) output = argv[++i];
+        else if ("-s" == arg and i + 1 < argc) capacity = std::min<std::size_t>(std::strtoul(argv[++i], nullptr, 10), MAX_DICTIONARY);
+        else if ("-p" == arg and i + 1 < argc) port = std::strtol(argv[++i], nullptr, 10);
+        else captures.push_back(argv[i]);
+    }
+    if (captures.empty())
+    {
+        std::fprintf(stderr, "usage: %s [-o dictionary.bin] [-s bytes] [-p udp port] capture.pcap...\n", argv[0]);
+        return 1;
+    }
+
+    Messages messages;
+    for (auto path : captures)
+    {
+        const bool ok { readPcap(path, [&](Udp const& udp) {
+            if (port < 0 or port == udp.source or port == udp.destination) messages.add(udp);
+        }) };
+        if (not ok) std::fprintf(stderr, "%s: not a pcap file\n", path);
+    }
+
+    std::vector<const Sample*> training, holdout;
+    for (std::size_t i = 0; i < messages.samples.size(); ++i)
+        (0 == i % HOLDOUT ? holdout : training).push_back(&messages.samples[i]);
+
+    std::size_t bytes { 0 };
+    for (auto const& s : messages.samples) bytes += s.size();
+    std::printf("%zu datagrams (%zu skipped), %zu messages, %zu bytes\n", messages.datagrams, messages.skipped, messages.samples.size(), bytes);
+    if (training.empty()) return 1;
+
+    const auto start { clock::now() };
+    const auto trained { train(training, capacity) };
+    const auto ms { std::chrono::duration_cast<std::chrono::milliseconds>(clock::now() - start).count() };
+    std::printf("dictionary %zu bytes in %lld ms -> %s\n", trained.size(), static_cast<long long>(ms), output);
+
+    std::ofstream { output, std::ios::binary }.write(reinterpret_cast<const char*>(trained.data()), static_cast<std::streamsize>(trained.size()));
+
+    const auto dictionary { std::make_unique<Dictionary>(trained.data(), trained.size()) };
+    std::printf("holdout messages:\n");
+    evaluate("no dictionary", holdout, nullptr);
+    evaluate("trained dictionary", holdout, dictionary.get());
+    return 0;
+}
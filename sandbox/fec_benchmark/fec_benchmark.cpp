@@ -0,0 +1,102 @@
+/*
+ *  FEC: скорость умножения блока на константу в GF(2^8) по ядрам
+ *  (таблица / SSSE3 / AVX2) и доля потерь после восстановления при
+ *  случайной потере пакетов для XOR и Рида-Соломона с разным числом
+ *  пакетов четности; накладные расходы - в байтах на полезный байт.
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet -I../../libs/boost/include fec_benchmark.cpp \
+ *      ../../hermesnet/hermes/fec/gf256.cpp ../../hermesnet/hermes/fec/fec_codec.cpp -o fec_benchmark
+ *  ./fec_benchmark [loss %]
+ */
+
+#include <hermes/fec/fec_codec.h>
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    using namespace network::fec;
+    using clock = std::chrono::steady_clock;
+
+    constexpr std::size_t PACKETS { 100000 };
+
+    void kernels()
+    {
+        std::vector<std::uint8_t> src(SHARD_BYTES * 256, 0x5a), dst(src.size(), 0);
+        for (const char* name : { "table", "ssse3", "avx2" })
+        {
+            auto k { gf256::find(name) };
+            if (nullptr == k) {
+                std::printf("%-6s not supported\n", name);
+                continue;
+            }
+
+            const auto start { clock::now() };
+            for (std::size_t round = 0; round < 2000; ++round)
+                for (std::size_t i = 0; i < 256; ++i)
+                    k->mulAdd(dst.data() + i * SHARD_BYTES, src.data() + i * SHARD_BYTES, static_cast<std::uint8_t>(i | 2), SHARD_BYTES);
+            const double s { std::chrono::duration<double>(clock::now() - start).count() };
+
+            std::printf("%-6s %8.2f ns/shard  %6.2f GB/s%s\n", name, s * 1e9 / (2000.0 * 256),
+                        2000.0 * static_cast<double>(src.size()) / s / 1e9, 0x42 == dst[7] ? " " : "");
+        }
+    }
+
+    void run(FecConfig config, double loss)
+    {
+        FecEncoder encoder { config };
+        FecDecoder decoder { config };
+        std::mt19937 rng { 7 };
+        std::bernoulli_distribution drop { loss };
+
+        std::uint8_t payload[MAX_PAYLOAD];
+        std::uint8_t packet[HEADER_SIZE + SHARD_BYTES];
+        std::size_t delivered { 0 }, wire { 0 };
+        auto count { [&](const std::uint8_t*, std::size_t) { ++delivered; } };
+
+        const auto start { clock::now() };
+        for (std::size_t i = 0; i < PACKETS; ++i)
+        {
+            for (auto& b : payload) b = static_cast<std::uint8_t>(rng());
+            auto n { encoder.protect(payload, sizeof(payload), packet) };
+            wire += n;
+            if (not drop(rng)) decoder.receive(packet, n, count);
+
+            for (std::size_t p = 0; p < encoder.parityReady(); ++p)
+            {
+                n = encoder.parity(p, packet);
+                wire += n;
+                if (not drop(rng)) decoder.receive(packet, n, count);
+            }
+        }
+        const double us { std::chrono::duration<double, std::micro>(clock::now() - start).count() };
+
+        const char* mode { EFecMode::NONE == config.mode ? "none" : EFecMode::XOR == config.mode ? "xor" : "rs" };
+        std::printf("%-4s k=%2u m=%2zu  overhead %5.1f%%  loss after %6.3f%%  recovered %7llu  %.2f us/packet\n",
+                    mode, config.sources, config.parityCount(),
+                    100.0 * (static_cast<double>(wire) / (PACKETS * sizeof(payload)) - 1.0),
+                    100.0 * (1.0 - static_cast<double>(delivered) / PACKETS),
+                    static_cast<unsigned long long>(decoder.recovered()), us / PACKETS);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const double loss { (argc > 1 ? std::strtod(argv[1], nullptr) : 5.0) / 100.0 };
+
+    std::printf("GF(2^8) dst ^= c * src, %zu byte shards (active: %s)\n", SHARD_BYTES, gf256::active->name);
+    kernels();
+
+    std::printf("\nrandom loss %.1f%%, %zu packets of %zu bytes\n", loss * 100.0, PACKETS, MAX_PAYLOAD);
+    run({ EFecMode::NONE, 1, 1 }, loss);
+    run({ EFecMode::XOR, 4, 1 }, loss);
+    run({ EFecMode::XOR, 8, 1 }, loss);
+    run({ EFecMode::REED_SOLOMON, 8, 2 }, loss);
+    run({ EFecMode::REED_SOLOMON, 8, 4 }, loss);
+    run({ EFecMode::REED_SOLOMON, 16, 4 }, loss);
+    return 0;
+}
@@ -0,0 +1,117 @@
+/*
+ *  Промахи dTLB при обходе таблицы клиентов (записи по 64 байта,
+ *  случайный порядок, как при обработке всех клиентов за тик)
+ *  в памяти на обычных и больших страницах.
+ *  Счетчики perf недоступны без прав (kernel.perf_event_paranoid) -
+ *  тогда выводится только время.
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet huge_page_benchmark.cpp ../../hermesnet/hermes/common/huge_pages.cpp -o huge_page_benchmark
+ *  ./huge_page_benchmark [table MB]
+ */
+
+#include <hermes/common/huge_pages.h>
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include <numeric>
+#include <algorithm>
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr std::size_t RECORD_SIZE { 64 };
+    constexpr std::size_t TICKS       { 20 };
+
+    // dTLB load misses of this thread, -1 if counters are not available
+    class DtlbCounter
+    {
+    private:
+        int fd_ { -1 };
+
+    public:
+        DtlbCounter() noexcept {
+            perf_event_attr attr {};
+            attr.size = sizeof(attr);
+            attr.type = PERF_TYPE_HW_CACHE;
+            attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+            attr.disabled = 1;
+            attr.exclude_kernel = 1;
+            attr.exclude_hv = 1;
+            fd_ = static_cast<int>(syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0));
+        }
+        ~DtlbCounter() { if (fd_ >= 0) close(fd_); }
+
+        void start() noexcept {
+            if (fd_ < 0) return;
+            ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+            ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+        }
+
+        long long stop() noexcept {
+            if (fd_ < 0) return -1;
+            ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+            long long value { 0 };
+            return sizeof(value) == read(fd_, &value, sizeof(value)) ? value : -1;
+        }
+    };
+
+    void run(memory::EPagePolicy policy, std::size_t bytes, std::vector<std::uint32_t> const& order)
+    {
+        const auto region { memory::mapRegion(bytes, policy, true) };
+        if (nullptr == region.data) {
+            std::printf("%-12s mapping failed\n", memory::getPagePolicyName(policy));
+            return;
+        }
+
+        auto table { static_cast<std::uint8_t*>(region.data) };
+        std::uint64_t sum { 0 };
+
+        DtlbCounter counter;
+        counter.start();
+        const auto start { clock::now() };
+
+        for (std::size_t tick = 0; tick < TICKS; ++tick)
+            for (auto i : order)
+            {
+                auto record { table + static_cast<std::size_t>(i) * RECORD_SIZE };
+                sum += record[0];
+                record[1] = static_cast<std::uint8_t>(tick);
+            }
+
+        const auto ns { std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() };
+        const auto misses { counter.stop() };
+
+        const double touches { static_cast<double>(TICKS * order.size()) };
+        std::printf("%-12s (got %-11s) %8.2f ns/record", memory::getPagePolicyName(policy),
+                    memory::getPagePolicyName(region.pages), static_cast<double>(ns) / touches);
+        if (misses >= 0) std::printf("  dTLB misses %lld (%.3f per record)", misses, static_cast<double>(misses) / touches);
+        std::printf("%s\n", 42 == sum ? " " : "");
+
+        memory::unmapRegion(region);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t mb { argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 64 };
+    const std::size_t bytes { mb << 20 };
+
+    std::vector<std::uint32_t> order(bytes / RECORD_SIZE);
+    std::iota(order.begin(), order.end(), 0u);
+    std::shuffle(order.begin(), order.end(), std::mt19937 { 42 });
+
+    std::printf("client table %zu MB, %zu records of %zu bytes, %zu ticks\n", mb, order.size(), RECORD_SIZE, TICKS);
+    for (auto policy : { memory::EPagePolicy::REGULAR, memory::EPagePolicy::TRANSPARENT, memory::EPagePolicy::EXPLICIT })
+        run(policy, bytes, order);
+    return 0;
+}
@@ -0,0 +1,86 @@
+/*
+ *  Ограничение входа: цена проверки датаграммы (нс) для клиентского
+ *  сокета, для известного источника и при потоке со случайных адресов
+ *  (таблица источников переполнена), и доля пропущенных датаграмм
+ *  подключенных клиентов во время такого потока под нагрузкой.
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet -I../../libs/boost/include ingress_benchmark.cpp \
+ *      ../../hermesnet/hermes/data_receiver/ingress_limiter.cpp -o ingress_benchmark
+ *  ./ingress_benchmark [packets]
+ */
+
+#include <hermes/data_receiver/ingress_limiter.h>
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace
+{
+    using namespace network::service;
+    using clock = IngressLimiter::clock;
+    using address = boost::asio::ip::address;
+
+    template <typename Check>
+    double measure(std::size_t packets, Check&& check)
+    {
+        std::size_t admitted { 0 };
+        const auto start { clock::now() };
+        for (std::size_t i = 0; i < packets; ++i)
+            admitted += check(i) ? 1 : 0;
+        const double ns { std::chrono::duration<double, std::nano>(clock::now() - start).count() };
+        std::printf("  admitted %5.1f%%", 100.0 * static_cast<double>(admitted) / static_cast<double>(packets));
+        return ns / static_cast<double>(packets);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t packets { argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10000000 };
+    IngressLimiter limiter { IngressConfig {} };
+
+    // time advances 1 us per datagram: 1 Mpps in total, 10 pps per client under flood
+    const auto base { clock::now() };
+    std::size_t elapsed { 0 };  // continues across runs
+    auto at { [base, &elapsed]() { return base + std::chrono::microseconds(elapsed++); } };
+
+    std::printf("client socket (%zu clients round robin)", std::size_t(100));
+    std::printf("  %.1f ns/packet\n", measure(packets, [&](std::size_t i) { return limiter.admitClient(i % 100, at()); }));
+
+    std::vector<address> clients;
+    for (std::uint32_t i = 0; i < 100; ++i)
+    {
+        clients.emplace_back(boost::asio::ip::address_v4 { 0x0a000001u + i });
+        limiter.establish(clients.back(), base);
+    }
+
+    std::printf("established sources      ");
+    std::printf("  %.1f ns/packet\n", measure(packets, [&](std::size_t i) { return limiter.admitSource(clients[i % 100], at(), 0.0f); }));
+
+    std::mt19937 rng { 1 };
+    std::vector<address> flood;
+    for (std::size_t i = 0; i < 1 << 16; ++i) flood.emplace_back(boost::asio::ip::address_v4 { static_cast<std::uint32_t>(rng()) });
+
+    std::printf("random source flood      ");
+    std::printf("  %.1f ns/packet\n", measure(packets, [&](std::size_t i) { return limiter.admitSource(flood[i & 0xffff], at(), 0.0f); }));
+
+    // overloaded: every 100th datagram comes from a client
+    std::size_t clientPackets { 0 }, clientAdmitted { 0 };
+    std::printf("flood under load         ");
+    std::printf("  %.1f ns/packet", measure(packets, [&](std::size_t i) {
+        if (0 != i % 100) return limiter.admitSource(flood[i & 0xffff], at(), 0.9f);
+        ++clientPackets;
+        const bool ok { limiter.admitSource(clients[(i / 100) % 100], at(), 0.9f) };
+        clientAdmitted += ok ? 1 : 0;
+        return ok;
+    }));
+    std::printf("  clients admitted %.1f%%\n", 100.0 * static_cast<double>(clientAdmitted) / static_cast<double>(clientPackets));
+
+    auto const& s { limiter.stats() };
+    std::printf("stats: admitted %llu, client limited %llu, source limited %llu, shed %llu\n",
+                static_cast<unsigned long long>(s.admitted), static_cast<unsigned long long>(s.clientLimited),
+                static_cast<unsigned long long>(s.sourceLimited), static_cast<unsigned long long>(s.shed));
+    return 0;
+}
@@ -0,0 +1,126 @@
+/*
+ *  Отбор релевантных сущностей: сетка InterestGrid против перебора
+ *  всех пар (сущность, клиент). Сущности и клиенты случайно блуждают,
+ *  для нескольких радиусов обзора выводится время обновления сетки
+ *  и пересчета релевантности за тик, среднее число релевантных
+ *  сущностей на клиента и число входов/выходов из обзора за тик
+ *  с гистерезисом и без него.
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet -I../../libs/boost/include interest_benchmark.cpp \
+ *      ../../hermesnet/hermes/replication/interest_grid.cpp -o interest_benchmark
+ *  ./interest_benchmark [entities] [clients]
+ */
+
+#include <hermes/replication/interest_grid.h>
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace network::replication;
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr std::size_t   TICKS       { 20 };
+    constexpr float         AREA        { 2048.0f };    // half size of the populated area
+    constexpr float         STEP        { 1.5f };       // meters per tick
+
+    struct Walkers
+    {
+        std::vector<float> x, z;
+
+        Walkers(std::size_t count, std::mt19937& rng) : x(count), z(count) {
+            std::uniform_real_distribution<float> area { -AREA, AREA };
+            for (std::size_t i = 0; i < count; ++i) { x[i] = area(rng); z[i] = area(rng); }
+        }
+
+        void step(std::mt19937& rng) {
+            std::uniform_real_distribution<float> step { -STEP, STEP };
+            for (std::size_t i = 0; i < x.size(); ++i) { x[i] += step(rng); z[i] += step(rng); }
+        }
+    };
+
+    double usSince(clock::time_point start) {
+        return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count()) / 1000.0;
+    }
+
+    void run(std::size_t entities, std::size_t clients, float radius, float hysteresis, bool bruteForce)
+    {
+        InterestConfig config;
+        config.maxEntities = entities;
+        config.maxClients = clients;
+        config.cellSize = radius;
+        config.hysteresis = hysteresis;
+        InterestGrid grid { config };
+
+        std::mt19937 rng { 42 };
+        Walkers things { entities, rng };
+        Walkers viewers { clients, rng };
+
+        double placeUs { 0 }, updateUs { 0 }, bruteUs { 0 };
+        std::size_t changes { 0 }, relevant { 0 };
+
+        for (std::size_t tick = 0; tick <= TICKS; ++tick)
+        {
+            things.step(rng);
+            viewers.step(rng);
+
+            auto start { clock::now() };
+            for (std::size_t i = 0; i < entities; ++i)
+                grid.place(static_cast<EntityId>(i), things.x[i], things.z[i]);
+            for (std::size_t c = 0; c < clients; ++c)
+                grid.setViewer(static_cast<ClientIndex>(c), viewers.x[c], viewers.z[c], radius);
+            const auto place { usSince(start) };
+
+            start = clock::now();
+            grid.update();
+            const auto update { usSince(start) };
+
+            // first tick fills the grid and every view
+            if (0 == tick) continue;
+            placeUs += place;
+            updateUs += update;
+            changes += grid.changes();
+
+            if (bruteForce)
+            {
+                start = clock::now();
+                std::size_t found { 0 };
+                const float r2 { radius * radius };
+                for (std::size_t c = 0; c < clients; ++c)
+                    for (std::size_t i = 0; i < entities; ++i)
+                    {
+                        const float dx { things.x[i] - viewers.x[c] };
+                        const float dz { things.z[i] - viewers.z[c] };
+                        found += dx * dx + dz * dz <= r2;
+                    }
+                bruteUs += usSince(start);
+                relevant += found;
+            }
+        }
+
+        std::printf("radius %5.0f hysteresis %.2f: place %7.1f us, update %8.1f us", radius, hysteresis, placeUs / TICKS, updateUs / TICKS);
+        if (bruteForce)
+            std::printf(", brute force %9.1f us, %6.1f relevant/client", bruteUs / TICKS,
+                        static_cast<double>(relevant) / TICKS / static_cast<double>(clients));
+        std::printf(", %6.1f enter+leave/tick\n", static_cast<double>(changes) / TICKS);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t entities { argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000 };
+    const std::size_t clients  { argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 1'000 };
+
+    std::printf("%zu entities, %zu clients in %.0f x %.0f m, %zu ticks\n", entities, clients, 2 * AREA, 2 * AREA, TICKS);
+    for (float radius : { 64.0f, 128.0f, 256.0f, 512.0f })
+    {
+        run(entities, clients, radius, 0.0f, true);
+        run(entities, clients, radius, 0.2f, false);
+    }
+    return 0;
+}
@@ -0,0 +1,99 @@
+/*
+ *  Дельта-репликация: размер обновления на клиента (полный снимок
+ *  против дельты к подтвержденному снимку) и время кодирования тика
+ *  для всех клиентов в зависимости от числа потоков кодирования.
+ *  Каждый тик двигается часть сущностей, клиенты подтверждают снимки
+ *  с задержкой в несколько тиков. Последний прогон - с бюджетом
+ *  на обновление клиента (отбор по накопленному приоритету).
+ *
+ *  g++ -std=c++17 -O2 -pthread -I../../hermesnet -I../../libs/boost/include replication_benchmark.cpp \
+ *      ../../hermesnet/hermes/replication/entity_state.cpp ../../hermesnet/hermes/replication/snapshot.cpp \
+ *      ../../hermesnet/hermes/replication/delta_codec.cpp ../../hermesnet/hermes/replication/replication_engine.cpp \
+ *      ../../hermesnet/hermes/replication/interest_grid.cpp ../../hermesnet/hermes/replication/priority_accumulator.cpp \
+ *      -o replication_benchmark
+ *  ./replication_benchmark [entities] [clients] [max workers]
+ */
+
+#include <hermes/replication/replication_engine.h>
+
+#include <chrono>
+#include <random>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+using namespace network::replication;
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    constexpr Tick      TICKS       { 200 };
+    constexpr Tick      ACK_DELAY   { 4 };      // ticks of round trip
+    constexpr unsigned  MOVING      { 10 };     // percent of entities moving per tick
+
+    void run(std::size_t entities, std::size_t clients, std::uint32_t workers, std::size_t budget = 0)
+    {
+        ReplicationConfig config;
+        config.maxEntities = entities;
+        config.maxClients = clients;
+        config.streamBytes = entities * sizeof(EntityState);
+        config.workers = workers;
+        config.budgetBytes = budget;
+        ReplicationEngine engine { config };
+
+        std::mt19937 rng { 42 };
+        std::uniform_real_distribution<float> world { -WORLD_BOUND, WORLD_BOUND };
+        std::vector<EntityTransform> state(entities);
+        for (auto& e : state)
+            for (auto& p : e.position) p = world(rng);
+
+        for (std::size_t c = 0; c < clients; ++c)
+            engine.connect(static_cast<ClientIndex>(c));
+
+        std::size_t fullBytes { 0 }, fullCount { 0 }, deltaBytes { 0 }, deltaCount { 0 };
+        std::chrono::nanoseconds encoding { 0 };
+
+        for (Tick tick = 1; tick <= TICKS; ++tick)
+        {
+            for (auto& e : state)
+                if (rng() % 100 < MOVING) e.position[0] += 0.25f;
+
+            auto& snapshot { engine.beginSnapshot(tick) };
+            for (std::size_t i = 0; i < entities; ++i)
+                snapshot.add(static_cast<EntityId>(i), state[i]);
+            engine.commitSnapshot(snapshot);
+
+            const auto start { clock::now() };
+            engine.encode();
+            encoding += clock::now() - start;
+
+            for (std::size_t c = 0; c < clients; ++c)
+            {
+                const auto stream { engine.stream(static_cast<ClientIndex>(c)) };
+                (stream.full ? fullBytes : deltaBytes) += stream.size;
+                ++(stream.full ? fullCount : deltaCount);
+                if (tick > ACK_DELAY) engine.acknowledge(static_cast<ClientIndex>(c), tick - ACK_DELAY);
+            }
+        }
+
+        if (0 != budget) std::printf("budget %zu B ", budget);
+        std::printf("workers %u: encode %8.1f us/tick, full %7.0f B/client, delta %6.0f B/client\n", workers,
+                    static_cast<double>(encoding.count()) / 1000.0 / TICKS,
+                    fullCount ? static_cast<double>(fullBytes) / static_cast<double>(fullCount) : 0.0,
+                    deltaCount ? static_cast<double>(deltaBytes) / static_cast<double>(deltaCount) : 0.0);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t   entities    { argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 2000 };
+    const std::size_t   clients     { argc > 2 ? std::strtoul(argv[2], nullptr, 10) : 64 };
+    const std::uint32_t maxWorkers  { argc > 3 ? static_cast<std::uint32_t>(std::strtoul(argv[3], nullptr, 10)) : 3 };
+
+    std::printf("%zu entities, %zu clients, %u%% moving per tick, ack delay %u ticks\n", entities, clients, MOVING, ACK_DELAY);
+    for (std::uint32_t workers = 0; workers <= maxWorkers; ++workers)
+        run(entities, clients, workers);
+    run(entities, clients, 0, 1200);
+    return 0;
+}
@@ -0,0 +1,149 @@
+/*
+ *  Проверка ChaCha20-Poly1305 по векторам RFC 8439: блок ChaCha20 (2.3.2)
+ *  и AEAD (2.8.2). Каждый набор ядер (scalar, avx2 если есть) считается
+ *  отдельно через crypto::find, пачками шире ядра, чтобы задеть и полные
+ *  группы линий, и хвост; затем seal/open активного набора. Код возврата 1
+ *  при любом расхождении.
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet rfc8439_check.cpp \
+ *      ../../hermesnet/hermes/crypto/chacha20_poly1305.cpp ../../hermesnet/hermes/common/memory.cpp -o rfc8439_check
+ */
+
+#include <hermes/crypto/chacha20_poly1305.h>
+
+#include <array>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace
+{
+    using byte = std::uint8_t;
+
+    // 2.3.2: key 00..1f, block counter 1
+    constexpr std::array<byte, crypto::NONCE_SIZE> BLOCK_NONCE { 0x00, 0x00, 0x00, 0x09, 0x00, 0x00, 0x00, 0x4a, 0x00, 0x00, 0x00, 0x00 };
+    constexpr std::uint32_t BLOCK_COUNTER { 1 };
+    constexpr std::array<byte, crypto::BLOCK_SIZE> BLOCK_OUT {
+        0x10, 0xf1, 0xe7, 0xe4, 0xd1, 0x3b, 0x59, 0x15, 0x50, 0x0f, 0xdd, 0x1f, 0xa3, 0x20, 0x71, 0xc4,
+        0xc7, 0xd1, 0xf4, 0xc7, 0x33, 0xc0, 0x68, 0x03, 0x04, 0x22, 0xaa, 0x9a, 0xc3, 0xd4, 0x6c, 0x4e,
+        0xd2, 0x82, 0x64, 0x46, 0x07, 0x9f, 0xaa, 0x09, 0x14, 0xc2, 0xd7, 0x05, 0xd9, 0x8b, 0x02, 0xa2,
+        0xb5, 0x12, 0x9c, 0xd1, 0xde, 0x16, 0x4e, 0xb9, 0xcb, 0xd0, 0x83, 0xe8, 0xa2, 0x50, 0x3c, 0x4e,
+    };
+
+    // 2.8.2: key 80..9f, nonce = constant 07 00 00 00 and iv 40..47
+    constexpr char AEAD_TEXT[] { "Ladies and Gentlemen of the class of '99: If I could offer you only one tip for the future, sunscreen would be it." };
+    constexpr std::array<byte, 12> AEAD_AAD { 0x50, 0x51, 0x52, 0x53, 0xc0, 0xc1, 0xc2, 0xc3, 0xc4, 0xc5, 0xc6, 0xc7 };
+    constexpr crypto::Nonce AEAD_NONCE { 0x07, 0x00, 0x00, 0x00, 0x40, 0x41, 0x42, 0x43, 0x44, 0x45, 0x46, 0x47 };
+    constexpr std::array<byte, sizeof(AEAD_TEXT) - 1> AEAD_CIPHER {
+        0xd3, 0x1a, 0x8d, 0x34, 0x64, 0x8e, 0x60, 0xdb, 0x7b, 0x86, 0xaf, 0xbc, 0x53, 0xef, 0x7e, 0xc2,
+        0xa4, 0xad, 0xed, 0x51, 0x29, 0x6e, 0x08, 0xfe, 0xa9, 0xe2, 0xb5, 0xa7, 0x36, 0xee, 0x62, 0xd6,
+        0x3d, 0xbe, 0xa4, 0x5e, 0x8c, 0xa9, 0x67, 0x12, 0x82, 0xfa, 0xfb, 0x69, 0xda, 0x92, 0x72, 0x8b,
+        0x1a, 0x71, 0xde, 0x0a, 0x9e, 0x06, 0x0b, 0x29, 0x05, 0xd6, 0xa5, 0xb6, 0x7e, 0xcd, 0x3b, 0x36,
+        0x92, 0xdd, 0xbd, 0x7f, 0x2d, 0x77, 0x8b, 0x8c, 0x98, 0x03, 0xae, 0xe3, 0x28, 0x09, 0x1b, 0x58,
+        0xfa, 0xb3, 0x24, 0xe4, 0xfa, 0xd6, 0x75, 0x94, 0x55, 0x85, 0x80, 0x8b, 0x48, 0x31, 0xd7, 0xbc,
+        0x3f, 0xf4, 0xde, 0xf0, 0x8e, 0x4b, 0x7a, 0x9d, 0xe5, 0x76, 0xd2, 0x65, 0x86, 0xce, 0xc6, 0x4b,
+        0x61, 0x16,
+    };
+    constexpr crypto::Tag AEAD_TAG { 0x1a, 0xe1, 0x0b, 0x59, 0x4f, 0x09, 0xe2, 0x6a, 0x7e, 0x90, 0x2e, 0xcb, 0xd0, 0x60, 0x06, 0x91 };
+
+    crypto::Key keyFrom(byte first)
+    {
+        crypto::Key key;
+        for (std::size_t i = 0; i < key.size(); ++i) key[i] = static_cast<byte>(first + i);
+        return key;
+    }
+
+    int failures { 0 };
+
+    void expect(bool ok, const char* kernels, const char* what, std::size_t lane)
+    {
+        if (ok) return;
+        ++failures;
+        std::printf("%-6s %s mismatch (input %zu)\n", kernels, what, lane);
+    }
+
+    // 2.3.2 block in every input of a call wider than the kernel
+    void checkBlocks(crypto::Kernels const& k)
+    {
+        const auto key { keyFrom(0x00) };
+        const std::size_t n { 2 * k.width + 1 };
+
+        std::vector<crypto::BlockInput> in(n, crypto::blockInput(key.data(), BLOCK_COUNTER, BLOCK_NONCE.data()));
+        std::vector<byte> out(n * crypto::BLOCK_SIZE);
+        k.blocks(in.data(), n, out.data());
+
+        for (std::size_t i = 0; i < n; ++i)
+            expect(0 == std::memcmp(out.data() + i * crypto::BLOCK_SIZE, BLOCK_OUT.data(), BLOCK_OUT.size()), k.name, "chacha20 block", i);
+    }
+
+    // 2.8.2 AEAD put together from the kernel's blocks and mac, the tag of a batch wider than the kernel
+    void checkAead(crypto::Kernels const& k)
+    {
+        const auto key { keyFrom(0x80) };
+        constexpr std::size_t TEXT { AEAD_CIPHER.size() };
+        constexpr std::size_t STREAM_BLOCKS { (TEXT + crypto::BLOCK_SIZE - 1) / crypto::BLOCK_SIZE };
+
+        // block 0 - one time key, 1.. - keystream
+        std::array<crypto::BlockInput, 1 + STREAM_BLOCKS> in;
+        for (std::uint32_t b = 0; b < in.size(); ++b) in[b] = crypto::blockInput(key.data(), b, AEAD_NONCE.data());
+        std::array<byte, in.size() * crypto::BLOCK_SIZE> stream;
+        k.blocks(in.data(), in.size(), stream.data());
+
+        std::array<byte, TEXT> cipher;
+        for (std::size_t i = 0; i < TEXT; ++i) cipher[i] = static_cast<byte>(AEAD_TEXT[i]) ^ stream[crypto::BLOCK_SIZE + i];
+        expect(0 == std::memcmp(cipher.data(), AEAD_CIPHER.data(), TEXT), k.name, "aead ciphertext", 0);
+
+        constexpr std::size_t MACS { 5 };   // 4 lanes and a tail
+        std::array<crypto::Tag, MACS> tags {};
+        std::array<crypto::MacInput, MACS> macs;
+        for (std::size_t i = 0; i < MACS; ++i)
+            macs[i] = { stream.data(), AEAD_AAD.data(), AEAD_AAD.size(), AEAD_CIPHER.data(), TEXT, tags[i].data() };
+        k.mac(macs.data(), MACS);
+
+        for (std::size_t i = 0; i < MACS; ++i)
+            expect(tags[i] == AEAD_TAG, k.name, "aead tag", i);
+    }
+
+    // seal/open of the active kernels
+    void checkSealOpen()
+    {
+        const auto key { keyFrom(0x80) };
+        const char* name { crypto::active->name };
+
+        std::array<byte, AEAD_CIPHER.size()> data;
+        std::memcpy(data.data(), AEAD_TEXT, data.size());
+        crypto::Tag tag;
+        crypto::seal(key, AEAD_NONCE, AEAD_AAD.data(), AEAD_AAD.size(), data.data(), data.size(), tag.data());
+        expect(data == AEAD_CIPHER, name, "seal ciphertext", 0);
+        expect(tag == AEAD_TAG, name, "seal tag", 0);
+
+        const bool opened { crypto::open(key, AEAD_NONCE, AEAD_AAD.data(), AEAD_AAD.size(), data.data(), data.size(), AEAD_TAG.data()) };
+        expect(opened and 0 == std::memcmp(data.data(), AEAD_TEXT, data.size()), name, "open", 0);
+
+        auto forged { AEAD_TAG };
+        forged[0] ^= 1;
+        std::memcpy(data.data(), AEAD_CIPHER.data(), data.size());
+        expect(not crypto::open(key, AEAD_NONCE, AEAD_AAD.data(), AEAD_AAD.size(), data.data(), data.size(), forged.data()), name, "open of a forged tag", 0);
+    }
+}
+
+int main()
+{
+    for (const char* name : { "scalar", "avx2" })
+    {
+        const auto kernels { crypto::find(name) };
+        if (nullptr == kernels)
+        {
+            std::printf("%-6s not supported by cpu, skipped\n", name);
+            continue;
+        }
+
+        checkBlocks(*kernels);
+        checkAead(*kernels);
+        std::printf("%-6s checked\n", name);
+    }
+    checkSealOpen();
+
+    std::printf("%s, %d mismatches\n", 0 == failures ? "ok" : "FAILED", failures);
+    return 0 == failures ? 0 : 1;
+}
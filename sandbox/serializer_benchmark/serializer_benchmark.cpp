@@ -0,0 +1,331 @@
+/*
+ *  Сериализация объектов сообщений: побайтовое копирование объекта
+ *  (Body::write(obj, sizeof(obj))) против упаковки по схеме
+ *  (schema::write). Выводит байт и нс на сообщение (запись + чтение).
+ *  Затем - сколько обновлений сущности (id, позиция, скорость, поворот)
+ *  помещается в одну датаграмму сырыми float и в квантованном виде,
+ *  и сколько - дельтами к подтвержденному клиентом состоянию (позиция
+ *  относительно предсказанной по скорости) для толпы идущих сущностей.
+ *
+ *  g++ -std=c++17 -O2 -I../../hermesnet -I../../libs/boost/include serializer_benchmark.cpp ../../hermesnet/hermes/common/memory.cpp -o serializer_benchmark
+ *  ./serializer_benchmark [iterations]
+ */
+
+#include <hermes/message/body.h>
+#include <hermes/message/schema.h>
+#include <hermes/message/objects/ping.h>
+#include <hermes/message/objects/connect.h>
+#include <hermes/message/objects/disconnect.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <vector>
+#include <algorithm>
+
+using namespace network::message;
+using namespace network::message::object;
+
+namespace
+{
+    using clock = std::chrono::steady_clock;
+
+    // keeps the compiler from dropping the loop
+    template <typename T>
+    void escape(T const& value) noexcept { asm volatile("" : : "g"(&value) : "memory"); }
+
+    template <typename ObjectType>
+    double rawLoop(ObjectType& obj, std::size_t iterations) noexcept
+    {
+        Body body;
+        const auto start { clock::now() };
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            body.write(obj, sizeof(obj));
+            escape(body);
+            body.read(obj, sizeof(obj));
+            escape(obj);
+        }
+        const auto ns { std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() };
+        return static_cast<double>(ns) / static_cast<double>(iterations);
+    }
+
+    template <typename ObjectType>
+    double schemaLoop(ObjectType& obj, std::size_t iterations) noexcept
+    {
+        Body body;
+        const auto start { clock::now() };
+        for (std::size_t i = 0; i < iterations; ++i)
+        {
+            schema::write(body, obj);
+            escape(body);
+            schema::read(body, obj);
+            escape(obj);
+        }
+        const auto ns { std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() };
+        return static_cast<double>(ns) / static_cast<double>(iterations);
+    }
+
+    struct EntityUpdate
+    {
+        std::uint32_t   id;
+        float           position[3];
+        float           velocity[3];
+        Quaternion      rotation;
+    };
+
+    constexpr float WORLD_BOUND { 4096.0f };    // meters
+    constexpr float SPEED_BOUND { 64.0f };      // meters per second
+
+    // id varint, position 24 bits (~0.5 mm), velocity 12 bits (~3 cm/s), rotation 2 + 3 * 10 bits
+    void writeEntity(BitWriter& w, EntityUpdate const& e) noexcept
+    {
+        w.writeVarint(e.id);
+        for (auto v : e.position) w.writeFloat(v, -WORLD_BOUND, WORLD_BOUND, 24);
+        for (auto v : e.velocity) w.writeFloat(v, -SPEED_BOUND, SPEED_BOUND, 12);
+        w.writeQuaternion(e.rotation, 10);
+    }
+
+    void readEntity(BitReader& r, EntityUpdate& e) noexcept
+    {
+        e.id = static_cast<std::uint32_t>(r.readVarint());
+        for (auto& v : e.position) v = r.readFloat(-WORLD_BOUND, WORLD_BOUND, 24);
+        for (auto& v : e.velocity) v = r.readFloat(-SPEED_BOUND, SPEED_BOUND, 12);
+        e.rotation = r.readQuaternion(10);
+    }
+
+    void runEntities(std::size_t iterations)
+    {
+        std::mt19937 rng { 42 };
+        std::uniform_real_distribution<float> world { -WORLD_BOUND, WORLD_BOUND };
+        std::uniform_real_distribution<float> speed { -SPEED_BOUND, SPEED_BOUND };
+
+        std::vector<EntityUpdate> entities(64);
+        for (std::size_t i = 0; i < entities.size(); ++i)
+            entities[i] = { static_cast<std::uint32_t>(i * 37), { world(rng), world(rng), world(rng) },
+                            { speed(rng), speed(rng), speed(rng) }, { 0.0f, 0.38268343f, 0.0f, 0.92387953f } };
+
+        // entities fitting into one body
+        std::size_t fit { 0 };
+        std::size_t bits { 0 };
+        {
+            Body body;
+            BitWriter w { body };
+            while (fit < entities.size())
+            {
+                writeEntity(w, entities[fit]);
+                if (w.bitCount() > CAPACITY * 8) break;
+                bits = w.bitCount();
+                ++fit;
+            }
+        }
+
+        Body body;
+        EntityUpdate out {};
+        const auto start { clock::now() };
+        for (std::size_t i = 0; i < iterations / fit; ++i)
+        {
+            body.size = 0;
+            BitWriter w { body };
+            for (std::size_t e = 0; e < fit; ++e) writeEntity(w, entities[e]);
+            w.flush();
+            escape(body);
+
+            BitReader r { body };
+            for (std::size_t e = 0; e < fit; ++e) readEntity(r, out);
+            escape(out);
+        }
+        const auto ns { std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count() };
+
+        std::printf("EntityUpdate raw %3zu bytes, %zu per datagram   packed %.1f bytes, %zu per datagram, %6.2f ns\n",
+                    sizeof(EntityUpdate), CAPACITY / sizeof(EntityUpdate), static_cast<double>(bits) / 8.0 / static_cast<double>(fit),
+                    fit, static_cast<double>(ns) / static_cast<double>(iterations / fit * fit));
+    }
+
+    // quantized entity: position and velocity as above, rotation as the smallest three index and components
+    struct QuantizedEntity
+    {
+        std::uint32_t   id;
+        std::uint64_t   position[3];
+        std::uint64_t   velocity[3];
+        std::uint64_t   rotation[4];
+    };
+
+    constexpr float     TICK_RATE   { 30.0f };
+    constexpr float     POSITION_STEP { 2.0f * WORLD_BOUND / static_cast<float>(bits::mask(24)) };
+
+    QuantizedEntity quantizeEntity(EntityUpdate const& e) noexcept
+    {
+        QuantizedEntity q { e.id, {}, {}, {} };
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            q.position[i] = bits::quantize(e.position[i], -WORLD_BOUND, WORLD_BOUND, 24);
+            q.velocity[i] = bits::quantize(e.velocity[i], -SPEED_BOUND, SPEED_BOUND, 12);
+        }
+
+        const float c[4] { e.rotation.x, e.rotation.y, e.rotation.z, e.rotation.w };
+        unsigned largest { 0 };
+        for (unsigned i = 1; i < 4; ++i)
+            if (std::fabs(c[i]) > std::fabs(c[largest])) largest = i;
+        const float sign { c[largest] < 0.0f ? -1.0f : 1.0f };
+
+        q.rotation[0] = largest;
+        for (unsigned i = 0, k = 1; i < 4; ++i)
+            if (i != largest) q.rotation[k++] = bits::quantize(c[i] * sign, -bits::QUATERNION_BOUND, bits::QUATERNION_BOUND, 10);
+        return q;
+    }
+
+    // position the client extrapolates from the baseline velocity over the baseline distance
+    std::uint64_t predict(QuantizedEntity const& base, unsigned axis, unsigned distance) noexcept
+    {
+        const float speed { bits::dequantize(base.velocity[axis], -SPEED_BOUND, SPEED_BOUND, 12) };
+        const auto shift { std::lround(speed * static_cast<float>(distance) / TICK_RATE / POSITION_STEP) };
+        return base.position[axis] + static_cast<std::uint64_t>(shift);
+    }
+
+    // id against the next one, position against the prediction, the rest against the baseline
+    void writeEntityDelta(BitWriter& w, QuantizedEntity const& e, QuantizedEntity const& base, std::uint32_t next, unsigned distance) noexcept
+    {
+        w.writeDelta(e.id, next, 16, 3);
+        for (unsigned i = 0; i < 3; ++i) w.writeDelta(e.position[i], predict(base, i, distance), 24, 4);
+        for (unsigned i = 0; i < 3; ++i) w.writeDelta(e.velocity[i], base.velocity[i], 12, 3);
+        w.writeDelta(e.rotation[0], base.rotation[0], 2, 1);
+        for (unsigned i = 1; i < 4; ++i) w.writeDelta(e.rotation[i], base.rotation[i], 10, 4);
+    }
+
+    void readEntityDelta(BitReader& r, QuantizedEntity& e, QuantizedEntity const& base, std::uint32_t next, unsigned distance) noexcept
+    {
+        e.id = static_cast<std::uint32_t>(r.readDelta(next, 16, 3));
+        for (unsigned i = 0; i < 3; ++i) e.position[i] = r.readDelta(predict(base, i, distance), 24, 4);
+        for (unsigned i = 0; i < 3; ++i) e.velocity[i] = r.readDelta(base.velocity[i], 12, 3);
+        e.rotation[0] = r.readDelta(base.rotation[0], 2, 1);
+        for (unsigned i = 1; i < 4; ++i) e.rotation[i] = r.readDelta(base.rotation[i], 10, 4);
+    }
+
+    bool operator== (QuantizedEntity const& a, QuantizedEntity const& b) noexcept
+    {
+        return a.id == b.id and std::equal(a.position, a.position + 3, b.position) and std::equal(a.velocity, a.velocity + 3, b.velocity)
+           and std::equal(a.rotation, a.rotation + 4, b.rotation);
+    }
+
+    /*
+     *  Толпа: сущности идут по плоскости (1.5 м/с, случайный курс),
+     *  четверть поворачивает (90 град/с), ускорения - шум. Базовое
+     *  состояние - то, что клиент подтвердил distance тиков назад.
+     *  Обновления пишутся подряд по id, пока помещаются в датаграмму.
+     */
+    void runDeltas(unsigned distance)
+    {
+        constexpr std::size_t ENTITIES { 1024 };
+        constexpr unsigned    TICKS    { 300 };
+
+        std::mt19937 rng { 7 };
+        std::uniform_real_distribution<float> world { -WORLD_BOUND / 4.0f, WORLD_BOUND / 4.0f };
+        std::uniform_real_distribution<float> angle { 0.0f, 6.2831853f };
+        std::normal_distribution<float> noise { 0.0f, 0.5f };   // m/s^2
+
+        std::vector<EntityUpdate> state(ENTITIES);
+        std::vector<float> heading(ENTITIES), turn(ENTITIES);
+        for (std::size_t i = 0; i < ENTITIES; ++i)
+        {
+            state[i].id = static_cast<std::uint32_t>(i);
+            state[i].position[0] = world(rng);
+            state[i].position[1] = 0.0f;
+            state[i].position[2] = world(rng);
+            heading[i] = angle(rng);
+            turn[i] = 0 == i % 4 ? 1.5707963f : 0.0f;
+        }
+
+        std::vector<std::vector<QuantizedEntity>> history;
+        std::size_t updates { 0 }, datagrams { 0 }, mismatches { 0 };
+        double ns { 0.0 };
+        for (unsigned tick = 0; tick < TICKS; ++tick)
+        {
+            const float dt { 1.0f / TICK_RATE };
+            std::vector<QuantizedEntity> now(ENTITIES);
+            for (std::size_t i = 0; i < ENTITIES; ++i)
+            {
+                auto& e { state[i] };
+                heading[i] += turn[i] * dt;
+                e.velocity[0] = 1.5f * std::cos(heading[i]) + noise(rng) * dt;
+                e.velocity[2] = 1.5f * std::sin(heading[i]) + noise(rng) * dt;
+                e.position[0] += e.velocity[0] * dt;
+                e.position[2] += e.velocity[2] * dt;
+                e.rotation = { 0.0f, std::sin(heading[i] / 2.0f), 0.0f, std::cos(heading[i] / 2.0f) };
+                now[i] = quantizeEntity(e);
+            }
+            history.push_back(now);
+            if (tick < distance) continue;
+            auto const& base { history[tick - distance] };
+
+            // consecutive datagrams over the whole crowd
+            const auto start { clock::now() };
+            std::size_t first { 0 };
+            while (first < ENTITIES)
+            {
+                // updates of the next datagram
+                std::size_t count { 0 }, used { 0 };
+                for (auto i { first }; i < ENTITIES; ++i, ++count)
+                {
+                    std::uint8_t scratch[CAPACITY];
+                    BitWriter probe { scratch, sizeof(scratch) };
+                    writeEntityDelta(probe, now[i], base[i], static_cast<std::uint32_t>(i), distance);
+                    if ((used += probe.bitCount()) > CAPACITY * 8) break;
+                }
+
+                Body body;
+                BitWriter w { body };
+                for (std::size_t k = 0; k < count; ++k)
+                    writeEntityDelta(w, now[first + k], base[first + k], static_cast<std::uint32_t>(first + k), distance);
+                w.flush();
+
+                BitReader r { body };
+                QuantizedEntity out {};
+                for (std::size_t k = 0; k < count; ++k)
+                {
+                    readEntityDelta(r, out, base[first + k], static_cast<std::uint32_t>(first + k), distance);
+                    mismatches += out == now[first + k] ? 0 : 1;
+                }
+
+                first += count;
+                updates += count;
+                ++datagrams;
+            }
+            ns += static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(clock::now() - start).count());
+        }
+
+        std::printf("EntityUpdate delta, baseline %u ticks back: %.1f bits, %.1f per datagram, %6.2f ns, mismatches %zu\n",
+                    distance, static_cast<double>(datagrams) * CAPACITY * 8.0 / static_cast<double>(updates),
+                    static_cast<double>(updates) / static_cast<double>(datagrams), ns / static_cast<double>(updates), mismatches);
+    }
+
+    template <typename ObjectType>
+    void run(const char* name, ObjectType obj, std::size_t iterations)
+    {
+        const auto raw { rawLoop(obj, iterations) };
+        const auto packed { schemaLoop(obj, iterations) };
+        std::printf("%-12s raw %3zu bytes %6.2f ns   schema %3zu bytes %6.2f ns\n",
+                    name, sizeof(ObjectType), raw, schema::packedSize<ObjectType>(), packed);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const std::size_t iterations { argc > 1 ? std::strtoul(argv[1], nullptr, 10) : 10'000'000 };
+
+    MPing ping;
+    ping.setStart();
+    ping.setEnd();
+    MConnect connect { 0xEA };
+
+    std::printf("%zu iterations, write + read per message\n", iterations);
+    run("MPing", ping, iterations);
+    run("MConnect", connect, iterations);
+    run("MDisconnect", MDisconnect { connect.getUUID(), MDisconnect::EDisconnectReason::DISCONNECT_TIMEOUT }, iterations);
+    runEntities(iterations);
+    runDeltas(1);
+    runDeltas(4);
+    return 0;
+}
@@ -1,8 +1,12 @@
 
 #pragma once
 
+#include <string>
 #include <cstdint>
+#include <cstddef>
+#include <iostream>
 #include <algorithm>
+#include <type_traits>
 
 namespace app::message::id
 {
@@ -39,39 +43,16 @@ namespace app::message::id
         EReserved       reserved {};       // [2 bytes]
         // --------------------------------------------
 
-        ChatType() = default;
-        ~ChatType() = default;
-        // noncopyable
-        ChatType(ChatType const&) = delete;
-        ChatType& operator= (ChatType const&) = delete;
-        // move semantic
-        ChatType(ChatType&&) noexcept;
-        ChatType& operator= (ChatType&&) noexcept;
-
-        void swap(ChatType& other) noexcept;
-
         [[nodiscard]] std::string getActionStr() const;
 
         friend std::ostream& operator<< (std::ostream& os, ChatType const& st);
 
     }; // ChatType
 
-    ChatType::ChatType(ChatType&& other) noexcept
-    {
-        this != &other ? this->swap(other) : void(0);
-    }
-
-    ChatType& ChatType::operator= (ChatType&& other) noexcept
-    {
-        this != &other ? this->swap(other) : void(0);
-        return *this;
-    }
-
-    void ChatType::swap(ChatType& other)  noexcept
-    {
-        std::swap(action, other.action);
-        std::swap(reserved, other.reserved);
-    }
+    // plain wire struct: copied as raw bytes
+    static_assert(std::is_trivially_copyable_v<ChatType> and std::is_standard_layout_v<ChatType>);
+    static_assert(sizeof(ChatType) == 4 and alignof(ChatType) == 2);
+    static_assert(offsetof(ChatType, action) == 0 and offsetof(ChatType, reserved) == 2);
 
     std::ostream& operator<< (std::ostream &os, ChatType const& st) {
         os  << "type:\n"
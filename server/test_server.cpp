@@ -10,6 +10,7 @@
 #include <hermes/log/log.h>
 #include <hermes/common/types.h>
 #include <hermes/service/server/server.h>
+#include <hermes/service/server/sharded_server.h>
 #include <hermes/message/message_generator.h>
 
 using namespace app::message::id;
@@ -24,7 +25,17 @@ namespace
 #define LOG(text) utility::logger::Logger::getInstance().log(EModule::MAIN, (text));
 }
 
-int main()
+namespace
+{
+    // public chat messages are delivered to clients of every shard
+    std::uint64_t chatRouter(Header<ChatType> const& header)
+    {
+        const bool broadcast { ChatType::EChatAction::CHAT_ACT_MESSAGE_PUBLIC == header.type.action };
+        return broadcast ? ~std::uint64_t(0) : 0;
+    }
+}
+
+int main(int argc, char* argv[])
 {
     // config --- todo: add boost::program_options + {unit}.ini
     {
@@ -37,10 +48,23 @@ int main()
 
     try
     {
-        Server<ChatType> server;
-        server.start({ SERVER_IN_PORT, SERVER_OUT_PORT });
+        // usage: server [shards]
+        const std::uint32_t shards { argc > 1 ? static_cast<std::uint32_t>(std::stoul(argv[1])) : 1u };
+
+        if (shards > 1)
+        {
+            ShardedServer<ChatType> server({ shards });
+            server.start({ SERVER_IN_PORT, SERVER_OUT_PORT }, chatRouter);
+
+            std::this_thread::sleep_for(std::chrono::milliseconds(10'000));
+        }
+        else
+        {
+            Server<ChatType> server;
+            server.start({ SERVER_IN_PORT, SERVER_OUT_PORT });
 
-        std::this_thread::sleep_for(std::chrono::milliseconds(10'000));
+            std::this_thread::sleep_for(std::chrono::milliseconds(10'000));
+        }
     }
     catch (std::exception& e)
     {